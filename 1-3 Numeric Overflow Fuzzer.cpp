@@ -0,0 +1,714 @@
+// 1-3 Numeric Overflow Fuzzer.cpp : Differential fuzzer for the checked add and subtract templates against an exact reference.
+//
+// Usage: numeric_overflow_fuzzer [--threads=N] [--seconds=N] [--cases=N]
+//
+// Every thread generates (start, operand, steps) cases for the 14 types 1-3 runs, a mix of boundary
+// values, random values and operands sized so the last step lands right at a limit, and compares
+// checked_add and checked_subtract with a reference: closed-form __int128 arithmetic for the integer
+// types and long double for the floating types. One case in 64 also goes through add_numbers or
+// subtract_numbers, to check the exceptions match the status. The first disagreement for each type and
+// operation is shrunk to a simpler case that still disagrees and printed, and the exit code is 1.
+//
+// The run stops after --seconds (10 by default) or --cases, whichever comes first. Threads draw from
+// jumped streams of RANDOM_SEED, which is printed at start up.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "CheckedArithmetic.h"
+#include "Random.h"
+
+#ifndef __SIZEOF_INT128__
+#error "the numeric overflow fuzzer needs __int128 for its integer reference"
+#endif
+
+namespace
+{
+    using Wide = __int128;
+
+    enum class Operation
+    {
+        add,
+        subtract
+    };
+
+    template <typename T>
+    struct Case
+    {
+        T start{};
+        T operand{};
+        unsigned long steps = 0;
+        Operation operation = Operation::add;
+    };
+
+    template <typename T>
+    struct Outcome
+    {
+        ArithmeticStatus status = ArithmeticStatus::ok;
+        // the result, or the last value in range when a step would have left it
+        T value{};
+        // false when floating point rounding could decide either way, so any outcome is accepted
+        bool certain = true;
+    };
+
+    const char* const type_names[] = {
+        "char", "wchar_t", "short", "int", "long", "long long",
+        "unsigned char", "unsigned short", "unsigned int", "unsigned long", "unsigned long long",
+        "float", "double", "long double"};
+
+    constexpr std::size_t type_count = sizeof(type_names) / sizeof(type_names[0]);
+
+    struct Tally
+    {
+        std::uint64_t cases = 0;
+        std::uint64_t near_limit = 0;
+        std::uint64_t failures = 0;
+    };
+
+    /// <summary>
+    /// The counterexamples found so far, at most one for each type and operation so that a bug
+    /// hit millions of times is shrunk and printed once
+    /// </summary>
+    class Findings
+    {
+    public:
+        bool claim(std::size_t type_index, Operation operation)
+        {
+            return !claimed_[type_index * 2 + static_cast<std::size_t>(operation)].exchange(true);
+        }
+
+        void add(std::string text)
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            examples_.push_back(std::move(text));
+        }
+
+        const std::vector<std::string>& examples() const
+        {
+            return examples_;
+        }
+
+    private:
+        std::array<std::atomic<bool>, type_count * 2> claimed_{};
+        std::mutex mutex_;
+        std::vector<std::string> examples_;
+    };
+
+    // --- reference -----------------------------------------------------------------------------
+
+    /// <summary>
+    /// Exact outcome for the integer types. The steps move in one direction, so the number that fit
+    /// before the limit is one division rather than a loop.
+    /// </summary>
+    template <typename T>
+    Outcome<T> integral_reference(const Case<T>& c)
+    {
+        const Wide max = std::numeric_limits<T>::max();
+        const Wide lowest = std::numeric_limits<T>::lowest();
+        const Wide start = c.start;
+        const Wide step = c.operation == Operation::add ? Wide(c.operand) : -Wide(c.operand);
+        const Wide steps = c.steps;
+
+        if (step == 0)
+        {
+            return {ArithmeticStatus::ok, c.start};
+        }
+        const Wide room = step > 0 ? (max - start) / step : (lowest - start) / step;
+        if (steps <= room)
+        {
+            return {ArithmeticStatus::ok, static_cast<T>(start + steps * step)};
+        }
+        return {step > 0 ? ArithmeticStatus::overflow : ArithmeticStatus::underflow, static_cast<T>(start + room * step)};
+    }
+
+    /// <summary>
+    /// Outcome for the floating types, following the same rounded trajectory as the template but
+    /// deciding each step from the sum in long double. Sums are taken at half scale, so they stay
+    /// finite for long double too.
+    ///
+    /// A sum that is exactly in range can never be reported as out of range, since rounding
+    /// max - increment cannot move it past a value that is already representable. A sum just past a
+    /// limit can go either way, depending on how that subtraction rounds, so a step within a few ulps
+    /// of a limit is only decided when the sum is known exactly; otherwise the case is uncertain.
+    /// </summary>
+    template <typename T>
+    Outcome<T> floating_reference(const Case<T>& c)
+    {
+        using Reference = long double;
+        const Reference half_max = Reference(std::numeric_limits<T>::max()) / 2;
+        const Reference margin = half_max * 2 * Reference(std::numeric_limits<T>::epsilon());
+        const Reference step = c.operation == Operation::add ? Reference(c.operand) : -Reference(c.operand);
+        const Reference half_step = step / 2;
+        const bool step_halves_exactly = half_step * 2 == step;
+
+        T result = c.start;
+        for (unsigned long i = 0; i < c.steps; ++i)
+        {
+            const Reference half_result = Reference(result) / 2;
+            const Reference half_next = half_result + half_step;
+            if (half_next > half_max + margin)
+            {
+                return {ArithmeticStatus::overflow, result};
+            }
+            if (half_next < -half_max - margin)
+            {
+                return {ArithmeticStatus::underflow, result};
+            }
+            if (half_next >= half_max - margin || half_next <= -half_max + margin)
+            {
+                // Knuth's two-sum: the rounding error of half_next, zero when the sum is exact
+                const Reference rounded_step = half_next - half_result;
+                const Reference error = (half_result - (half_next - rounded_step)) + (half_step - rounded_step);
+                const bool exact = error == 0 && step_halves_exactly && half_result * 2 == Reference(result);
+                if (!exact || half_next > half_max || half_next < -half_max)
+                {
+                    return {ArithmeticStatus::ok, result, false};
+                }
+            }
+
+            if (c.operation == Operation::add)
+            {
+                result += c.operand;
+            }
+            else
+            {
+                result -= c.operand;
+            }
+        }
+        return {ArithmeticStatus::ok, result};
+    }
+
+    template <typename T>
+    Outcome<T> reference(const Case<T>& c)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            return floating_reference(c);
+        }
+        else
+        {
+            return integral_reference(c);
+        }
+    }
+
+    // --- the code under test ---------------------------------------------------------------------
+
+    template <typename T>
+    Outcome<T> run_checked(const Case<T>& c)
+    {
+        Outcome<T> outcome;
+        outcome.status = c.operation == Operation::add ? checked_add(c.start, c.operand, c.steps, outcome.value)
+                                                       : checked_subtract(c.start, c.operand, c.steps, outcome.value);
+        return outcome;
+    }
+
+    template <typename T>
+    Outcome<T> run_throwing(const Case<T>& c)
+    {
+        Outcome<T> outcome;
+        try
+        {
+            outcome.value = c.operation == Operation::add ? add_numbers<T>(c.start, c.operand, c.steps) : subtract_numbers<T>(c.start, c.operand, c.steps);
+        }
+        catch (const std::overflow_error&)
+        {
+            outcome.status = ArithmeticStatus::overflow;
+        }
+        catch (const std::underflow_error&)
+        {
+            outcome.status = ArithmeticStatus::underflow;
+        }
+        return outcome;
+    }
+
+    template <typename T>
+    bool checked_matches(const Outcome<T>& expected, const Outcome<T>& actual)
+    {
+        return actual.status == expected.status && actual.value == expected.value;
+    }
+
+    // the throwing templates only return a value on success
+    template <typename T>
+    bool throwing_matches(const Outcome<T>& expected, const Outcome<T>& actual)
+    {
+        return actual.status == expected.status && (actual.status != ArithmeticStatus::ok || actual.value == expected.value);
+    }
+
+    template <typename T>
+    bool disagrees(const Case<T>& c, const Outcome<T>& expected, bool check_exceptions)
+    {
+        if (!checked_matches(expected, run_checked(c)))
+        {
+            return true;
+        }
+        return check_exceptions && !throwing_matches(expected, run_throwing(c));
+    }
+
+    template <typename T>
+    bool fails(const Case<T>& c)
+    {
+        const Outcome<T> expected = reference(c);
+        return expected.certain && disagrees(c, expected, true);
+    }
+
+    // --- generation ------------------------------------------------------------------------------
+
+    unsigned long random_steps(Xoshiro256& random)
+    {
+        // mostly short runs, where the boundary cases are; now and then a long one
+        const std::uint32_t pick = random.next_below(16);
+        if (pick < 9)
+        {
+            return random.next_below(5);
+        }
+        if (pick < 15)
+        {
+            return 5 + random.next_below(28);
+        }
+        return 33 + random.next_below(992);
+    }
+
+    template <typename T>
+    T random_integral(Xoshiro256& random)
+    {
+        using Limits = std::numeric_limits<T>;
+        switch (random.next_below(14))
+        {
+        case 0:
+            return 0;
+        case 1:
+            return 1;
+        case 2:
+            return static_cast<T>(-1);
+        case 3:
+            return Limits::max();
+        case 4:
+            return static_cast<T>(Limits::max() - 1);
+        case 5:
+            return Limits::lowest();
+        case 6:
+            return static_cast<T>(Limits::lowest() + 1);
+        case 7:
+            return static_cast<T>(Limits::max() / 2);
+        case 8:
+            return static_cast<T>(Limits::lowest() / 2);
+        case 9:
+            return static_cast<T>(Limits::max() / static_cast<T>(3 + random.next_below(14)));
+        case 10:
+            return static_cast<T>(static_cast<int>(random.next_below(33)) - 16);
+        case 11:
+        case 12:
+        {
+            // any magnitude, either sign
+            const std::uint64_t bits = random() >> random.next_below(64);
+            return static_cast<T>((random() & 1) ? bits : 0 - bits);
+        }
+        default:
+            return static_cast<T>(random());
+        }
+    }
+
+    template <typename T>
+    T random_floating(Xoshiro256& random)
+    {
+        using Limits = std::numeric_limits<T>;
+        const T sign = (random() & 1) ? T(-1) : T(1);
+        switch (random.next_below(12))
+        {
+        case 0:
+            return sign * T(0);
+        case 1:
+            return sign;
+        case 2:
+            return sign * Limits::max();
+        case 3:
+            return sign * (Limits::max() / 2);
+        case 4:
+            return sign * (Limits::max() / static_cast<T>(3 + random.next_below(14)));
+        case 5:
+            return sign * std::nextafter(Limits::max(), T(0));
+        case 6:
+            return sign * (random() & 1 ? Limits::min() : Limits::denorm_min());
+        case 7:
+            return sign * Limits::epsilon();
+        default:
+        {
+            // a random mantissa at a random exponent, half of them in the top few binades where
+            // the limits are
+            const long double mantissa = 1.0L + static_cast<long double>(random() >> 11) / 9007199254740992.0L;
+            const int exponent = (random() & 1) ? Limits::max_exponent - 1 - static_cast<int>(random.next_below(4))
+                                                : Limits::min_exponent + static_cast<int>(random.next_below(Limits::max_exponent - Limits::min_exponent));
+            const T value = static_cast<T>(std::ldexp(mantissa, exponent));
+            return sign * (std::isfinite(value) ? value : Limits::max());
+        }
+        }
+    }
+
+    template <typename T>
+    T random_value(Xoshiro256& random)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            return random_floating<T>(random);
+        }
+        else
+        {
+            return random_integral<T>(random);
+        }
+    }
+
+    /// <summary>
+    /// An operand that takes c.start to within a step of one of the limits in exactly c.steps steps,
+    /// so the case turns on whether the last step crosses
+    /// </summary>
+    template <typename T>
+    T aligned_operand(Xoshiro256& random, const Case<T>& c)
+    {
+        using Limits = std::numeric_limits<T>;
+        const bool upward = (random() & 1) != 0;
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            const long double target = upward ? Limits::max() : Limits::lowest();
+            long double step = (target / 2 - static_cast<long double>(c.start) / 2) / c.steps * 2;
+            step *= 1 + static_cast<long double>(static_cast<int>(random.next_below(17)) - 8) * Limits::epsilon();
+            if (c.operation == Operation::subtract)
+            {
+                step = -step;
+            }
+            if (!(std::fabs(step) <= static_cast<long double>(Limits::max())))
+            {
+                return step < 0 ? Limits::lowest() : Limits::max();
+            }
+            return static_cast<T>(step);
+        }
+        else
+        {
+            const Wide target = upward ? Wide(Limits::max()) : Wide(Limits::lowest());
+            Wide step = (target - Wide(c.start)) / Wide(c.steps) + Wide(random.next_below(3)) - 1;
+            if (c.operation == Operation::subtract)
+            {
+                step = -step;
+            }
+            return static_cast<T>(std::clamp(step, Wide(Limits::lowest()), Wide(Limits::max())));
+        }
+    }
+
+    template <typename T>
+    Case<T> generate_case(Xoshiro256& random)
+    {
+        Case<T> c;
+        c.operation = (random() & 1) ? Operation::add : Operation::subtract;
+        c.steps = random_steps(random);
+        c.start = random_value<T>(random);
+        c.operand = c.steps > 0 && random.next_below(4) == 0 ? aligned_operand(random, c) : random_value<T>(random);
+        return c;
+    }
+
+    // --- shrinking and reporting -----------------------------------------------------------------
+
+    template <typename T>
+    bool closer_to_zero(T candidate, T current)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            return std::fabs(static_cast<long double>(candidate)) < std::fabs(static_cast<long double>(current));
+        }
+        else
+        {
+            const Wide a = candidate, b = current;
+            return (a < 0 ? -a : a) < (b < 0 ? -b : b);
+        }
+    }
+
+    template <typename T>
+    std::vector<T> simpler_values(T value)
+    {
+        std::vector<T> candidates = {T(0), T(1), static_cast<T>(value / 2)};
+        if constexpr (std::numeric_limits<T>::is_signed)
+        {
+            candidates.push_back(T(-1));
+        }
+        if constexpr (!std::is_floating_point_v<T>)
+        {
+            candidates.push_back(static_cast<T>(value > 0 ? value - 1 : value + 1));
+        }
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](T candidate) { return !closer_to_zero(candidate, value); }), candidates.end());
+        return candidates;
+    }
+
+    /// <summary>
+    /// Greedily move a failing case towards fewer steps and operands nearer zero, keeping each
+    /// change that still fails
+    /// </summary>
+    template <typename T>
+    Case<T> shrink(Case<T> failing)
+    {
+        for (int round = 0; round < 512; ++round)
+        {
+            std::vector<Case<T>> candidates;
+            for (const unsigned long steps : {1ul, failing.steps / 2, failing.steps - 1})
+            {
+                if (steps < failing.steps)
+                {
+                    candidates.push_back(failing);
+                    candidates.back().steps = steps;
+                }
+            }
+            for (const T start : simpler_values(failing.start))
+            {
+                candidates.push_back(failing);
+                candidates.back().start = start;
+            }
+            for (const T operand : simpler_values(failing.operand))
+            {
+                candidates.push_back(failing);
+                candidates.back().operand = operand;
+            }
+
+            const auto simpler = std::find_if(candidates.begin(), candidates.end(), [](const Case<T>& candidate) { return fails(candidate); });
+            if (simpler == candidates.end())
+            {
+                break;
+            }
+            failing = *simpler;
+        }
+        return failing;
+    }
+
+    template <typename T>
+    std::string format_value(T value)
+    {
+        std::ostringstream text;
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            text << std::setprecision(std::numeric_limits<T>::max_digits10) << value;
+        }
+        else if constexpr (std::numeric_limits<T>::is_signed)
+        {
+            text << static_cast<long long>(value);
+        }
+        else
+        {
+            text << static_cast<unsigned long long>(value);
+        }
+        return text.str();
+    }
+
+    template <typename T>
+    std::string format_outcome(const Outcome<T>& outcome)
+    {
+        switch (outcome.status)
+        {
+        case ArithmeticStatus::overflow:
+            return "overflow after " + format_value(outcome.value);
+        case ArithmeticStatus::underflow:
+            return "underflow after " + format_value(outcome.value);
+        case ArithmeticStatus::ok:
+        default:
+            return format_value(outcome.value);
+        }
+    }
+
+    template <typename T>
+    std::string describe(const char* type_name, const Case<T>& c)
+    {
+        const bool add = c.operation == Operation::add;
+        const Outcome<T> expected = reference(c);
+        const Outcome<T> checked = run_checked(c);
+        const Outcome<T> throwing = run_throwing(c);
+
+        std::ostringstream text;
+        text << (add ? "add_numbers<" : "subtract_numbers<") << type_name << ">(" << format_value(c.start) << ", " << format_value(c.operand) << ", "
+             << c.steps << "): expected " << format_outcome(expected);
+        if (!checked_matches(expected, checked))
+        {
+            text << ", " << (add ? "checked_add" : "checked_subtract") << " gave " << format_outcome(checked);
+        }
+        if (!throwing_matches(expected, throwing))
+        {
+            text << ", " << (add ? "add_numbers" : "subtract_numbers") << " gave "
+                 << (throwing.status == ArithmeticStatus::ok ? format_value(throwing.value)
+                                                             : throwing.status == ArithmeticStatus::overflow ? "std::overflow_error" : "std::underflow_error");
+        }
+        return text.str();
+    }
+
+    // --- driver ----------------------------------------------------------------------------------
+
+    template <typename T>
+    void fuzz_batch(std::size_t type_index, Xoshiro256& random, std::uint64_t count, Tally& tally, Findings& findings)
+    {
+        for (std::uint64_t i = 0; i < count; ++i)
+        {
+            const Case<T> c = generate_case<T>(random);
+            const Outcome<T> expected = reference(c);
+            if (!expected.certain)
+            {
+                ++tally.near_limit;
+                continue;
+            }
+            // exceptions are slow, so only a sample goes through the throwing templates
+            if (!disagrees(c, expected, (i & 63) == 0))
+            {
+                continue;
+            }
+
+            ++tally.failures;
+            if (findings.claim(type_index, c.operation))
+            {
+                findings.add(describe(type_names[type_index], shrink(c)));
+            }
+        }
+        tally.cases += count;
+    }
+
+    using BatchFunction = void (*)(std::size_t, Xoshiro256&, std::uint64_t, Tally&, Findings&);
+
+    const BatchFunction batch_functions[type_count] = {
+        &fuzz_batch<char>, &fuzz_batch<wchar_t>, &fuzz_batch<short>, &fuzz_batch<int>, &fuzz_batch<long>, &fuzz_batch<long long>,
+        &fuzz_batch<unsigned char>, &fuzz_batch<unsigned short>, &fuzz_batch<unsigned int>, &fuzz_batch<unsigned long>, &fuzz_batch<unsigned long long>,
+        &fuzz_batch<float>, &fuzz_batch<double>, &fuzz_batch<long double>};
+
+    struct RunLimits
+    {
+        std::chrono::steady_clock::time_point deadline;
+        // 0 for no limit
+        std::uint64_t cases = 0;
+    };
+
+    void fuzz_thread(unsigned index, const RunLimits& limits, std::atomic<std::uint64_t>& issued, std::array<Tally, type_count>& tallies, Findings& findings)
+    {
+        constexpr std::uint64_t batch = 4096;
+
+        Xoshiro256 random(random_seed());
+        for (unsigned i = 0; i < index; ++i)
+        {
+            random.jump();
+        }
+
+        for (;;)
+        {
+            for (std::size_t type_index = 0; type_index < type_count; ++type_index)
+            {
+                std::uint64_t count = batch;
+                if (limits.cases != 0)
+                {
+                    const std::uint64_t first = issued.fetch_add(batch, std::memory_order_relaxed);
+                    if (first >= limits.cases)
+                    {
+                        return;
+                    }
+                    count = std::min(batch, limits.cases - first);
+                }
+                if (std::chrono::steady_clock::now() >= limits.deadline)
+                {
+                    return;
+                }
+                batch_functions[type_index](type_index, random, count, tallies[type_index], findings);
+            }
+        }
+    }
+
+    bool take_option(const std::string& argument, const char* name, unsigned long& value)
+    {
+        const std::string prefix = std::string("--") + name + "=";
+        if (argument.compare(0, prefix.size(), prefix) != 0)
+        {
+            return false;
+        }
+        value = std::strtoul(argument.c_str() + prefix.size(), nullptr, 10);
+        return true;
+    }
+
+    void usage()
+    {
+        std::cerr << "usage: numeric_overflow_fuzzer [--threads=N] [--seconds=N] [--cases=N]" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned long thread_count = std::thread::hardware_concurrency();
+    unsigned long seconds = 10;
+    unsigned long cases = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (!take_option(argument, "threads", thread_count) && !take_option(argument, "seconds", seconds) && !take_option(argument, "cases", cases))
+        {
+            usage();
+            return 2;
+        }
+    }
+    if (thread_count == 0)
+    {
+        thread_count = 1;
+    }
+
+    print_random_seed(stderr);
+
+    const auto started = std::chrono::steady_clock::now();
+    const RunLimits limits{started + std::chrono::seconds(seconds), cases};
+    std::atomic<std::uint64_t> issued{0};
+    std::vector<std::array<Tally, type_count>> tallies(thread_count);
+    Findings findings;
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < thread_count; ++i)
+    {
+        threads.emplace_back(fuzz_thread, i, std::cref(limits), std::ref(issued), std::ref(tallies[i]), std::ref(findings));
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+
+    Tally total;
+    std::printf("%-20s %16s %12s %10s\n", "type", "cases", "near limit", "failures");
+    for (std::size_t type_index = 0; type_index < type_count; ++type_index)
+    {
+        Tally sum;
+        for (const auto& thread_tallies : tallies)
+        {
+            sum.cases += thread_tallies[type_index].cases;
+            sum.near_limit += thread_tallies[type_index].near_limit;
+            sum.failures += thread_tallies[type_index].failures;
+        }
+        std::printf("%-20s %16llu %12llu %10llu\n", type_names[type_index], static_cast<unsigned long long>(sum.cases),
+                    static_cast<unsigned long long>(sum.near_limit), static_cast<unsigned long long>(sum.failures));
+        total.cases += sum.cases;
+        total.near_limit += sum.near_limit;
+        total.failures += sum.failures;
+    }
+    std::printf("%llu cases on %lu threads in %.1f s, %.0f million cases per minute\n", static_cast<unsigned long long>(total.cases), thread_count,
+                elapsed.count(), total.cases / elapsed.count() * 60 / 1e6);
+
+    if (total.failures == 0)
+    {
+        return 0;
+    }
+
+    std::printf("\n%llu cases disagreed with the reference, shrunk counterexamples:\n", static_cast<unsigned long long>(total.failures));
+    for (const auto& example : findings.examples())
+    {
+        std::printf("  %s\n", example.c_str());
+    }
+    return 1;
+}
@@ -3,63 +3,10 @@
 
 #include <iostream>     // std::cout
 #include <limits>       // std::numeric_limits
+#include <string>
+#include <typeinfo>
 
-/// <summary>
-/// Template function to abstract away the logic of:
-///   start + (increment * steps)
-/// </summary>
-/// <typeparam name="T">A type that with basic math functions</typeparam>
-/// <param name="start">The number to start with</param>
-/// <param name="increment">How much to add each step</param>
-/// <param name="steps">The number of steps to iterate</param>
-/// <returns>start + (increment * steps)</returns>
-template <typename T>
-T add_numbers(T const& start, T const& increment, unsigned long int const& steps)
-{
-    T result = start;
-
-    for (unsigned long int i = 0; i < steps; ++i)
-    {
-        // Detect if an overflow would occur if result were to be incremented. If so, throw
-        // an overflow error and stop the function's execution.
-        if (increment > std::numeric_limits<T>::max() - result) {
-            throw std::overflow_error("Overflow will occur");
-        }
-
-        result += increment;
-    }
-
-    return result;
-}
-
-/// <summary>
-/// Template function to abstract away the logic of:
-///   start - (increment * steps)
-/// </summary>
-/// <typeparam name="T">A type that with basic math functions</typeparam>
-/// <param name="start">The number to start with</param>
-/// <param name="increment">How much to subtract each step</param>
-/// <param name="steps">The number of steps to iterate</param>
-/// <returns>start - (increment * steps)</returns>
-
-template <typename T>
-T subtract_numbers(T const& start, T const& decrement, unsigned long int const& steps)
-{
-    T result = start;
-
-    for (unsigned long int i = 0; i < steps; ++i)
-    {
-        // Detect that an underflow is about to occur if we decrement result, and stop
-        // execution by throwing an underflow error.
-        if (decrement > result) {
-            throw std::underflow_error("Underflow will occur");
-        }
-        result -= decrement;
-    }
-
-    return result;
-}
-
+#include "CheckedArithmetic.h"
 
 //  NOTE:
 //    You will see the unary ('+') operator used in front of the variables in the test_XXX methods.
@@ -11,123 +11,12 @@
 #include <string>
 
 #include "sqlite3.h"
-#include <regex>
-
-// DO NOT CHANGE
-typedef std::tuple<std::string, std::string, std::string> user_record;
-const std::string str_where = " where ";
-
-// DO NOT CHANGE
-static int callback(void* possible_vector, int argc, char** argv, char** azColName)
-{
-    if (possible_vector == NULL)
-    { // no vector passed in, so just display the results
-        for (int i = 0; i < argc; i++)
-        {
-            std::cout << azColName[i] << " = " << (argv[i] ? argv[i] : "NULL") << std::endl;
-        }
-        std::cout << std::endl;
-    }
-    else
-    {
-        std::vector< user_record >* rows =
-            static_cast<std::vector< user_record > *>(possible_vector);
-
-        rows->push_back(std::make_tuple(argv[0], argv[1], argv[2]));
-    }
-    return 0;
-}
 
+#include "Random.h"
+#include "UserDatabase.h"
 
 // DO NOT CHANGE
-bool initialize_database(sqlite3* db)
-{
-    char* error_message = NULL;
-    std::string sql = "CREATE TABLE USERS(" \
-        "ID INT PRIMARY KEY     NOT NULL," \
-        "NAME           TEXT    NOT NULL," \
-        "PASSWORD       TEXT    NOT NULL);";
-
-    int result = sqlite3_exec(db, sql.c_str(), callback, NULL, &error_message);
-    if (result != SQLITE_OK)
-    {
-        std::cout << "Failed to create USERS table. ERROR = " << error_message << std::endl;
-        sqlite3_free(error_message);
-        return false;
-    }
-    std::cout << "USERS table created." << std::endl;
-
-    // insert some dummy data
-    sql = "INSERT INTO USERS (ID, NAME, PASSWORD)" \
-        "VALUES (1, 'Fred', 'Flinstone');" \
-        "INSERT INTO USERS (ID, NAME, PASSWORD)" \
-        "VALUES (2, 'Barney', 'Rubble');" \
-        "INSERT INTO USERS (ID, NAME, PASSWORD)" \
-        "VALUES (3, 'Wilma', 'Flinstone');" \
-        "INSERT INTO USERS (ID, NAME, PASSWORD)" \
-        "VALUES (4, 'Betty', 'Rubble');";
-
-    result = sqlite3_exec(db, sql.c_str(), callback, NULL, &error_message);
-    if (result != SQLITE_OK)
-    {
-        std::cout << "Data failed to insert to USERS table. ERROR = " << error_message << std::endl;
-        sqlite3_free(error_message);
-        return false;
-    }
-
-    return true;
-}
-
-std::string replace_substring(std::string s, const std::string s_to_replace, const std::string s_replace) {
-    for (size_t position = 0; ; position += s_replace.length()) {
-
-        position = s.find(s_to_replace, position);
-
-        if (position == std::string::npos || s.empty()) break;
-
-        s.erase(position, s_to_replace.length());
-        s.insert(position, s_replace);
-    }
-    return s;
-}
-
-bool run_query(sqlite3* db, const std::string& sql, std::vector< user_record >& records)
-{
-    // TODO: Fix this method to fail and display an error if there is a suspected SQL Injection
-    //  NOTE: You cannot just flag 1=1 as an error, since 2=2 will work just as well. You need
-    //  something more generic
-    // clear any prior results
-    records.clear();
-
-    //Regex pattern to look for additional conditionals that look like they - force a `true` condition
-        std::regex pattern("(?:or|and) (.+)=(.+);");
-    std::cmatch match;
-    // If there is a conditional - possible vulnerability?
-    if (std::regex_search(sql.c_str(), match, pattern) && match.size() >= 2) {
-        // Loop through all the matches, then compare the left to the right to see if they're the same
-        // which would force a true condition.
-        for (int i = 0; i < match.size(); i++) {
-            // If there is a suspected SQL Injection, error and message of the error
-            if ((i != match.size() + 1) && match.str(i) == match.str(i + 1)) {
-                std::cout << "Data failed to execute due to suspected SQL Injection" << std::endl;
-                return false;
-            }
-        }
-    }
-    
-
-    char* error_message;
-    if (sqlite3_exec(db, sql.c_str(), callback, &records, &error_message) != SQLITE_OK)
-    {
-        std::cout << "Data failed to be queried from USERS table. ERROR = " << error_message << std::endl;
-        sqlite3_free(error_message);
-        return false;
-    }
-
-
-    return true;
-}
-
+const std::string str_where = " where ";
 
 // DO NOT CHANGE
 bool run_query_injection(sqlite3* db, const std::string& sql, std::vector< user_record >& records)
@@ -144,7 +33,7 @@ bool run_query_injection(sqlite3* db, const std::string& sql, std::vector< user_
             injectedSQL.pop_back();
         }
 
-        switch (rand() % 4)
+        switch (thread_random().next_below(4))
         {
         case 1:
             injectedSQL.append(" or 2=2;");
@@ -209,6 +98,8 @@ int main()
 {
     // initialize random seed:
     srand(time(nullptr));
+    // the injections are picked by thread_random(), print its seed so a run can be replayed
+    print_random_seed(stdout);
 
     int return_code = 0;
     std::cout << "SQL Injection Example" << std::endl;
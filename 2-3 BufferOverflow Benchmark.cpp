@@ -0,0 +1,247 @@
+// 2-3 BufferOverflow Benchmark.cpp : Throughput of the bounded input types against raw read() and getline.
+//
+// Usage: "2-3 BufferOverflow Benchmark" [--corpus_mb=64] [--input=<file>] [benchmark flags]
+//   --corpus_mb  size of the generated corpus, use several thousand for multi-GB runs
+//   --input      benchmark an existing file instead of generating one
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchmarkMain.h"
+#include "BoundedLineReader.h"
+#include "FixedString.h"
+
+namespace
+{
+    // the same limit the original char user_input[20] buffer imposed
+    const std::size_t max_record_length = 19;
+
+    std::string corpus_path;
+    std::size_t corpus_bytes = 0;
+
+    /// <summary>
+    /// Write a corpus of mixed length records, roughly a quarter of which are too long
+    /// </summary>
+    void generate_corpus(const std::string& filename, std::size_t target_bytes)
+    {
+        std::ofstream outfile(filename, std::ios::binary);
+        std::mt19937 engine(405);
+        std::uniform_int_distribution<int> length(1, 26);
+        std::string line;
+
+        for (std::size_t written = 0; written < target_bytes; written += line.length())
+        {
+            line.assign(length(engine), 'x');
+            line.push_back('\n');
+            outfile << line;
+        }
+    }
+
+    void BM_RawRead(benchmark::State& state)
+    {
+        std::unique_ptr<char[]> buffer(new char[BoundedLineReader::default_buffer_size]);
+
+        for (auto _ : state)
+        {
+            const int fd = ::open(corpus_path.c_str(), O_RDONLY);
+            std::size_t total = 0;
+            for (;;)
+            {
+                const auto count = ::read(fd, buffer.get(), BoundedLineReader::default_buffer_size);
+                if (count <= 0)
+                {
+                    break;
+                }
+                total += static_cast<std::size_t>(count);
+            }
+            ::close(fd);
+            benchmark::DoNotOptimize(total);
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * corpus_bytes));
+    }
+    BENCHMARK(BM_RawRead)->Unit(benchmark::kMillisecond);
+
+    void BM_BoundedLineReader(benchmark::State& state)
+    {
+        std::size_t skipped = 0;
+
+        for (auto _ : state)
+        {
+            auto reader = BoundedLineReader::open(corpus_path, max_record_length);
+            std::string_view record;
+            std::size_t total = 0;
+            while (reader.next(record))
+            {
+                total += record.length();
+            }
+            skipped = reader.records_skipped();
+            benchmark::DoNotOptimize(total);
+        }
+
+        state.counters["skipped"] = static_cast<double>(skipped);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * corpus_bytes));
+    }
+    BENCHMARK(BM_BoundedLineReader)->Unit(benchmark::kMillisecond);
+
+    void BM_StringGetline(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            std::ifstream infile(corpus_path, std::ios::binary);
+            std::string line;
+            std::size_t total = 0;
+            while (std::getline(infile, line))
+            {
+                if (line.length() <= max_record_length)
+                {
+                    total += line.length();
+                }
+            }
+            benchmark::DoNotOptimize(total);
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * corpus_bytes));
+    }
+    BENCHMARK(BM_StringGetline)->Unit(benchmark::kMillisecond);
+
+    // the approach the original program used: getline into a char[20] and recover on failure
+    void BM_CharArrayGetline(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            std::ifstream infile(corpus_path, std::ios::binary);
+            char user_input[max_record_length + 1];
+            std::size_t total = 0;
+            for (;;)
+            {
+                infile.getline(user_input, sizeof(user_input));
+                if (infile.eof())
+                {
+                    break;
+                }
+                if (infile.fail())
+                { // over-length record, throw away the rest of the line
+                    infile.clear();
+                    infile.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    continue;
+                }
+                total += static_cast<std::size_t>(infile.gcount());
+            }
+            benchmark::DoNotOptimize(total);
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * corpus_bytes));
+    }
+    BENCHMARK(BM_CharArrayGetline)->Unit(benchmark::kMillisecond);
+
+    void BM_FixedStringReadLine(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            std::ifstream infile(corpus_path, std::ios::binary);
+            FixedString<max_record_length> user_input;
+            std::size_t total = 0;
+            while (user_input.read_line(infile))
+            {
+                total += user_input.length();
+            }
+            benchmark::DoNotOptimize(total);
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * corpus_bytes));
+    }
+    BENCHMARK(BM_FixedStringReadLine)->Unit(benchmark::kMillisecond);
+
+    // in memory inputs for the buffer copy benchmarks, the same length mix as the corpus
+    std::vector<std::string> sample_inputs()
+    {
+        std::mt19937 engine(405);
+        std::uniform_int_distribution<int> length(1, 26);
+        std::vector<std::string> inputs(1024);
+        for (auto& input : inputs)
+        {
+            input.assign(length(engine), 'x');
+        }
+        return inputs;
+    }
+
+    void BM_FixedStringAssign(benchmark::State& state)
+    {
+        const auto inputs = sample_inputs();
+        std::size_t index = 0;
+
+        for (auto _ : state)
+        {
+            FixedString<max_record_length> user_input;
+            user_input.assign(inputs[index++ & 1023]);
+            benchmark::DoNotOptimize(user_input.data());
+        }
+    }
+    BENCHMARK(BM_FixedStringAssign);
+
+    void BM_StdStringAssign(benchmark::State& state)
+    {
+        const auto inputs = sample_inputs();
+        std::size_t index = 0;
+
+        for (auto _ : state)
+        {
+            const std::string& input = inputs[index++ & 1023];
+            // the same bound the other buffers apply, lines past the SSO limit will hit the heap
+            std::string user_input(input, 0, max_record_length);
+            benchmark::DoNotOptimize(user_input.data());
+        }
+    }
+    BENCHMARK(BM_StdStringAssign);
+
+    void BM_CharArrayCopy(benchmark::State& state)
+    {
+        const auto inputs = sample_inputs();
+        std::size_t index = 0;
+
+        for (auto _ : state)
+        {
+            const std::string& input = inputs[index++ & 1023];
+            char user_input[max_record_length + 1];
+            const std::size_t count = input.length() < max_record_length ? input.length() : max_record_length;
+            std::memcpy(user_input, input.data(), count);
+            user_input[count] = '\0';
+            benchmark::DoNotOptimize(user_input);
+        }
+    }
+    BENCHMARK(BM_CharArrayCopy);
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t corpus_mb = take_benchmark_option(argc, argv, "corpus_mb", std::size_t(64));
+    corpus_path = take_benchmark_option(argc, argv, "input", std::string());
+
+    const bool generated = corpus_path.empty();
+    if (generated)
+    {
+        corpus_path = (std::filesystem::temp_directory_path() / "bounded_input_corpus.txt").string();
+        generate_corpus(corpus_path, corpus_mb << 20);
+    }
+    corpus_bytes = static_cast<std::size_t>(std::filesystem::file_size(corpus_path));
+
+    const int result = run_benchmarks(argc, argv);
+
+    if (generated)
+    {
+        std::filesystem::remove(corpus_path);
+    }
+
+    return result;
+}
@@ -3,6 +3,18 @@
 
 #include <iomanip>
 #include <iostream>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#include <io.h>
+#define isatty _isatty
+#else
+#include <unistd.h>
+#endif
+
+#include "BoundedLineReader.h"
+#include "FixedString.h"
 
 int main()
 {
@@ -14,23 +26,41 @@ int main()
 	//  variable, and its position in the declaration. It must always be directly before the variable used for input.
 
 	const std::string account_number = "CharlieBrown42";
-	char user_input[20];
-	std::cout << "Enter a value: ";
+	FixedString<19> user_input;
+	BoundedLineReader input_reader = BoundedLineReader::from_stdin(4096);
+	std::cout << "Enter a value: " << std::flush;
 	
 	//Unsafe, left room for overflow which is what we are trying to avoid
 	// std::cin >> user_input;
 
 
-	// Getline limits the amount of input using only one line of code
-	// use cin.fail()  used to detect if there are more characters entered than
-	// the 20 character limit we need to impose
-	std::cin.getline(user_input, 20);
-	if (std::cin.fail()) {
-		std::cout << "Detected a potential overflow! The input has been limited to 20 characters!" << std::endl;
+	// The reader hands back each record as a view into its own buffer and skips anything absurdly
+	// long rather than leaving the stream in a failed state, which lets us keep going through large
+	// piped inputs. user_input holds the same 19 characters the old char[20] did, but every write
+	// to it is bounded, so anything longer is truncated instead of running into account_number.
+	const bool interactive = isatty(0) != 0;
+	std::string_view record;
+	while (input_reader.next(record))
+	{
+		if (!user_input.assign(record)) {
+			std::cout << "Detected a potential overflow! The input has been limited to 19 characters!" << std::endl;
+		}
+
+		std::cout << "You entered: " << user_input << std::endl;
+
+		// someone at the keyboard only gets asked once
+		if (interactive)
+		{
+			break;
+		}
+	}
+
+	if (input_reader.records_skipped() > 0) {
+		std::cout << "Detected a potential overflow! " << input_reader.records_skipped()
+			<< " input(s) longer than " << input_reader.max_length() << " characters were skipped!" << std::endl;
 	}
 
 
-	std::cout << "You entered: " << user_input << std::endl;
 	std::cout << "Account Number = " << account_number << std::endl;
 }
 
@@ -0,0 +1,130 @@
+// 4-1 Exceptions Benchmark.cpp : Throw/catch against Expected result propagation.
+//
+// Each benchmark divides through a chain of nested calls, like main -> do_custom_application_logic ->
+// do_even_more_custom_application_logic, and handles the error at the top. Arguments are the error
+// rate in tenths of a percent (0, 1% and 50%) and the call depth.
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include "BenchmarkMain.h"
+#include "Exceptions.h"
+
+#if defined(_MSC_VER)
+#define BENCHMARK_NOINLINE __declspec(noinline)
+#else
+#define BENCHMARK_NOINLINE __attribute__((noinline))
+#endif
+
+namespace
+{
+    const std::size_t denominator_count = 4096;
+
+    /// <summary>
+    /// Denominators with zeros sprinkled in at the requested rate, always from the same seed
+    /// </summary>
+    std::vector<float> make_denominators(int error_permille)
+    {
+        std::mt19937 engine(405);
+        std::uniform_int_distribution<int> roll(0, 999);
+        std::vector<float> denominators(denominator_count);
+        for (auto& denominator : denominators)
+        {
+            denominator = roll(engine) < error_permille ? 0.0f : 2.0f;
+        }
+        return denominators;
+    }
+
+    BENCHMARK_NOINLINE float throwing_chain(int depth, float denominator)
+    {
+        if (depth == 0)
+        {
+            return divide(10.0f, denominator);
+        }
+        // the addition keeps the call from becoming a tail call
+        return throwing_chain(depth - 1, denominator) + 1.0f;
+    }
+
+    BENCHMARK_NOINLINE Expected<float> result_chain(int depth, float denominator) noexcept
+    {
+        if (depth == 0)
+        {
+            return try_divide(10.0f, denominator);
+        }
+
+        const auto result = result_chain(depth - 1, denominator);
+        if (!result)
+        {
+            return make_unexpected(result.error());
+        }
+        return *result + 1.0f;
+    }
+
+    void BM_ThrowCatch(benchmark::State& state)
+    {
+        const auto denominators = make_denominators(static_cast<int>(state.range(0)));
+        const int depth = static_cast<int>(state.range(1));
+        std::size_t index = 0;
+        std::size_t errors = 0;
+
+        for (auto _ : state)
+        {
+            try
+            {
+                benchmark::DoNotOptimize(throwing_chain(depth, denominators[index++ % denominator_count]));
+            }
+            catch (const std::exception& exception)
+            {
+                benchmark::DoNotOptimize(exception.what());
+                ++errors;
+            }
+        }
+
+        state.counters["error_rate"] = benchmark::Counter(static_cast<double>(errors), benchmark::Counter::kAvgIterations);
+    }
+
+    void BM_ResultPropagation(benchmark::State& state)
+    {
+        const auto denominators = make_denominators(static_cast<int>(state.range(0)));
+        const int depth = static_cast<int>(state.range(1));
+        std::size_t index = 0;
+        std::size_t errors = 0;
+
+        for (auto _ : state)
+        {
+            const auto result = result_chain(depth, denominators[index++ % denominator_count]);
+            if (result)
+            {
+                benchmark::DoNotOptimize(*result);
+            }
+            else if (result.error().is_a(std_exception_category))
+            {
+                benchmark::DoNotOptimize(result.error().what());
+                ++errors;
+            }
+        }
+
+        state.counters["error_rate"] = benchmark::Counter(static_cast<double>(errors), benchmark::Counter::kAvgIterations);
+    }
+
+    void error_rates_and_depths(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->ArgNames({ "error_permille", "depth" });
+        for (int error_permille : { 0, 10, 500 })
+        {
+            for (int depth : { 1, 4, 16, 64 })
+            {
+                benchmark->Args({ error_permille, depth });
+            }
+        }
+    }
+
+    BENCHMARK(BM_ThrowCatch)->Apply(error_rates_and_depths);
+    BENCHMARK(BM_ResultPropagation)->Apply(error_rates_and_depths);
+}
+
+int main(int argc, char** argv)
+{
+    return run_benchmarks(argc, argv);
+}
@@ -0,0 +1,329 @@
+// 4-1 Exceptions Profiler.cpp : What each part of the exceptions example actually costs.
+//
+// Measures throwing, catching by derived type (MyCustomException), base type (std::exception) and
+// catch-all, rethrowing, and handling an exception inside a noexcept function the way do_division
+// does. Every benchmark is parameterized by the stack depth the exception travels through and the
+// number of objects with destructors in each frame. Alongside ns/op, instructions/op and cycles/op
+// are reported when perf_event_open counters are available.
+
+#include <cstdio>
+#include <stdexcept>
+
+#include "BenchmarkMain.h"
+#include "Exceptions.h"
+#include "PerfCounters.h"
+
+#if defined(_MSC_VER)
+#define BENCHMARK_NOINLINE __declspec(noinline)
+#else
+#define BENCHMARK_NOINLINE __attribute__((noinline))
+#endif
+
+namespace
+{
+    // an object whose destructor has to run while the stack unwinds
+    struct Guard
+    {
+        ~Guard()
+        {
+            benchmark::DoNotOptimize(this);
+        }
+    };
+
+    template <int Objects>
+    struct FrameObjects
+    {
+        Guard guards[Objects];
+    };
+
+    template <>
+    struct FrameObjects<0>
+    {
+    };
+
+    // how the exception gets back to the top of the chain
+    enum class Passage
+    {
+        // straight through every frame
+        unwind,
+        // every frame catches and rethrows it
+        rethrow
+    };
+
+    template <typename Exception, int Objects, Passage Mode>
+    BENCHMARK_NOINLINE int call_chain(int depth, bool fail)
+    {
+        FrameObjects<Objects> objects;
+        benchmark::DoNotOptimize(&objects);
+
+        if (depth == 0)
+        {
+            if (fail)
+            {
+                throw Exception();
+            }
+            return 0;
+        }
+
+        if (Mode == Passage::rethrow)
+        {
+            try
+            {
+                return call_chain<Exception, Objects, Mode>(depth - 1, fail) + 1;
+            }
+            catch (...)
+            {
+                throw;
+            }
+        }
+
+        // the addition keeps the call from becoming a tail call
+        return call_chain<Exception, Objects, Mode>(depth - 1, fail) + 1;
+    }
+
+    // std::runtime_error needs a message, so give it the one divide uses
+    struct DivisionError : std::runtime_error
+    {
+        DivisionError()
+            : std::runtime_error(division_by_zero_message)
+        {
+        }
+    };
+
+    void report_counters(benchmark::State& state, const PerfCounters& counters)
+    {
+        if (counters.available())
+        {
+            state.counters["instructions/op"] = benchmark::Counter(static_cast<double>(counters.instructions()), benchmark::Counter::kAvgIterations);
+        }
+        if (counters.cycles_available())
+        {
+            state.counters["cycles/op"] = benchmark::Counter(static_cast<double>(counters.cycles()), benchmark::Counter::kAvgIterations);
+        }
+    }
+
+    // the call chain with nothing thrown, the cost every other benchmark is compared against
+    template <int Objects>
+    void BM_NoThrow(benchmark::State& state)
+    {
+        const int depth = static_cast<int>(state.range(0));
+        PerfCounters counters;
+
+        counters.start();
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(call_chain<MyCustomException, Objects, Passage::unwind>(depth, false));
+        }
+        counters.stop();
+
+        report_counters(state, counters);
+    }
+
+    template <int Objects>
+    void BM_CatchDerived(benchmark::State& state)
+    {
+        const int depth = static_cast<int>(state.range(0));
+        PerfCounters counters;
+
+        counters.start();
+        for (auto _ : state)
+        {
+            try
+            {
+                benchmark::DoNotOptimize(call_chain<MyCustomException, Objects, Passage::unwind>(depth, true));
+            }
+            catch (const MyCustomException& exception)
+            {
+                benchmark::DoNotOptimize(&exception);
+            }
+        }
+        counters.stop();
+
+        report_counters(state, counters);
+    }
+
+    template <int Objects>
+    void BM_CatchBase(benchmark::State& state)
+    {
+        const int depth = static_cast<int>(state.range(0));
+        PerfCounters counters;
+
+        counters.start();
+        for (auto _ : state)
+        {
+            try
+            {
+                benchmark::DoNotOptimize(call_chain<MyCustomException, Objects, Passage::unwind>(depth, true));
+            }
+            catch (const std::exception& exception)
+            {
+                benchmark::DoNotOptimize(&exception);
+            }
+        }
+        counters.stop();
+
+        report_counters(state, counters);
+    }
+
+    template <int Objects>
+    void BM_CatchAll(benchmark::State& state)
+    {
+        const int depth = static_cast<int>(state.range(0));
+        PerfCounters counters;
+
+        counters.start();
+        for (auto _ : state)
+        {
+            try
+            {
+                benchmark::DoNotOptimize(call_chain<MyCustomException, Objects, Passage::unwind>(depth, true));
+            }
+            catch (...)
+            {
+                benchmark::ClobberMemory();
+            }
+        }
+        counters.stop();
+
+        report_counters(state, counters);
+    }
+
+    // main's handler order: the custom exception is tested first, so a std::runtime_error from
+    // divide has to be matched against it before it reaches the std::exception handler
+    template <int Objects>
+    void BM_CatchInHandlerOrder(benchmark::State& state)
+    {
+        const int depth = static_cast<int>(state.range(0));
+        PerfCounters counters;
+
+        counters.start();
+        for (auto _ : state)
+        {
+            try
+            {
+                benchmark::DoNotOptimize(call_chain<DivisionError, Objects, Passage::unwind>(depth, true));
+            }
+            catch (const MyCustomException& exception)
+            {
+                benchmark::DoNotOptimize(&exception);
+            }
+            catch (const std::exception& exception)
+            {
+                benchmark::DoNotOptimize(exception.what());
+            }
+            catch (...)
+            {
+                benchmark::ClobberMemory();
+            }
+        }
+        counters.stop();
+
+        report_counters(state, counters);
+    }
+
+    template <int Objects>
+    void BM_Rethrow(benchmark::State& state)
+    {
+        const int depth = static_cast<int>(state.range(0));
+        PerfCounters counters;
+
+        counters.start();
+        for (auto _ : state)
+        {
+            try
+            {
+                benchmark::DoNotOptimize(call_chain<MyCustomException, Objects, Passage::rethrow>(depth, true));
+            }
+            catch (const MyCustomException& exception)
+            {
+                benchmark::DoNotOptimize(&exception);
+            }
+        }
+        counters.stop();
+
+        report_counters(state, counters);
+    }
+
+    // do_division's shape: a noexcept function that must catch everything it calls into
+    template <int Objects>
+    BENCHMARK_NOINLINE int noexcept_boundary(int depth, bool fail) noexcept
+    {
+        try
+        {
+            return call_chain<DivisionError, Objects, Passage::unwind>(depth, fail);
+        }
+        catch (const std::exception& exception)
+        {
+            benchmark::DoNotOptimize(exception.what());
+            return -1;
+        }
+    }
+
+    template <int Objects>
+    void BM_NoexceptBoundaryNoThrow(benchmark::State& state)
+    {
+        const int depth = static_cast<int>(state.range(0));
+        PerfCounters counters;
+
+        counters.start();
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(noexcept_boundary<Objects>(depth, false));
+        }
+        counters.stop();
+
+        report_counters(state, counters);
+    }
+
+    template <int Objects>
+    void BM_NoexceptBoundaryThrow(benchmark::State& state)
+    {
+        const int depth = static_cast<int>(state.range(0));
+        PerfCounters counters;
+
+        counters.start();
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(noexcept_boundary<Objects>(depth, true));
+        }
+        counters.stop();
+
+        report_counters(state, counters);
+    }
+
+    void depths(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->ArgName("depth");
+        for (int depth : { 0, 1, 4, 16, 64 })
+        {
+            benchmark->Arg(depth);
+        }
+    }
+
+    // the number of objects per frame is a template argument, so register each count separately
+#define PROFILE_EXCEPTIONS(name)                         \
+    BENCHMARK_TEMPLATE(name, 0)->Apply(depths);          \
+    BENCHMARK_TEMPLATE(name, 1)->Apply(depths);          \
+    BENCHMARK_TEMPLATE(name, 4)->Apply(depths);          \
+    BENCHMARK_TEMPLATE(name, 16)->Apply(depths)
+
+    PROFILE_EXCEPTIONS(BM_NoThrow);
+    PROFILE_EXCEPTIONS(BM_CatchDerived);
+    PROFILE_EXCEPTIONS(BM_CatchBase);
+    PROFILE_EXCEPTIONS(BM_CatchAll);
+    PROFILE_EXCEPTIONS(BM_CatchInHandlerOrder);
+    PROFILE_EXCEPTIONS(BM_Rethrow);
+    PROFILE_EXCEPTIONS(BM_NoexceptBoundaryNoThrow);
+    PROFILE_EXCEPTIONS(BM_NoexceptBoundaryThrow);
+}
+
+int main(int argc, char** argv)
+{
+    PerfCounters probe;
+    if (!probe.available())
+    {
+        std::fprintf(stderr, "perf_event_open counters are unavailable, reporting timings only\n");
+    }
+
+    return run_benchmarks(argc, argv);
+}
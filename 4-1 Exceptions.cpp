@@ -2,16 +2,11 @@
 //
 
 #include <iostream>
+#include <system_error>
 
+#include "ErrorEventRing.h"
+#include "Exceptions.h"
 
-//Custom exception class that extends from the std::exception
-struct MyCustomException : public std::exception
-{
-    virtual const char* what() const throw()
-    {
-        return "Custom exception has been thrown!";
-    }
-};
 
 bool do_even_more_custom_application_logic()
 {
@@ -37,7 +32,7 @@ void do_custom_application_logic()
     }
     catch (const std::exception &exception)
     {
-        std::cerr << "Exception: " << exception.what() << std::endl;
+        error_reporter().report(exception);
     }
     // TODO: Throw a custom exception derived from std::exception
     //  and catch it explictly in main
@@ -47,17 +42,6 @@ void do_custom_application_logic()
 
 }
 
-float divide(float num, float den)
-{
-    // TODO: Throw an exception to deal with divide by zero errors using
-    //  a standard C++ defined exception
-    if (den == 0) {
-        throw std::runtime_error("Error: division by zero is undefined!");
-    }
-
-    return (num / den);
-}
-
 void do_division() noexcept
 {
     //  TODO: create an exception handler to capture ONLY the exception thrown
@@ -74,13 +58,69 @@ void do_division() noexcept
 
     catch (const std::exception &exception) 
     {
-        std::cerr << "Exception: " << exception.what() << std::endl;
+        error_reporter().report(exception);
+    }
+
+}
+
+// Non-throwing variants of the functions above. Errors come back as Expected results and
+// are checked by category, in the same order main catches the exceptions.
+
+Expected<bool> try_do_even_more_custom_application_logic() noexcept
+{
+    std::cout << "Running Even More Custom Application Logic." << std::endl;
+
+    return true;
+}
+
+Expected<void> try_do_custom_application_logic() noexcept
+{
+    std::cout << "Running Custom Application Logic." << std::endl;
+
+    const auto result = try_do_even_more_custom_application_logic();
+    if (!result)
+    {
+        error_reporter().report(result.error());
+    }
+    else if (*result)
+    {
+        std::cout << "Even More Custom Application Logic has Succeeded!" << std::endl;
     }
 
+    // the counterpart of throwing MyCustomException
+    return make_unexpected(Error(custom_exception_category, custom_exception_message));
+}
+
+void try_do_division() noexcept
+{
+    float numerator = 10.0f;
+    float denominator = 0;
+
+    const auto result = try_divide(numerator, denominator);
+    if (result)
+    {
+        std::cout << "divide(" << numerator << ", " << denominator << ") = " << *result << std::endl;
+    }
+    else
+    {
+        error_reporter().report(result.error());
+    }
 }
 
 int main()
 {
+    // start the reporter's drainer thread here rather than on the first report, which can come from
+    // inside noexcept do_division, where a std::system_error from creating the thread would terminate
+    try
+    {
+        error_reporter();
+    }
+    catch (const std::system_error& exception)
+    {
+        std::cerr << "Cannot start the error reporter: " << exception.what() << std::endl;
+        return 1;
+    }
+
     try
     {
         std::cout << "Exceptions Tests!" << std::endl;
@@ -96,20 +136,45 @@ int main()
 
     catch (const MyCustomException& exception)
     {
-        std::cerr << "Exception: " << exception.what() << std::endl;
+        error_reporter().report(exception);
     }
 
+    // only the custom exception is anticipated here, anything else reaching main is critical
     catch (const std::exception& exception)
     {
-        std::cerr << "Exception: " << exception.what() << std::endl;
+        error_reporter().report(exception, ErrorSeverity::critical);
     }
 
     catch (...)
     {
+        error_reporter().report("unknown exception", "", ErrorSeverity::critical);
+    }
+
+    std::cout << "Result Tests!" << std::endl;
 
+    try_do_division();
+    const auto result = try_do_custom_application_logic();
+    if (!result)
+    {
+        // checked in the same order as the catch blocks above, with the same severities: the custom
+        // category first, then any other std::exception counterpart, then whatever is left
+        if (result.error().is_a(custom_exception_category))
+        {
+            error_reporter().report(result.error());
+        }
+        else if (result.error().is_a(std_exception_category))
+        {
+            error_reporter().report(result.error(), ErrorSeverity::critical);
+        }
+        else
+        {
+            error_reporter().report("unknown error", result.error().what(), ErrorSeverity::critical);
+        }
     }
 
+    // handlers only queue their events, so make sure they are all written before exiting
+    error_reporter().flush();
 }
 
 // Run program: Ctrl + F5 or Debug > Start Without Debugging menu
-// Debug program: F5 or Debug > Start Debugging menu
\ No newline at end of file
+// Debug program: F5 or Debug > Start Debugging menu
\ No newline at end of file
@@ -0,0 +1,294 @@
+// 4-2 Sharded Test Runner.cpp : Runs a gtest program as parallel shards and reports the slowest tests.
+//
+// Usage: sharded_test_runner [--shards=N] [--slowest=N] <test program> [test arguments...]
+//
+// gtest cannot run tests concurrently inside one process, so each shard is a separate process started
+// with GTEST_TOTAL_SHARDS and GTEST_SHARD_INDEX, supervised by its own thread here. Every shard gets
+// the same RANDOM_SEED, so a failure can be replayed with that seed whatever shard the test landed in,
+// and writes its per test wall times through TestTimingListener for the merged report.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+#include "Random.h"
+#include "TestTimingListener.h"
+
+namespace
+{
+    struct Shard
+    {
+        int index = 0;
+        int exit_code = -1;
+        std::filesystem::path log;
+        std::filesystem::path timings;
+    };
+
+#ifdef _WIN32
+    std::string quote(const std::string& text)
+    {
+        return "\"" + text + "\"";
+    }
+
+    int run_shard(const Shard& shard, int total, std::uint64_t seed, const std::vector<std::string>& command)
+    {
+        std::string line = "set GTEST_TOTAL_SHARDS=" + std::to_string(total) + "&& set GTEST_SHARD_INDEX=" + std::to_string(shard.index)
+            + "&& set RANDOM_SEED=" + std::to_string(seed) + "&& set TEST_TIMING_FILE=" + shard.timings.string() + "&&";
+        for (const auto& argument : command)
+        {
+            line += " " + quote(argument);
+        }
+        line += " > " + quote(shard.log.string()) + " 2>&1";
+        return std::system(("cmd /C \"" + line + "\"").c_str());
+    }
+#else
+    int run_shard(const Shard& shard, int total, std::uint64_t seed, const std::vector<std::string>& command)
+    {
+        // the parent's environment plus the shard variables, which replace any inherited ones
+        const std::string variables[] = {
+            "GTEST_TOTAL_SHARDS=" + std::to_string(total),
+            "GTEST_SHARD_INDEX=" + std::to_string(shard.index),
+            "RANDOM_SEED=" + std::to_string(seed),
+            "TEST_TIMING_FILE=" + shard.timings.string(),
+        };
+        std::vector<char*> environment;
+        for (char** variable = environ; *variable != nullptr; ++variable)
+        {
+            bool replaced = false;
+            for (const auto& own : variables)
+            {
+                const auto name_length = own.find('=') + 1;
+                replaced = replaced || std::strncmp(*variable, own.c_str(), name_length) == 0;
+            }
+            if (!replaced)
+            {
+                environment.push_back(*variable);
+            }
+        }
+        for (const auto& own : variables)
+        {
+            environment.push_back(const_cast<char*>(own.c_str()));
+        }
+        environment.push_back(nullptr);
+
+        std::vector<char*> arguments;
+        for (const auto& argument : command)
+        {
+            arguments.push_back(const_cast<char*>(argument.c_str()));
+        }
+        arguments.push_back(nullptr);
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addopen(&actions, 1, shard.log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        posix_spawn_file_actions_adddup2(&actions, 1, 2);
+
+        pid_t child = 0;
+        const int error = posix_spawnp(&child, arguments[0], &actions, nullptr, arguments.data(), environment.data());
+        posix_spawn_file_actions_destroy(&actions);
+        if (error != 0)
+        {
+            std::ofstream(shard.log) << "cannot start " << command[0] << ": " << std::strerror(error) << std::endl;
+            return -1;
+        }
+
+        int status = 0;
+        if (waitpid(child, &status, 0) < 0)
+        {
+            return -1;
+        }
+        return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    }
+#endif
+
+    /// <summary>
+    /// Read the lines TestTimingListener wrote, false if the shard never got to write them
+    /// </summary>
+    bool read_timings(const std::filesystem::path& path, std::vector<TestTiming>& timings)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            return false;
+        }
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            std::istringstream fields(line);
+            long long microseconds = 0;
+            TestTiming timing;
+            std::string result;
+            if (fields >> microseconds && fields.get() == '\t' && std::getline(fields, timing.name, '\t') && std::getline(fields, result))
+            {
+                timing.elapsed = std::chrono::microseconds(microseconds);
+                timing.passed = result == "passed";
+                timings.push_back(std::move(timing));
+            }
+        }
+        return true;
+    }
+
+    /// <summary>
+    /// Create a scratch directory no other run can be using. The seed is in the name so kept output is
+    /// easy to match to its run; the pid and a random suffix keep concurrent runs with the same seed apart.
+    /// </summary>
+    std::filesystem::path create_scratch_directory(std::uint64_t seed)
+    {
+#ifdef _WIN32
+        const int pid = _getpid();
+#else
+        const int pid = static_cast<int>(::getpid());
+#endif
+        std::random_device entropy;
+        for (;;)
+        {
+            const auto directory = std::filesystem::temp_directory_path()
+                / ("sharded_tests_" + std::to_string(seed) + "_" + std::to_string(pid) + "_" + std::to_string(entropy()));
+            // create_directory is atomic and reports false when the name is already taken
+            if (std::filesystem::create_directory(directory))
+            {
+                return directory;
+            }
+        }
+    }
+
+    bool take_option(const std::string& argument, const char* name, unsigned long& value)
+    {
+        const std::string prefix = std::string("--") + name + "=";
+        if (argument.compare(0, prefix.size(), prefix) != 0)
+        {
+            return false;
+        }
+        value = std::strtoul(argument.c_str() + prefix.size(), nullptr, 10);
+        return true;
+    }
+
+    void usage()
+    {
+        std::cerr << "usage: sharded_test_runner [--shards=N] [--slowest=N] <test program> [test arguments...]" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned long shard_count = std::thread::hardware_concurrency();
+    unsigned long slowest = 10;
+
+    int first = 1;
+    for (; first < argc; ++first)
+    {
+        const std::string argument = argv[first];
+        if (!take_option(argument, "shards", shard_count) && !take_option(argument, "slowest", slowest))
+        {
+            break;
+        }
+    }
+    if (first == argc)
+    {
+        usage();
+        return 2;
+    }
+    if (shard_count == 0)
+    {
+        shard_count = 1;
+    }
+
+    const std::vector<std::string> command(argv + first, argv + argc);
+    const std::uint64_t seed = random_seed();
+    const int total = static_cast<int>(shard_count);
+
+    const auto directory = create_scratch_directory(seed);
+
+    std::vector<Shard> shards(shard_count);
+    for (int i = 0; i < total; ++i)
+    {
+        shards[i].index = i;
+        shards[i].log = directory / ("shard_" + std::to_string(i) + ".log");
+        shards[i].timings = directory / ("shard_" + std::to_string(i) + ".timings");
+    }
+
+    std::cout << "Running " << command[0] << " in " << total << " shard(s) with RANDOM_SEED=" << seed << std::endl;
+
+    const auto started = std::chrono::steady_clock::now();
+    {
+        std::vector<std::thread> workers;
+        for (auto& shard : shards)
+        {
+            workers.emplace_back([&shard, total, seed, &command] {
+                shard.exit_code = run_shard(shard, total, seed, command);
+            });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+    const auto wall = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+
+    std::vector<TestTiming> timings;
+    bool failed = false;
+    for (const auto& shard : shards)
+    {
+        const bool timed = read_timings(shard.timings, timings);
+        if (shard.exit_code != 0 || !timed)
+        {
+            failed = true;
+            std::cout << std::endl << "Shard " << shard.index << " failed with exit code " << shard.exit_code
+                      << (timed ? "" : " before reporting its timings") << ", output:" << std::endl;
+            // streaming an empty rdbuf would set failbit on std::cout, so go through a string
+            std::ostringstream output;
+            output << std::ifstream(shard.log).rdbuf();
+            std::cout << output.str() << std::endl;
+        }
+    }
+
+    std::chrono::microseconds test_time{ 0 };
+    std::size_t failures = 0;
+    for (const auto& timing : timings)
+    {
+        test_time += timing.elapsed;
+        if (!timing.passed)
+        {
+            ++failures;
+            std::cout << "FAILED: " << timing.name << std::endl;
+        }
+    }
+
+    std::cout << std::endl << timings.size() << " test(s), " << failures << " failed, " << test_time.count() / 1000.0 << " ms of test time in "
+              << wall.count() / 1000.0 << " ms wall time" << std::endl;
+    if (slowest > 0 && !timings.empty())
+    {
+        std::fflush(stdout);
+        print_slowest_tests(timings, slowest);
+    }
+
+    if (failed)
+    {
+        std::cout << "Shard output kept in " << directory.string() << ", replay with RANDOM_SEED=" << seed << std::endl;
+        return 1;
+    }
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,213 @@
+// 4-2 Unit Testing Benchmark.cpp : Timings for the std::vector<int> operations the CollectionTest suite checks.
+//
+// Every benchmark runs for collection sizes from 1 to 10M. Erase and clear leave nothing for the next
+// iteration, so they are timed together with a refill, and Refill alone is the baseline to subtract. Results go to the console and, unless
+// --benchmark_out is given, to collection_benchmark.json so runs can be compared between builds.
+
+#include <memory>
+#include <vector>
+
+#include "BenchmarkMain.h"
+#include "Random.h"
+
+// the same shared data the CollectionTest fixture sets up, kept in step with it
+class CollectionBenchmark : public benchmark::Fixture
+{
+public:
+    // create a smart point to hold our collection
+    std::unique_ptr<std::vector<int>> collection;
+
+    void SetUp(const benchmark::State&) override
+    { // create a new collection to be used in the benchmark
+        collection.reset(new std::vector<int>);
+    }
+
+    void TearDown(const benchmark::State&) override
+    { //  erase all elements in the collection, if any remain
+        collection->clear();
+        // free the pointer
+        collection.reset(nullptr);
+    }
+
+    // helper function to add random values from 0 to 99 count times to the collection
+    void add_entries(int count)
+    {
+        const auto start = collection->size();
+        collection->resize(start + count);
+        thread_random().fill_below(collection->data() + start, count, 100);
+    }
+
+protected:
+    // benchmarks that empty the collection refill it from here on every iteration. Refilling
+    // with the timer paused would leave almost nothing to time, so the copy is timed as well
+    // and the Refill benchmark measures it on its own for comparison.
+    std::vector<int> source;
+
+    void fill_source(int count)
+    {
+        source.resize(count);
+        thread_random().fill_below(source, 100);
+    }
+};
+
+// growth from add_entries without a reserve, the way every CollectionTest uses it
+BENCHMARK_DEFINE_F(CollectionBenchmark, AddEntriesUnreserved)(benchmark::State& state)
+{
+    const auto count = static_cast<int>(state.range(0));
+    for (auto _ : state)
+    {
+        collection.reset(new std::vector<int>);
+        add_entries(count);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(CollectionBenchmark, AddEntriesReserved)(benchmark::State& state)
+{
+    const auto count = static_cast<int>(state.range(0));
+    for (auto _ : state)
+    {
+        collection.reset(new std::vector<int>);
+        collection->reserve(count);
+        add_entries(count);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// push_back on its own, without random numbers in the loop
+BENCHMARK_DEFINE_F(CollectionBenchmark, PushBack)(benchmark::State& state)
+{
+    const auto count = static_cast<int>(state.range(0));
+    for (auto _ : state)
+    {
+        collection.reset(new std::vector<int>);
+        for (auto i = 0; i < count; ++i)
+            collection->push_back(i);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(CollectionBenchmark, ResizeIncrease)(benchmark::State& state)
+{
+    const auto count = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state)
+    {
+        collection.reset(new std::vector<int>);
+        collection->resize(count);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(CollectionBenchmark, Refill)(benchmark::State& state)
+{
+    fill_source(static_cast<int>(state.range(0)));
+    for (auto _ : state)
+    {
+        *collection = source;
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(CollectionBenchmark, RefillResizeToZero)(benchmark::State& state)
+{
+    fill_source(static_cast<int>(state.range(0)));
+    for (auto _ : state)
+    {
+        *collection = source;
+        collection->resize(0);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(CollectionBenchmark, Reserve)(benchmark::State& state)
+{
+    const auto count = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state)
+    {
+        collection.reset(new std::vector<int>);
+        collection->reserve(count);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(CollectionBenchmark, RefillEraseRange)(benchmark::State& state)
+{
+    fill_source(static_cast<int>(state.range(0)));
+    for (auto _ : state)
+    {
+        *collection = source;
+        collection->erase(collection->begin(), collection->end());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(CollectionBenchmark, RefillClear)(benchmark::State& state)
+{
+    fill_source(static_cast<int>(state.range(0)));
+    for (auto _ : state)
+    {
+        *collection = source;
+        collection->clear();
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// bounds checked access against unchecked access over the whole collection
+BENCHMARK_DEFINE_F(CollectionBenchmark, At)(benchmark::State& state)
+{
+    const auto count = static_cast<std::size_t>(state.range(0));
+    add_entries(static_cast<int>(count));
+    for (auto _ : state)
+    {
+        long long sum = 0;
+        for (std::size_t i = 0; i < count; ++i)
+            sum += collection->at(i);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(CollectionBenchmark, Subscript)(benchmark::State& state)
+{
+    const auto count = static_cast<std::size_t>(state.range(0));
+    add_entries(static_cast<int>(count));
+    for (auto _ : state)
+    {
+        long long sum = 0;
+        for (std::size_t i = 0; i < count; ++i)
+            sum += (*collection)[i];
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// sizes 1, 10, 100 ... 10M
+#define COLLECTION_SIZES RangeMultiplier(10)->Range(1, 10000000)
+
+BENCHMARK_REGISTER_F(CollectionBenchmark, AddEntriesUnreserved)->COLLECTION_SIZES;
+BENCHMARK_REGISTER_F(CollectionBenchmark, AddEntriesReserved)->COLLECTION_SIZES;
+BENCHMARK_REGISTER_F(CollectionBenchmark, PushBack)->COLLECTION_SIZES;
+BENCHMARK_REGISTER_F(CollectionBenchmark, ResizeIncrease)->COLLECTION_SIZES;
+BENCHMARK_REGISTER_F(CollectionBenchmark, Refill)->COLLECTION_SIZES;
+BENCHMARK_REGISTER_F(CollectionBenchmark, RefillResizeToZero)->COLLECTION_SIZES;
+BENCHMARK_REGISTER_F(CollectionBenchmark, Reserve)->COLLECTION_SIZES;
+BENCHMARK_REGISTER_F(CollectionBenchmark, RefillEraseRange)->COLLECTION_SIZES;
+BENCHMARK_REGISTER_F(CollectionBenchmark, RefillClear)->COLLECTION_SIZES;
+BENCHMARK_REGISTER_F(CollectionBenchmark, At)->COLLECTION_SIZES;
+BENCHMARK_REGISTER_F(CollectionBenchmark, Subscript)->COLLECTION_SIZES;
+
+int main(int argc, char** argv)
+{
+    print_random_seed();
+
+    return run_benchmarks(argc, argv, "collection_benchmark.json");
+}
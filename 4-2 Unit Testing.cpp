@@ -2,6 +2,14 @@
 #include "pch.h"
 // uncomment the next line if you do not use precompiled headers
 //#include "gtest/gtest.h"
+#include <cmath>
+#include <limits>
+#include <new>
+
+#include "AllocationAssertions.h"
+#include "CollectionAllocators.h"
+#include "Random.h"
+#include "TestTimingListener.h"
 //
 // the global test environment setup and tear down
 // you should not need to change anything here
@@ -13,29 +21,77 @@ public:
     // Override this to define how to set up the environment.
     void SetUp() override
     {
-        //  initialize random seed
-        srand(time(nullptr));
+        // every test draws from its own stream seeded from RANDOM_SEED and its name, so there is no
+        // shared generator to seed here and the tests can run in any order or shard
+        print_random_seed(stdout);
     }
 
     // Override this to define how to tear down the environment.
     void TearDown() override {}
 };
 
+// gtest_main provides main, so the environment registers itself before it runs
+static ::testing::Environment* const environment = ::testing::AddGlobalTestEnvironment(new Environment);
+
+// record per test wall times for TEST_TIMING_FILE and TEST_SLOWEST. Registered here rather than in
+// Environment::SetUp, which gtest skips when a shard has no tests, so every shard writes its file.
+static ::testing::TestEventListener* const timing_listener = [] {
+    auto* listener = new TestTimingListener;
+    ::testing::UnitTest::GetInstance()->listeners().Append(listener);
+    return listener;
+}();
+
 // create our test class to house shared data between tests
-// you should not need to change anything here
+// every test runs once for each allocation strategy in CollectionAllocators.h
+template <typename Allocation>
 class CollectionTest : public ::testing::Test
 {
 protected:
+    using collection_type = Collection<Allocation>;
+
+    // owns the memory the collection allocates from, so it is declared first and destroyed last
+    Allocation allocation;
+
+    // for the pmr policies the collection allocates through this, so the tests can count the
+    // requests it makes of the policy's resource, which may not reach the heap at all
+    std::unique_ptr<CountingResource> requests;
+
     // create a smart point to hold our collection
-    std::unique_ptr<std::vector<int>> collection;
+    std::unique_ptr<collection_type> collection;
+
+    // the test's own random stream, so its data only depends on RANDOM_SEED and the test name
+    Xoshiro256 random{ 0 };
 
     void SetUp() override
-    { // create a new collection to be used in the test
-        collection.reset(new std::vector<int>);
+    { // the allocation tests need the counting operator new from AllocationCounter.cpp
+        ASSERT_TRUE(allocation_counter_installed());
+        // seed the random data for this test
+        const auto* test = ::testing::UnitTest::GetInstance()->current_test_info();
+        random = random_stream((std::string(test->test_suite_name()) + "." + test->name()).c_str());
+        // create a new collection to be used in the test
+        new_collection();
+    }
+
+    // replace the collection with an empty one, counting its requests afresh
+    void new_collection()
+    {
+        collection.reset();
+        if constexpr (Allocation::uses_memory_resource)
+        {
+            requests = std::make_unique<CountingResource>(allocation.resource());
+            collection.reset(new collection_type(typename Allocation::allocator_type(requests.get())));
+        }
+        else
+        {
+            collection.reset(new collection_type(allocation.allocator()));
+        }
     }
 
     void TearDown() override
-    { //  erase all elements in the collection, if any remain
+    { // show how to replay the random data of a failed test
+        if (HasFailure())
+            print_random_seed(stdout);
+        //  erase all elements in the collection, if any remain
         collection->clear();
         // free the pointer
         collection.reset(nullptr);
@@ -45,11 +101,26 @@ protected:
     void add_entries(int count)
     {
         assert(count > 0);
-        for (auto i = 0; i < count; ++i)
-            collection->push_back(rand() % 100);
+        const auto start = collection->size();
+        collection->resize(start + count);
+        random.fill_below(collection->data() + start, count, 100);
     }
 };
 
+// names the test instances after the policy, e.g. CollectionTest/monotonic_arena.IsEmptyOnCreate
+class AllocationNames
+{
+public:
+    template <typename Allocation>
+    static std::string GetName(int)
+    {
+        return Allocation::name;
+    }
+};
+
+using Allocations = ::testing::Types<StandardAllocation, MonotonicArenaAllocation, PoolAllocation>;
+TYPED_TEST_SUITE(CollectionTest, Allocations, AllocationNames);
+
 // When should you use the EXPECT_xxx or ASSERT_xxx macros?
 // Use ASSERT when failure should terminate processing, such as the reason for the test case.
 // Use EXPECT when failure should notify, but processing should continue
@@ -59,198 +130,198 @@ protected:
 //  CollectionTest::StartUp is called.
 // Following this method (and all other TEST_F defined methods),
 //  CollectionTest::TearDown is called
-TEST_F(CollectionTest, CollectionSmartPointerIsNotNull)
+TYPED_TEST(CollectionTest, CollectionSmartPointerIsNotNull)
 {
     // is the collection created
-    ASSERT_TRUE(collection);
+    ASSERT_TRUE(this->collection);
 
     // if empty, the size must be 0
-    ASSERT_NE(collection.get(), nullptr);
+    ASSERT_NE(this->collection.get(), nullptr);
 }
 
 // Test that a collection is empty when created.
-TEST_F(CollectionTest, IsEmptyOnCreate)
+TYPED_TEST(CollectionTest, IsEmptyOnCreate)
 {
     // is the collection empty?
-    ASSERT_TRUE(collection->empty());
+    ASSERT_TRUE(this->collection->empty());
 
     // if empty, the size must be 0
-    ASSERT_EQ(collection->size(), 0);
+    ASSERT_EQ(this->collection->size(), 0);
 }
 
 /* Comment this test out to prevent the test from running
  * Uncomment this test to see a failure in the test explorer */
 
-/* TEST_F(CollectionTest, AlwaysFail)
+/* TYPED_TEST(CollectionTest, AlwaysFail)
 {
     FAIL();
 }
 */
 
 // TODO: Create a test to verify adding a single value to an empty collection
-TEST_F(CollectionTest, CanAddToEmptyVector)
+TYPED_TEST(CollectionTest, CanAddToEmptyVector)
 {
     // is the collection empty?
     // if empty, the size must be 0
 
-    add_entries(1);
+    this->add_entries(1);
 
     // is the collection still empty?
     // if not empty, what must the size be?
 }
 
 // TODO: Create a test to verify adding five values to collection
-TEST_F(CollectionTest, CanAddFiveValuesToVector)
+TYPED_TEST(CollectionTest, CanAddFiveValuesToVector)
 {
-    add_entries(5);
+    this->add_entries(5);
 }
 
 // TODO: Create a test to verify that max size is greater than or equal to size for 0, 1, 5, 10 entries
-TEST_F(CollectionTest, MaxSizeGreaterThanOrEqualToSize)
+TYPED_TEST(CollectionTest, MaxSizeGreaterThanOrEqualToSize)
 {
     // Add 11 entries to to run this test
-    add_entries(11);
+    this->add_entries(11);
 
     // Check that max size is greater than or equal to size for 0 entries
-    ASSERT_TRUE(collection->max_size() >= 0);
+    ASSERT_TRUE(this->collection->max_size() >= 0);
 
     // Check that max size is greater than or equal to size for 1 entries
-    ASSERT_TRUE(collection->max_size() >= 1);
+    ASSERT_TRUE(this->collection->max_size() >= 1);
 
     // Check that max size is greater than or equal to size for 5 entries
-    ASSERT_TRUE(collection->max_size() >= 5);
+    ASSERT_TRUE(this->collection->max_size() >= 5);
 
     // Check that max size is greater than or equal to size for 10 entries
-    ASSERT_TRUE(collection->max_size() >= 10);
+    ASSERT_TRUE(this->collection->max_size() >= 10);
 
 }
 
 // TODO: Create a test to verify that capacity is greater than or equal to size for 0, 1, 5, 10 entries
-TEST_F(CollectionTest, CapacityGreaterThanOrEqualToSize) 
+TYPED_TEST(CollectionTest, CapacityGreaterThanOrEqualToSize) 
 {
     // Add 11 entries to to run this test
-    add_entries(11);
+    this->add_entries(11);
 
     // Check if capacity is greater than or equal to size for 0 entries
-    ASSERT_TRUE(collection->capacity() >= 0);
+    ASSERT_TRUE(this->collection->capacity() >= 0);
 
     // Check if capacity is greater than or equal to size for 1 entries
-    ASSERT_TRUE(collection->capacity() >= 1);
+    ASSERT_TRUE(this->collection->capacity() >= 1);
 
     // Check if capacity is greater than or equal to size for 5 entries
-    ASSERT_TRUE(collection->capacity() >= 5);
+    ASSERT_TRUE(this->collection->capacity() >= 5);
 
     // Check if capacity is greater than or equal to size for 10 entries
-    ASSERT_TRUE(collection->capacity() >= 10);
+    ASSERT_TRUE(this->collection->capacity() >= 10);
 
 }
 
 
 // TODO: Create a test to verify resizing increases the collection
-TEST_F(CollectionTest, ResizingIncreasesCollection)
+TYPED_TEST(CollectionTest, ResizingIncreasesCollection)
 {
     // Initialize collection entries
-    add_entries(1);
+    this->add_entries(1);
 
     //Initialize/Declare previous value to a collection size
-    int initialSize = collection->size();
+    int initialSize = this->collection->size();
 
     //Resize collection container to hold elements
-    collection->resize(15);
+    this->collection->resize(15);
 
     //Assert true if collection is larger than initial size
-    ASSERT_TRUE(collection->size() > initialSize);
+    ASSERT_TRUE(this->collection->size() > initialSize);
 
 }
 
 // TODO: Create a test to verify resizing decreases the collection
-TEST_F(CollectionTest, ResizingDecreasesCollection)
+TYPED_TEST(CollectionTest, ResizingDecreasesCollection)
 {
 
     // Initialize collection entries
-    add_entries(15);
+    this->add_entries(15);
 
     //Initialize/Declare previous value to a collection size
-    int initialSize = collection->size();
+    int initialSize = this->collection->size();
 
     //Resize collection container to hold elements
-    collection->resize(1);
+    this->collection->resize(1);
 
     //Assert true if collection is larger than initial size
-    ASSERT_TRUE(collection->size() < initialSize);
+    ASSERT_TRUE(this->collection->size() < initialSize);
 
 }
 
 // TODO: Create a test to verify resizing decreases the collection to zero
-TEST_F(CollectionTest, ResizingDecreasesCollectionToZero)
+TYPED_TEST(CollectionTest, ResizingDecreasesCollectionToZero)
 {
 
     // Initialize collection entries
-    add_entries(15);
+    this->add_entries(15);
 
     //Initialize/Declare previous value to a collection size
-    int initialSize = collection->size();
+    int initialSize = this->collection->size();
 
     //Clear collection to zero
-    collection->resize(0);
+    this->collection->resize(0);
 
     //Assert true if collection is larger than initial size
-    ASSERT_TRUE(collection->size() == 0);
+    ASSERT_TRUE(this->collection->size() == 0);
 
 }
 
 // TODO: Create a test to verify clear erases the collection
-TEST_F(CollectionTest, VerifyCollectionIsCleared) 
+TYPED_TEST(CollectionTest, VerifyCollectionIsCleared) 
 {
 
     // Initialize collection entries
-    add_entries(15);
+    this->add_entries(15);
 
     //Clear collection entries
-    collection->clear();
+    this->collection->clear();
 
     // Verify the collection has been resized to 0
-    ASSERT_TRUE(collection->size() == 0);
+    ASSERT_TRUE(this->collection->size() == 0);
 }
 
 // TODO: Create a test to verify erase(begin,end) erases the collection
-TEST_F(CollectionTest, VerifyCollectionIsErased) 
+TYPED_TEST(CollectionTest, VerifyCollectionIsErased) 
 {
 
     // Initalize collection entries
-    add_entries(15);
+    this->add_entries(15);
 
     // Erase the collection from begin() to end() (all)
-    collection->erase(collection->begin(), collection->end());
+    this->collection->erase(this->collection->begin(), this->collection->end());
 
     // Verify the collection has been resized to 0
-    ASSERT_TRUE(collection->size() == 0);
+    ASSERT_TRUE(this->collection->size() == 0);
 }
 
 
 // TODO: Create a test to verify reserve increases the capacity but not the size of the collection
-TEST_F(CollectionTest, VerifyThatReserveIncreasesCapacityButNotCollectionSize) 
+TYPED_TEST(CollectionTest, VerifyThatReserveIncreasesCapacityButNotCollectionSize) 
 {
     //Initalize collection entries
-    add_entries(15);
+    this->add_entries(15);
 
     //Initalize initial capcity
-    int initialCapacity = collection->capacity();
+    int initialCapacity = this->collection->capacity();
 
     //Initialize inital size
-    int initialSize = collection->size();
+    int initialSize = this->collection->size();
 
     // Container reserved to 50
-    collection->reserve(50);
+    this->collection->reserve(50);
 
     // Verify size is equal but capacity is larger
-    ASSERT_TRUE(collection->size() == initialSize);
-    ASSERT_TRUE(collection->capacity() > initialCapacity);
+    ASSERT_TRUE(this->collection->size() == initialSize);
+    ASSERT_TRUE(this->collection->capacity() > initialCapacity);
 }
 
 // TODO: Create a test to verify the std::out_of_range exception is thrown when calling at() with an index out of bounds
 // NOTE: This is a negative test
-TEST_F(CollectionTest, VerifyOORExceptionThrownWhenCallingIndexOOB)
+TYPED_TEST(CollectionTest, VerifyOORExceptionThrownWhenCallingIndexOOB)
 {
     //Initialize/define vector size 13
     std::vector<int> elements(13);
@@ -261,35 +332,187 @@ TEST_F(CollectionTest, VerifyOORExceptionThrownWhenCallingIndexOOB)
 
 // TODO: Create 2 unit tests of your own to test something on the collection - do 1 positive & 1 negative
 // Create a positive test
-TEST_F(CollectionTest, PushBackPositiveOutcome)
+TYPED_TEST(CollectionTest, PushBackPositiveOutcome)
 {
     //Initialize collection entries
-    add_entries(25);
+    this->add_entries(25);
 
     //push_back adds one, making 26 entries with the last one being a 1
-    collection->push_back(1);
+    this->collection->push_back(1);
 
     //Assert the collection size to be greater than 25
-    ASSERT_TRUE(collection->size() > 25);
+    ASSERT_TRUE(this->collection->size() > 25);
 
     //Assert that the number at 25, which is the 26th element in collection, to be 1
     //It should be equal to 1
-    ASSERT_TRUE(collection->at(25) == 1);
+    ASSERT_TRUE(this->collection->at(25) == 1);
 
 
 }
 
 //Create a negative test
-TEST_F(CollectionTest, PopBackNegativeOutcome)
+TYPED_TEST(CollectionTest, PopBackNegativeOutcome)
 {
     //Initialize collection entries
-    add_entries(25);
+    this->add_entries(25);
 
     //pop_back removes one element, typically the last one in a list
-    collection->pop_back();
+    this->collection->pop_back();
 
     //Assert the collection to be 25, which will be false because one element will be removed
     //which would make the real number of entries to be 24, this is assumed to be false = a negative test
-    ASSERT_FALSE(collection->size() == 25);
+    ASSERT_FALSE(this->collection->size() == 25);
+
+}
+
+// Allocation tests: these fail on a performance regression, not a wrong answer.
+// The counts are exact, so they fail the same way on every run instead of showing up as noisy timings.
+
+// reserve is the only allocation when everything pushed afterwards fits. The arena and the pool
+// may serve it without going to the heap at all, so for them the one request is counted at their
+// resource and the heap is only held to the policy's bound.
+TYPED_TEST(CollectionTest, ReserveThenPushBackAllocatesOnce)
+{
+    const auto reserve_and_fill = [this] {
+        this->collection->reserve(50);
+        for (auto i = 0; i < 50; ++i)
+            this->collection->push_back(i);
+    };
+
+    if constexpr (TypeParam::uses_memory_resource)
+    {
+        EXPECT_ALLOCATIONS_LE(TypeParam::max_heap_allocations_per_request, reserve_and_fill());
+        EXPECT_EQ(this->requests->allocations(), 1);
+    }
+    else
+        EXPECT_ALLOCATIONS_EQ(1, reserve_and_fill());
+
+    ASSERT_EQ(this->collection->size(), 50);
+}
 
-}
\ No newline at end of file
+// clear destroys the elements but keeps the storage for reuse
+TYPED_TEST(CollectionTest, ClearDoesNotFreeCapacity)
+{
+    this->add_entries(15);
+    const auto initialCapacity = this->collection->capacity();
+
+    EXPECT_NO_DEALLOCATIONS(this->collection->clear());
+
+    ASSERT_TRUE(this->collection->empty());
+    ASSERT_EQ(this->collection->capacity(), initialCapacity);
+
+    // refilling up to the old capacity must not allocate again
+    EXPECT_NO_ALLOCATIONS(this->add_entries(static_cast<int>(initialCapacity)));
+}
+
+// with a reserve up front, add_entries costs one allocator request however many entries it adds
+TYPED_TEST(CollectionTest, AddEntriesWithReserveAllocatesConstant)
+{
+    for (auto count : { 1, 10, 1000, 100000 })
+    {
+        this->new_collection();
+
+        const auto reserve_and_add = [this, count] {
+            this->collection->reserve(count);
+            this->add_entries(count);
+        };
+
+        if constexpr (TypeParam::uses_memory_resource)
+        {
+            EXPECT_ALLOCATIONS_LE(TypeParam::max_heap_allocations_per_request, reserve_and_add());
+            EXPECT_EQ(this->requests->allocations(), 1) << "reserve(" << count << ")";
+        }
+        else
+            EXPECT_ALLOCATIONS_EQ(1, reserve_and_add());
+
+        ASSERT_EQ(this->collection->size(), count);
+    }
+}
+
+// without a reserve the vector grows geometrically, so the allocations grow with log(count), not count
+TYPED_TEST(CollectionTest, PushBackWithoutReserveGrowsGeometrically)
+{
+    constexpr int count = 100000;
+#ifdef _MSC_VER
+    constexpr double growth = 1.5;
+#else
+    // libstdc++ and libc++ double the capacity
+    constexpr double growth = 2.0;
+#endif
+    // one allocation for the first element, then one each time the capacity multiplies
+    const auto bound = static_cast<std::size_t>(std::ceil(std::log(static_cast<double>(count)) / std::log(growth))) + 1;
+
+    AllocationScope scope;
+    for (auto i = 0; i < count; ++i)
+        this->collection->push_back(this->random.next_below(100));
+
+    // every outgrown buffer is handed back, even to the arena, which then ignores it
+    if constexpr (TypeParam::uses_memory_resource)
+    {
+        EXPECT_LE(this->requests->allocations(), bound);
+        EXPECT_EQ(this->requests->deallocations(), this->requests->allocations() - 1);
+    }
+    else
+    {
+        EXPECT_LE(scope.allocations(), bound);
+        EXPECT_EQ(scope.deallocations(), scope.allocations() - 1);
+    }
+}
+
+// a request malloc cannot satisfy runs the new_handler before giving up, in every form of operator new
+TEST(AllocationCounterTest, FailedRequestsCallTheNewHandler)
+{
+    static int handler_calls = 0;
+    // gives up after one call, so the next failure throws or returns nullptr
+    const auto handler = [] {
+        ++handler_calls;
+        std::set_new_handler(nullptr);
+    };
+    const std::size_t impossible = std::numeric_limits<std::size_t>::max() / 2;
+    const std::new_handler previous = std::set_new_handler(nullptr);
+
+    AllocationScope scope;
+
+    handler_calls = 0;
+    std::set_new_handler(handler);
+    EXPECT_THROW(::operator delete(::operator new(impossible)), std::bad_alloc);
+    EXPECT_EQ(handler_calls, 1);
+
+    handler_calls = 0;
+    std::set_new_handler(handler);
+    EXPECT_EQ(::operator new(impossible, std::nothrow), nullptr);
+    EXPECT_EQ(handler_calls, 1);
+
+    handler_calls = 0;
+    std::set_new_handler(handler);
+    EXPECT_THROW(::operator delete(::operator new(impossible, std::align_val_t(64)), std::align_val_t(64)), std::bad_alloc);
+    EXPECT_EQ(handler_calls, 1);
+
+    handler_calls = 0;
+    std::set_new_handler(handler);
+    EXPECT_EQ(::operator new(impossible, std::align_val_t(64), std::nothrow), nullptr);
+    EXPECT_EQ(handler_calls, 1);
+
+    // failed requests are not counted as allocations
+    EXPECT_EQ(scope.allocations(), 0u);
+    std::set_new_handler(previous);
+}
+
+// sizes that wrap around when rounded up to the alignment must fail, not return a small block
+TEST(AllocationCounterTest, AlignedRequestsNearSizeMaxFail)
+{
+    const std::new_handler previous = std::set_new_handler(nullptr);
+    const std::size_t largest = std::numeric_limits<std::size_t>::max();
+
+    for (const std::size_t size : {largest, largest - 1, largest - 62})
+    {
+        for (const std::size_t alignment : {std::size_t(64), std::size_t(4096)})
+        {
+            EXPECT_THROW(::operator delete(::operator new(size, std::align_val_t(alignment)), std::align_val_t(alignment)), std::bad_alloc) << size << " " << alignment;
+            EXPECT_EQ(::operator new(size, std::align_val_t(alignment), std::nothrow), nullptr) << size << " " << alignment;
+        }
+        EXPECT_THROW(::operator delete(::operator new(size)), std::bad_alloc) << size;
+        EXPECT_EQ(::operator new(size, std::nothrow), nullptr) << size;
+    }
+    std::set_new_handler(previous);
+}
@@ -3,47 +3,24 @@
 // Nicole Penner
 // 22EW4
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <ctime>
 #include <string>
+#include <vector>
 
-/// <summary>
-/// encrypt or decrypt a source string using the provided key
-/// </summary>
-/// <param name="source">input string to process</param>
-/// <param name="key">key to use in encryption / decryption</param>
-/// <returns>transformed string</returns>
-std::string encrypt_decrypt(const std::string& source, const std::string& key)
-{
-    // get lengths now instead of calling the function every time.
-    // this would have most likely been inlined by the compiler, but design for perfomance.
-    const auto key_length = key.length();
-    const auto source_length = source.length();
-
-    // assert that our input data is good
-    assert(key_length > 0);
-    assert(source_length > 0);
-
-    std::string output = source;
-
-    // loop through the source string char by char
-    for (size_t i = 0; i < source_length; ++i)
-    { // TODO: student need to change the next line from output[i] = source[i]
-      // transform each character based on an xor of the key modded constrained to key length using a mod
-      //Encryption of source data alogorithm xor
-        output[i] = source[i] ^ key[i % key_length];
-    }
-
-    // our output length must equal our source length
-    assert(output.length() == source_length);
-
-    // return the transformed string
-    return output;
-}
+#include "Cipher.h"
+#include "DelimiterScanner.h"
+#include "SavedDataFile.h"
+#include "XorCipher.h"
 
 std::string read_file(const std::string& filename)
 {
@@ -68,47 +45,85 @@ std::string get_student_name(const std::string& string_data)
     std::string student_name;
 
     // find the first newline
-    size_t pos = string_data.find('\n');
+    const char* newline = find_first_delimiter(string_data.data(), string_data.length(), '\n');
     // did we find a newline
-    if (pos != std::string::npos)
+    if (newline != nullptr)
     { // we did, so copy that substring as the student name
-        student_name = string_data.substr(0, pos);
+        student_name.assign(string_data.data(), newline);
     }
 
     return student_name;
 }
 
-void save_data_file(const std::string& filename, const std::string& student_name, const std::string& key, const std::string& data)
+void save_data_file(const std::string& filename, const std::string& student_name, const std::string& key, const std::string& data, const Cipher& cipher,
+                    const StreamChecksums& checksums)
 {
     //  TODO: implement file saving
     //  file format
     //  Line 1: student name
     //  Line 2: timestamp (yyyy-mm-dd)
-    //  Line 3: key used
+    //  Line 3: key used, then tab separated: cipher name, crc32c=<checksum of the data>,
+    //          source-crc32c=<checksum of what the data was made from>
     //  Line 4+: data
 
     //Coverst time to a data type that can be used
     std::time_t t = std::time(0);
     struct std::tm ltm;
+#ifdef _WIN32
     localtime_s(&ltm, &t);
+#else
+    localtime_r(&t, &ltm);
+#endif
     //Year, Month, Day
     int year = 1900 + ltm.tm_year;
     int month = 1 + ltm.tm_mon;
     int day = ltm.tm_mday;
     //Write to file
+    //Binary, so that ciphertext bytes that happen to be newlines are written as is
     std::ofstream outfile;
-    outfile.open(filename);
+    outfile.open(filename, std::ios::binary);
     outfile << student_name << std::endl;
     outfile << year << "-" << month << "-" << day << std::endl;
-    outfile << key << std::endl;
+    outfile << checksum_header_line(key, cipher, checksums) << std::endl;
     outfile << data << std::endl;
     outfile.close();
 }
 
-int main()
+int main(int argc, char** argv)
 {
     std::cout << "Encyption Decryption Test!" << std::endl;
 
+    // optional: --cipher <xor|aes-128-ctr|aes-256-ctr>, xor by default
+    // or: --verify <file>... to check saved files against the checksums in their headers
+    std::string cipher_name = "xor";
+    std::vector<std::string> verify_files;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--cipher") == 0 && i + 1 < argc)
+        {
+            cipher_name = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--verify") == 0 && i + 1 < argc)
+        {
+            verify_files.push_back(argv[++i]);
+        }
+        else
+        {
+            std::cerr << "usage: encryption [--cipher <xor|aes-128-ctr|aes-256-ctr>] | --verify <file> [--verify <file>...]" << std::endl;
+            return 2;
+        }
+    }
+
+    if (!verify_files.empty())
+    {
+        int result = 0;
+        for (const auto& file : verify_files)
+        {
+            result = std::max(result, verify_data_file(file));
+        }
+        return result;
+    }
+
     // input file format
     // Line 1: <students name>
     // Line 2: <Lorem Ipsum Generator website used> https://pirateipsum.me/ (could be https://www.lipsum.com/ or one of https://www.shopify.com/partners/blog/79940998-15-funny-lorem-ipsum-generators-to-shake-up-your-design-mockups)
@@ -123,23 +138,44 @@ int main()
     const std::string source_string = read_file(file_name);
     const std::string key = "password";
 
+    std::unique_ptr<Cipher> cipher;
+    try
+    {
+        cipher = make_cipher(cipher_name, key);
+    }
+    catch (const std::invalid_argument& error)
+    {
+        std::cerr << error.what() << std::endl;
+        return 2;
+    }
+
     // get the student name from the data file
     const std::string student_name = get_student_name(source_string);
 
-    // encrypt sourceString with key
-    const std::string encrypted_string = encrypt_decrypt(source_string, key);
+    // encrypt sourceString with key, checksumming both sides in the same pass
+    StreamChecksums encrypted_checksums;
+    const std::string encrypted_string = encrypt_decrypt(source_string, *cipher, encrypted_checksums);
 
     // save encrypted_string to file
-    save_data_file(encrypted_file_name, student_name, key, encrypted_string);
+    save_data_file(encrypted_file_name, student_name, key, encrypted_string, *cipher, encrypted_checksums);
 
     // decrypt encryptedString with key
-    const std::string decrypted_string = encrypt_decrypt(encrypted_string, key);
+    StreamChecksums decrypted_checksums;
+    const std::string decrypted_string = encrypt_decrypt(encrypted_string, *cipher, decrypted_checksums);
 
     // save decrypted_string to file
-    save_data_file(decrypted_file_name, student_name, key, decrypted_string);
+    save_data_file(decrypted_file_name, student_name, key, decrypted_string, *cipher, decrypted_checksums);
 
     std::cout << "Read File: " << file_name << " - Encrypted To: " << encrypted_file_name << " - Decrypted To: " << decrypted_file_name << std::endl;
 
+    // the decrypted text must checksum the same as the text we started from
+    if (decrypted_checksums.output != encrypted_checksums.source)
+    {
+        std::cout << "Round trip FAILED: decrypted text does not match the source" << std::endl;
+        return 1;
+    }
+    std::cout << "Round trip verified, crc32c " << std::hex << std::setfill('0') << std::setw(8) << encrypted_checksums.source << std::dec << std::endl;
+
     // students submit input file, encrypted file, decrypted file, source code file, and key used
 }
 
@@ -0,0 +1,153 @@
+// 5-3 Static Testing Diff.cpp : Compare a cppcheck report with a snapshot of an earlier run.
+//
+// Usage:
+//   static_testing_diff snapshot <report.xml> <snapshot>
+//       store the findings of a report as a snapshot
+//   static_testing_diff diff <snapshot> <report.xml> [--unchanged] [--update]
+//       list findings that are new (+) or fixed (-) since the snapshot, and with --unchanged the ones
+//       that are still there (=); --update replaces the snapshot with the new report afterwards
+//
+// Findings are matched by fingerprint, so one that only moved to another line is unchanged. diff exits
+// with 1 when there are new findings, so it can gate a commit.
+
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "CppcheckReport.h"
+#include "CppcheckSnapshot.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double milliseconds_since(Clock::time_point started)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+    }
+
+    void print_current(char marker, const CppcheckIndex& index, std::uint32_t finding_number)
+    {
+        const CppcheckFinding& finding = index[finding_number];
+        const auto locations = index.locations(finding);
+        std::cout << marker << ' ' << index.text(locations.empty() ? finding.file0 : locations.begin()->file) << ":" << (locations.empty() ? 0 : locations.begin()->line)
+                  << ": " << index.text(finding.severity) << ": " << index.text(finding.msg) << " [" << index.text(finding.id) << "]" << std::endl;
+    }
+
+    void print_fixed(const CppcheckSnapshot& snapshot, std::uint32_t record_number)
+    {
+        const SnapshotRecord& record = snapshot[record_number];
+        std::cout << "- " << snapshot.text(record.file) << ":" << record.line << ": " << snapshot.text(record.severity) << ": " << snapshot.text(record.msg)
+                  << " [" << snapshot.text(record.id) << "]" << std::endl;
+    }
+
+    void usage()
+    {
+        std::cerr << "usage: static_testing_diff snapshot <report.xml> <snapshot>" << std::endl
+                  << "       static_testing_diff diff <snapshot> <report.xml> [--unchanged] [--update]" << std::endl;
+    }
+
+    int take_snapshot(const std::string& report, const std::string& snapshot_file)
+    {
+        const auto started = Clock::now();
+        const CppcheckIndex index = CppcheckIndex::load(report);
+        write_cppcheck_snapshot(snapshot_file, index);
+        std::cout << "Stored " << index.size() << " finding(s) in " << snapshot_file << " in " << milliseconds_since(started) << " ms" << std::endl;
+        return 0;
+    }
+
+    int diff(const std::string& snapshot_file, const std::string& report, bool show_unchanged, bool update)
+    {
+        const auto started = Clock::now();
+        const CppcheckIndex index = CppcheckIndex::load(report);
+        const double parse_time = milliseconds_since(started);
+
+        const auto diff_started = Clock::now();
+        CppcheckDiff changes;
+        std::size_t baseline = 0;
+        {
+            // the mapping has to be gone before --update replaces the file, which Windows refuses while it is mapped
+            const CppcheckSnapshot snapshot = CppcheckSnapshot::open(snapshot_file);
+            baseline = snapshot.size();
+            changes = diff_cppcheck_snapshot(snapshot, fingerprint_report(index));
+            const double diff_time = milliseconds_since(diff_started);
+
+            for (const auto finding : changes.added)
+            {
+                print_current('+', index, finding);
+            }
+            for (const auto record : changes.fixed)
+            {
+                print_fixed(snapshot, record);
+            }
+            if (show_unchanged)
+            {
+                for (const auto& pair : changes.unchanged)
+                {
+                    print_current('=', index, pair.second);
+                }
+            }
+
+            std::cout << changes.added.size() << " new, " << changes.fixed.size() << " fixed, " << changes.unchanged.size() << " unchanged against a baseline of "
+                      << baseline << " (report parsed in " << parse_time << " ms, diffed in " << diff_time << " ms)" << std::endl;
+        }
+
+        if (update)
+        {
+            write_cppcheck_snapshot(snapshot_file, index);
+            std::cout << "Updated " << snapshot_file << std::endl;
+        }
+        return changes.added.empty() ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        usage();
+        return 2;
+    }
+
+    const std::string command = argv[1];
+    bool show_unchanged = false;
+    bool update = false;
+    for (int i = 4; i < argc; ++i)
+    {
+        const std::string option = argv[i];
+        if (option == "--unchanged")
+        {
+            show_unchanged = true;
+        }
+        else if (option == "--update")
+        {
+            update = true;
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    try
+    {
+        if (command == "snapshot" && argc == 4)
+        {
+            return take_snapshot(argv[2], argv[3]);
+        }
+        if (command == "diff")
+        {
+            return diff(argv[2], argv[3], show_unchanged, update);
+        }
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return 2;
+    }
+
+    usage();
+    return 2;
+}
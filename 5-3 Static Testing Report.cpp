@@ -0,0 +1,166 @@
+// 5-3 Static Testing Report.cpp : Summarize and query cppcheck XML results without loading them into a DOM.
+//
+// Usage: static_testing_report [--id=ID] [--severity=SEVERITY] [--cwe=N] [--file=FILE [--line=N]] [report.xml]
+//
+// With no query the report is summarized by severity, check id and CWE. With one or more queries every
+// finding matching all of them is listed. The report defaults to 5-3 Static Testing.xml.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CppcheckReport.h"
+
+namespace
+{
+    bool take_option(const std::string& argument, const char* name, std::string& value)
+    {
+        const std::string prefix = std::string("--") + name + "=";
+        if (argument.compare(0, prefix.size(), prefix) != 0)
+        {
+            return false;
+        }
+        value = argument.substr(prefix.size());
+        return true;
+    }
+
+    // print counts largest first
+    template <typename Key>
+    void print_counts(const char* title, std::vector<std::pair<Key, std::size_t>> counts)
+    {
+        std::sort(counts.begin(), counts.end(), [](const auto& left, const auto& right) {
+            return left.second != right.second ? left.second > right.second : left.first < right.first;
+        });
+
+        std::cout << std::endl << title << ":" << std::endl;
+        for (const auto& count : counts)
+        {
+            std::cout << "  " << count.second << "\t" << count.first << std::endl;
+        }
+    }
+
+    void print_finding(const CppcheckIndex& index, std::uint32_t finding_number)
+    {
+        const CppcheckFinding& finding = index[finding_number];
+        const auto locations = index.locations(finding);
+
+        if (!locations.empty())
+        {
+            std::cout << index.text(locations.begin()->file) << ":" << locations.begin()->line << ": ";
+        }
+        std::cout << index.text(finding.severity) << ": " << index.text(finding.msg) << " [" << index.text(finding.id);
+        if (finding.cwe != 0)
+        {
+            std::cout << ", CWE-" << finding.cwe;
+        }
+        std::cout << "]" << (finding.inconclusive ? " (inconclusive)" : "") << std::endl;
+
+        // the rest of the trace, skipping the primary location printed above
+        for (auto location = locations.begin() + (locations.empty() ? 0 : 1); location != locations.end(); ++location)
+        {
+            std::cout << "    " << index.text(location->file) << ":" << location->line;
+            if (location->info != 0)
+            {
+                std::cout << ": " << index.text(location->info);
+            }
+            std::cout << std::endl;
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string report = "5-3 Static Testing.xml";
+    std::string id;
+    std::string severity;
+    std::string cwe;
+    std::string file;
+    std::string line;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (!take_option(argument, "id", id) && !take_option(argument, "severity", severity) && !take_option(argument, "cwe", cwe)
+            && !take_option(argument, "file", file) && !take_option(argument, "line", line))
+        {
+            if (argument.compare(0, 2, "--") == 0)
+            {
+                std::cerr << "usage: static_testing_report [--id=ID] [--severity=SEVERITY] [--cwe=N] [--file=FILE [--line=N]] [report.xml]" << std::endl;
+                return 2;
+            }
+            report = argument;
+        }
+    }
+
+    CppcheckIndex index;
+    const auto started = std::chrono::steady_clock::now();
+    try
+    {
+        index = CppcheckIndex::load(report);
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+    const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started);
+
+    if (id.empty() && severity.empty() && cwe.empty() && file.empty())
+    {
+        std::cout << report << ": " << index.size() << " finding(s) from cppcheck " << index.cppcheck_version() << ", indexed in " << elapsed.count()
+                  << " ms (" << index.strings().size() << " distinct strings, " << index.strings().bytes() << " bytes)" << std::endl;
+
+        std::vector<std::pair<std::string_view, std::size_t>> severities;
+        index.for_each_severity([&](std::string_view key, const std::vector<std::uint32_t>& findings) { severities.emplace_back(key, findings.size()); });
+        print_counts("By severity", std::move(severities));
+
+        std::vector<std::pair<std::string_view, std::size_t>> ids;
+        index.for_each_id([&](std::string_view key, const std::vector<std::uint32_t>& findings) { ids.emplace_back(key, findings.size()); });
+        print_counts("By check", std::move(ids));
+
+        std::vector<std::pair<std::string, std::size_t>> cwes;
+        index.for_each_cwe([&](std::uint32_t key, const std::vector<std::uint32_t>& findings) { cwes.emplace_back("CWE-" + std::to_string(key), findings.size()); });
+        print_counts("By CWE", std::move(cwes));
+        return 0;
+    }
+
+    // start from the narrowest index the query allows, then check the remaining conditions
+    std::vector<std::uint32_t> candidates;
+    if (!file.empty())
+    {
+        candidates = line.empty() ? index.in_file(file) : index.at(file, static_cast<std::uint32_t>(std::strtoul(line.c_str(), nullptr, 10)));
+    }
+    else if (!id.empty())
+    {
+        candidates = index.with_id(id);
+    }
+    else if (!cwe.empty())
+    {
+        candidates = index.with_cwe(static_cast<std::uint32_t>(std::strtoul(cwe.c_str(), nullptr, 10)));
+    }
+    else
+    {
+        candidates = index.with_severity(severity);
+    }
+
+    std::size_t matches = 0;
+    for (const auto finding_number : candidates)
+    {
+        const CppcheckFinding& finding = index[finding_number];
+        if ((!id.empty() && index.text(finding.id) != id) || (!severity.empty() && index.text(finding.severity) != severity)
+            || (!cwe.empty() && std::to_string(finding.cwe) != cwe))
+        {
+            continue;
+        }
+        print_finding(index, finding_number);
+        ++matches;
+    }
+
+    std::cout << matches << " finding(s)" << std::endl;
+    return 0;
+}
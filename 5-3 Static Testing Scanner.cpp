@@ -0,0 +1,173 @@
+// 5-3 Static Testing Scanner.cpp : Run the StaticChecks.h checks over source trees and write a cppcheck XML report.
+//
+// Usage:
+//   static_testing_scan [--threads <n>] [--output <report.xml>] [<file or directory>...]
+//
+// Directories are searched recursively for C++ sources and headers, skipping hidden directories and
+// CMake build trees; with no paths the current directory is scanned. The report goes to stdout unless
+// --output is given, and a summary goes to stderr. Together with static_testing_diff it makes a
+// pre-commit gate that only fails on findings the snapshot has not seen:
+//   static_testing_scan --output scan.xml . && static_testing_diff diff scan.snap scan.xml
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "StaticChecks.h"
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    bool is_cpp_file(const fs::path& path)
+    {
+        const std::string extension = path.extension().string();
+        return extension == ".cpp" || extension == ".cc" || extension == ".cxx" || extension == ".h" || extension == ".hpp" || extension == ".hh";
+    }
+
+    // hidden directories and build trees hold generated or third party code
+    bool skip_directory(const fs::path& directory)
+    {
+        const std::string name = directory.filename().string();
+        std::error_code error;
+        return (name.size() > 1 && name[0] == '.') || fs::exists(directory / "CMakeCache.txt", error);
+    }
+
+    void collect_files(const fs::path& root, std::vector<std::string>& files)
+    {
+        std::error_code error;
+        if (!fs::is_directory(root, error))
+        {
+            files.push_back(root.string());
+            return;
+        }
+
+        for (auto entry = fs::recursive_directory_iterator(root, fs::directory_options::skip_permission_denied, error); entry != fs::recursive_directory_iterator();
+             entry.increment(error))
+        {
+            if (error)
+            {
+                break;
+            }
+            if (entry->is_directory(error))
+            {
+                if (skip_directory(entry->path()))
+                {
+                    entry.disable_recursion_pending();
+                }
+            }
+            else if (is_cpp_file(entry->path()))
+            {
+                files.push_back(entry->path().lexically_normal().string());
+            }
+        }
+    }
+
+    // a whole positive number of threads, false for anything else, including values out of range
+    bool parse_thread_count(const char* text, unsigned& threads)
+    {
+        char* end = nullptr;
+        errno = 0;
+        const long value = std::strtol(text, &end, 10);
+        if (end == text || *end != '\0' || errno == ERANGE || value < 1 || static_cast<unsigned long>(value) > std::numeric_limits<unsigned>::max())
+        {
+            return false;
+        }
+        threads = static_cast<unsigned>(value);
+        return true;
+    }
+
+    void usage()
+    {
+        std::cerr << "usage: static_testing_scan [--threads <n>] [--output <report.xml>] [<file or directory>...]" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned threads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::string output;
+    std::vector<std::string> roots;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--threads" && i + 1 < argc)
+        {
+            if (!parse_thread_count(argv[++i], threads))
+            {
+                usage();
+                return 2;
+            }
+        }
+        else if (argument == "--output" && i + 1 < argc)
+        {
+            output = argv[++i];
+        }
+        else if (argument.rfind("--", 0) == 0)
+        {
+            usage();
+            return 2;
+        }
+        else
+        {
+            roots.push_back(argument);
+        }
+    }
+    if (roots.empty())
+    {
+        roots.push_back(".");
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    std::vector<std::string> files;
+    for (const auto& root : roots)
+    {
+        collect_files(root, files);
+    }
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+
+    const std::vector<StaticScanFile> results = scan_cpp_files(files, threads);
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - started;
+
+    if (output.empty())
+    {
+        write_cppcheck_xml(std::cout, results);
+    }
+    else
+    {
+        std::ofstream report(output, std::ios::binary);
+        write_cppcheck_xml(report, results);
+        if (!report)
+        {
+            std::cerr << "Unable to write " << output << std::endl;
+            return 2;
+        }
+    }
+
+    std::size_t findings = 0;
+    std::size_t bytes = 0;
+    bool failed = false;
+    for (const auto& result : results)
+    {
+        findings += result.findings.size();
+        bytes += result.bytes;
+        if (!result.error.empty())
+        {
+            std::cerr << result.error << std::endl;
+            failed = true;
+        }
+    }
+    std::cerr << "Scanned " << results.size() << " file(s), " << bytes / 1024 << " KiB, with " << threads << " thread(s) in " << elapsed.count() << " ms: "
+              << findings << " finding(s)" << std::endl;
+    return failed ? 2 : 0;
+}
@@ -0,0 +1,432 @@
+// Aes.h : AES-128/256 in CTR mode, with an AES-NI path and a portable table based fallback.
+//
+// Only the forward cipher is implemented: CTR mode encrypts a counter and XORs the result into the
+// data, so encrypting and decrypting are the same operation and the output is exactly as long as the
+// input. Counter blocks are independent, which is what lets the AES-NI path keep eight blocks in
+// flight at once and hide the latency of each aesenc behind the others.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define AES_CTR_AESNI 1
+#define AES_CTR_AESNI_TARGET __attribute__((target("aes,sse2")))
+#include <wmmintrin.h>
+#include <emmintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define AES_CTR_AESNI 1
+#define AES_CTR_AESNI_TARGET
+#include <intrin.h>
+#include <wmmintrin.h>
+#endif
+
+/// <summary>
+/// The AES implementations, best last
+/// </summary>
+enum class AesLevel
+{
+    portable,
+    aesni
+};
+
+namespace aes_detail
+{
+    constexpr std::uint8_t multiply(std::uint8_t a, std::uint8_t b)
+    {
+        std::uint8_t product = 0;
+        while (b != 0)
+        {
+            if (b & 1)
+            {
+                product ^= a;
+            }
+            a = static_cast<std::uint8_t>((a << 1) ^ ((a & 0x80) ? 0x1b : 0));
+            b >>= 1;
+        }
+        return product;
+    }
+
+    constexpr std::uint8_t rotate_left(std::uint8_t value, unsigned bits)
+    {
+        return static_cast<std::uint8_t>((value << bits) | (value >> (8 - bits)));
+    }
+
+    constexpr std::uint32_t rotate_right(std::uint32_t value, unsigned bits)
+    {
+        return bits == 0 ? value : (value >> bits) | (value << (32 - bits));
+    }
+
+    /// <summary>
+    /// The S-box and the four encryption T-tables, each T-table entry being one column of
+    /// MixColumns(SubBytes(x)), built at compile time from the field arithmetic
+    /// </summary>
+    struct Tables
+    {
+        std::uint8_t sbox[256];
+        std::uint32_t te[4][256];
+    };
+
+    constexpr Tables make_tables()
+    {
+        Tables tables{};
+        for (unsigned x = 0; x < 256; ++x)
+        {
+            // multiplicative inverse as x^254, 0 maps to 0
+            std::uint8_t inverse = 1;
+            for (int i = 0; i < 254; ++i)
+            {
+                inverse = multiply(inverse, static_cast<std::uint8_t>(x));
+            }
+            if (x == 0)
+            {
+                inverse = 0;
+            }
+            const std::uint8_t s = static_cast<std::uint8_t>(inverse ^ rotate_left(inverse, 1) ^ rotate_left(inverse, 2) ^ rotate_left(inverse, 3)
+                                                             ^ rotate_left(inverse, 4) ^ 0x63);
+            tables.sbox[x] = s;
+
+            const std::uint32_t column = (std::uint32_t(multiply(s, 2)) << 24) | (std::uint32_t(s) << 16) | (std::uint32_t(s) << 8) | multiply(s, 3);
+            for (unsigned t = 0; t < 4; ++t)
+            {
+                tables.te[t][x] = rotate_right(column, 8 * t);
+            }
+        }
+        return tables;
+    }
+
+    inline constexpr Tables tables = make_tables();
+
+    inline std::uint32_t load_big_endian(const std::uint8_t* bytes)
+    {
+        return (std::uint32_t(bytes[0]) << 24) | (std::uint32_t(bytes[1]) << 16) | (std::uint32_t(bytes[2]) << 8) | bytes[3];
+    }
+
+    inline void store_big_endian(std::uint32_t value, std::uint8_t* bytes)
+    {
+        bytes[0] = static_cast<std::uint8_t>(value >> 24);
+        bytes[1] = static_cast<std::uint8_t>(value >> 16);
+        bytes[2] = static_cast<std::uint8_t>(value >> 8);
+        bytes[3] = static_cast<std::uint8_t>(value);
+    }
+
+    inline std::uint32_t substitute_word(std::uint32_t word)
+    {
+        return (std::uint32_t(tables.sbox[word >> 24]) << 24) | (std::uint32_t(tables.sbox[(word >> 16) & 0xff]) << 16)
+             | (std::uint32_t(tables.sbox[(word >> 8) & 0xff]) << 8) | tables.sbox[word & 0xff];
+    }
+}
+
+/// <summary>
+/// An expanded AES-128 or AES-256 encryption key schedule (FIPS 197). Round keys are kept as bytes in
+/// block order, which is what both the AES-NI and the table implementations load.
+/// </summary>
+class AesKey
+{
+public:
+    static constexpr std::size_t block_size = 16;
+
+    /// <param name="key">16 bytes for AES-128 or 32 bytes for AES-256</param>
+    AesKey(const std::uint8_t* key, std::size_t key_length)
+    {
+        if (key_length != 16 && key_length != 32)
+        {
+            throw std::invalid_argument("AES keys are 16 or 32 bytes");
+        }
+
+        const std::size_t words_in_key = key_length / 4;
+        rounds_ = words_in_key == 4 ? 10 : 14;
+        const std::size_t words = 4 * (rounds_ + 1);
+
+        std::uint32_t schedule[60];
+        for (std::size_t i = 0; i < words_in_key; ++i)
+        {
+            schedule[i] = aes_detail::load_big_endian(key + 4 * i);
+        }
+        std::uint32_t round_constant = 0x01;
+        for (std::size_t i = words_in_key; i < words; ++i)
+        {
+            std::uint32_t word = schedule[i - 1];
+            if (i % words_in_key == 0)
+            {
+                word = aes_detail::substitute_word((word << 8) | (word >> 24)) ^ (round_constant << 24);
+                round_constant = aes_detail::multiply(static_cast<std::uint8_t>(round_constant), 2);
+            }
+            else if (words_in_key > 6 && i % words_in_key == 4)
+            {
+                word = aes_detail::substitute_word(word);
+            }
+            schedule[i] = schedule[i - words_in_key] ^ word;
+        }
+
+        for (std::size_t i = 0; i < words; ++i)
+        {
+            aes_detail::store_big_endian(schedule[i], round_keys_.data() + 4 * i);
+        }
+    }
+
+    std::size_t rounds() const
+    {
+        return rounds_;
+    }
+
+    const std::uint8_t* round_key(std::size_t round) const
+    {
+        return round_keys_.data() + block_size * round;
+    }
+
+private:
+    std::array<std::uint8_t, 15 * block_size> round_keys_{};
+    std::size_t rounds_;
+};
+
+namespace aes_detail
+{
+    /// <summary>
+    /// A 128-bit big-endian counter block held as two host order halves
+    /// </summary>
+    struct Counter
+    {
+        std::uint64_t high;
+        std::uint64_t low;
+
+        void advance(std::uint64_t blocks)
+        {
+            const std::uint64_t before = low;
+            low += blocks;
+            high += low < before ? 1 : 0;
+        }
+
+        void store(std::uint8_t* block) const
+        {
+            store_big_endian(static_cast<std::uint32_t>(high >> 32), block);
+            store_big_endian(static_cast<std::uint32_t>(high), block + 4);
+            store_big_endian(static_cast<std::uint32_t>(low >> 32), block + 8);
+            store_big_endian(static_cast<std::uint32_t>(low), block + 12);
+        }
+    };
+
+    inline void encrypt_block_portable(const AesKey& key, const std::uint8_t* in, std::uint8_t* out)
+    {
+        const auto& te = tables.te;
+        const std::uint8_t* round_key = key.round_key(0);
+        std::uint32_t s0 = load_big_endian(in) ^ load_big_endian(round_key);
+        std::uint32_t s1 = load_big_endian(in + 4) ^ load_big_endian(round_key + 4);
+        std::uint32_t s2 = load_big_endian(in + 8) ^ load_big_endian(round_key + 8);
+        std::uint32_t s3 = load_big_endian(in + 12) ^ load_big_endian(round_key + 12);
+
+        for (std::size_t round = 1; round < key.rounds(); ++round)
+        {
+            round_key = key.round_key(round);
+            const std::uint32_t t0 = te[0][s0 >> 24] ^ te[1][(s1 >> 16) & 0xff] ^ te[2][(s2 >> 8) & 0xff] ^ te[3][s3 & 0xff] ^ load_big_endian(round_key);
+            const std::uint32_t t1 = te[0][s1 >> 24] ^ te[1][(s2 >> 16) & 0xff] ^ te[2][(s3 >> 8) & 0xff] ^ te[3][s0 & 0xff] ^ load_big_endian(round_key + 4);
+            const std::uint32_t t2 = te[0][s2 >> 24] ^ te[1][(s3 >> 16) & 0xff] ^ te[2][(s0 >> 8) & 0xff] ^ te[3][s1 & 0xff] ^ load_big_endian(round_key + 8);
+            const std::uint32_t t3 = te[0][s3 >> 24] ^ te[1][(s0 >> 16) & 0xff] ^ te[2][(s1 >> 8) & 0xff] ^ te[3][s2 & 0xff] ^ load_big_endian(round_key + 12);
+            s0 = t0;
+            s1 = t1;
+            s2 = t2;
+            s3 = t3;
+        }
+
+        // the last round has no MixColumns
+        round_key = key.round_key(key.rounds());
+        const std::uint8_t* sbox = tables.sbox;
+        const auto last = [sbox](std::uint32_t a, std::uint32_t b, std::uint32_t c, std::uint32_t d)
+        {
+            return (std::uint32_t(sbox[a >> 24]) << 24) | (std::uint32_t(sbox[(b >> 16) & 0xff]) << 16) | (std::uint32_t(sbox[(c >> 8) & 0xff]) << 8)
+                 | sbox[d & 0xff];
+        };
+        store_big_endian(last(s0, s1, s2, s3) ^ load_big_endian(round_key), out);
+        store_big_endian(last(s1, s2, s3, s0) ^ load_big_endian(round_key + 4), out + 4);
+        store_big_endian(last(s2, s3, s0, s1) ^ load_big_endian(round_key + 8), out + 8);
+        store_big_endian(last(s3, s0, s1, s2) ^ load_big_endian(round_key + 12), out + 12);
+    }
+
+    inline void xor_bytes(const std::uint8_t* source, const std::uint8_t* keystream, std::uint8_t* output, std::size_t length)
+    {
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            output[i] = source[i] ^ keystream[i];
+        }
+    }
+
+    /// <summary>
+    /// CTR over whole blocks, counter already positioned at the first of them
+    /// </summary>
+    inline void ctr_blocks_portable(const AesKey& key, Counter& counter, const std::uint8_t* source, std::uint8_t* output, std::size_t blocks)
+    {
+        std::uint8_t counter_block[AesKey::block_size];
+        std::uint8_t keystream[AesKey::block_size];
+        for (std::size_t block = 0; block < blocks; ++block)
+        {
+            counter.store(counter_block);
+            counter.advance(1);
+            encrypt_block_portable(key, counter_block, keystream);
+            xor_bytes(source + AesKey::block_size * block, keystream, output + AesKey::block_size * block, AesKey::block_size);
+        }
+    }
+
+#ifdef AES_CTR_AESNI
+    inline std::uint64_t byte_swap(std::uint64_t value)
+    {
+#ifdef _MSC_VER
+        return _byteswap_uint64(value);
+#else
+        return __builtin_bswap64(value);
+#endif
+    }
+
+    // built in registers: storing the block bytewise and loading it back stalls on store forwarding
+    AES_CTR_AESNI_TARGET inline __m128i load_counter(Counter& counter)
+    {
+        const __m128i block = _mm_set_epi64x(static_cast<long long>(byte_swap(counter.low)), static_cast<long long>(byte_swap(counter.high)));
+        counter.advance(1);
+        return block;
+    }
+
+    AES_CTR_AESNI_TARGET inline void ctr_blocks_aesni(const AesKey& key, Counter& counter, const std::uint8_t* source, std::uint8_t* output, std::size_t blocks)
+    {
+        constexpr std::size_t lanes = 8;
+        __m128i round_keys[15];
+        for (std::size_t round = 0; round <= key.rounds(); ++round)
+        {
+            round_keys[round] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key.round_key(round)));
+        }
+        const std::size_t rounds = key.rounds();
+
+        std::size_t block = 0;
+        for (; block + lanes <= blocks; block += lanes)
+        {
+            __m128i state[lanes];
+            for (std::size_t lane = 0; lane < lanes; ++lane)
+            {
+                state[lane] = _mm_xor_si128(load_counter(counter), round_keys[0]);
+            }
+            for (std::size_t round = 1; round < rounds; ++round)
+            {
+                for (std::size_t lane = 0; lane < lanes; ++lane)
+                {
+                    state[lane] = _mm_aesenc_si128(state[lane], round_keys[round]);
+                }
+            }
+            for (std::size_t lane = 0; lane < lanes; ++lane)
+            {
+                const auto* in = reinterpret_cast<const __m128i*>(source + AesKey::block_size * (block + lane));
+                auto* out = reinterpret_cast<__m128i*>(output + AesKey::block_size * (block + lane));
+                _mm_storeu_si128(out, _mm_xor_si128(_mm_aesenclast_si128(state[lane], round_keys[rounds]), _mm_loadu_si128(in)));
+            }
+        }
+
+        for (; block < blocks; ++block)
+        {
+            __m128i state = _mm_xor_si128(load_counter(counter), round_keys[0]);
+            for (std::size_t round = 1; round < rounds; ++round)
+            {
+                state = _mm_aesenc_si128(state, round_keys[round]);
+            }
+            const auto* in = reinterpret_cast<const __m128i*>(source + AesKey::block_size * block);
+            auto* out = reinterpret_cast<__m128i*>(output + AesKey::block_size * block);
+            _mm_storeu_si128(out, _mm_xor_si128(_mm_aesenclast_si128(state, round_keys[rounds]), _mm_loadu_si128(in)));
+        }
+    }
+#endif
+
+    inline void ctr_blocks(AesLevel level, const AesKey& key, Counter& counter, const std::uint8_t* source, std::uint8_t* output, std::size_t blocks)
+    {
+#ifdef AES_CTR_AESNI
+        if (level == AesLevel::aesni)
+        {
+            ctr_blocks_aesni(key, counter, source, output, blocks);
+            return;
+        }
+#endif
+        (void)level;
+        ctr_blocks_portable(key, counter, source, output, blocks);
+    }
+}
+
+/// <summary>
+/// The best AES implementation this CPU supports, detected once per process
+/// </summary>
+inline AesLevel best_aes_level()
+{
+    static const AesLevel level = []
+    {
+#if defined(AES_CTR_AESNI) && defined(_MSC_VER)
+        int registers[4];
+        __cpuid(registers, 1);
+        if (registers[2] & (1 << 25))
+        {
+            return AesLevel::aesni;
+        }
+#elif defined(AES_CTR_AESNI)
+        if (__builtin_cpu_supports("aes"))
+        {
+            return AesLevel::aesni;
+        }
+#endif
+        return AesLevel::portable;
+    }();
+
+    return level;
+}
+
+/// <summary>
+/// Encrypt or decrypt with AES in CTR mode (NIST SP 800-38A, the whole 16 byte block is the counter)
+/// </summary>
+/// <param name="key">expanded key</param>
+/// <param name="initial_counter">counter block for the first byte of the stream</param>
+/// <param name="position">offset of source[0] in the stream, so a stream can be processed in pieces or in parallel</param>
+/// <param name="source">input bytes</param>
+/// <param name="output">output bytes, may be the same buffer as source</param>
+/// <param name="length">bytes to process</param>
+/// <param name="level">implementation to use, AES-NI falls back to portable when the CPU or compiler lacks it</param>
+inline void aes_ctr_apply(const AesKey& key, const std::array<std::uint8_t, AesKey::block_size>& initial_counter, std::uint64_t position, const std::uint8_t* source,
+                          std::uint8_t* output, std::size_t length, AesLevel level = best_aes_level())
+{
+    if (level == AesLevel::aesni && best_aes_level() != AesLevel::aesni)
+    {
+        level = AesLevel::portable;
+    }
+
+    aes_detail::Counter counter{};
+    for (std::size_t i = 0; i < 8; ++i)
+    {
+        counter.high = (counter.high << 8) | initial_counter[i];
+        counter.low = (counter.low << 8) | initial_counter[8 + i];
+    }
+    counter.advance(position / AesKey::block_size);
+
+    std::uint8_t counter_block[AesKey::block_size];
+    std::uint8_t keystream[AesKey::block_size];
+
+    // finish the block a previous piece started in
+    const std::size_t skip = static_cast<std::size_t>(position % AesKey::block_size);
+    if (skip != 0 && length > 0)
+    {
+        counter.store(counter_block);
+        counter.advance(1);
+        aes_detail::encrypt_block_portable(key, counter_block, keystream);
+        const std::size_t take = std::min(length, AesKey::block_size - skip);
+        aes_detail::xor_bytes(source, keystream + skip, output, take);
+        source += take;
+        output += take;
+        length -= take;
+    }
+
+    const std::size_t blocks = length / AesKey::block_size;
+    aes_detail::ctr_blocks(level, key, counter, source, output, blocks);
+
+    const std::size_t tail = length % AesKey::block_size;
+    if (tail != 0)
+    {
+        counter.store(counter_block);
+        aes_detail::encrypt_block_portable(key, counter_block, keystream);
+        aes_detail::xor_bytes(source + AesKey::block_size * blocks, keystream, output + AesKey::block_size * blocks, tail);
+    }
+}
@@ -0,0 +1,34 @@
+// AllocationAssertions.h : gtest assertions on the number of heap allocations a statement makes.
+//
+// Example:
+//   EXPECT_ALLOCATIONS_EQ(1, {
+//       collection->reserve(50);
+//       add_entries(50);
+//   });
+//
+// The statement runs once inside an AllocationScope, so only allocations made by the current
+// thread are counted. AllocationCounter.cpp must be linked into the test program.
+
+#pragma once
+
+#include "gtest/gtest.h"
+
+#include "AllocationCounter.h"
+
+#define ALLOCATION_COUNT_CHECK_(check, expected, counter, statement)                     \
+    do                                                                                  \
+    {                                                                                   \
+        AllocationScope allocation_scope_;                                              \
+        statement;                                                                      \
+        check(allocation_scope_.counter(), static_cast<std::size_t>(expected))          \
+            << #counter " made by: " #statement;                                        \
+    } while (false)
+
+#define EXPECT_ALLOCATIONS_EQ(expected, statement) ALLOCATION_COUNT_CHECK_(EXPECT_EQ, expected, allocations, statement)
+#define EXPECT_ALLOCATIONS_LE(limit, statement) ALLOCATION_COUNT_CHECK_(EXPECT_LE, limit, allocations, statement)
+#define ASSERT_ALLOCATIONS_EQ(expected, statement) ALLOCATION_COUNT_CHECK_(ASSERT_EQ, expected, allocations, statement)
+#define ASSERT_ALLOCATIONS_LE(limit, statement) ALLOCATION_COUNT_CHECK_(ASSERT_LE, limit, allocations, statement)
+#define EXPECT_NO_ALLOCATIONS(statement) ALLOCATION_COUNT_CHECK_(EXPECT_EQ, 0, allocations, statement)
+
+#define EXPECT_DEALLOCATIONS_EQ(expected, statement) ALLOCATION_COUNT_CHECK_(EXPECT_EQ, expected, deallocations, statement)
+#define EXPECT_NO_DEALLOCATIONS(statement) ALLOCATION_COUNT_CHECK_(EXPECT_EQ, 0, deallocations, statement)
@@ -0,0 +1,235 @@
+// AllocationCounter.cpp : Global operator new / delete replacements that feed AllocationCounter.h.
+//
+
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <new>
+
+namespace allocation_counter_detail
+{
+    thread_local AllocationCounts thread_counts;
+    thread_local int tracking_depth = 0;
+
+    void count_allocation(std::size_t size) noexcept
+    {
+        if (tracking_depth > 0)
+        {
+            ++thread_counts.allocations;
+            thread_counts.bytes += size;
+        }
+    }
+
+    void* malloc_block(std::size_t size) noexcept
+    {
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void* malloc_aligned_block(std::size_t size, std::size_t alignment) noexcept
+    {
+        // rounding a size this large up to the alignment would wrap around to a tiny block
+        if (size > std::numeric_limits<std::size_t>::max() - (alignment - 1))
+        {
+            return nullptr;
+        }
+#ifdef _WIN32
+        return _aligned_malloc(size == 0 ? 1 : size, alignment);
+#else
+        // aligned_alloc wants the size to be a multiple of the alignment
+        const std::size_t rounded = (size + alignment - 1) / alignment * alignment;
+        return std::aligned_alloc(alignment, rounded == 0 ? alignment : rounded);
+#endif
+    }
+
+    // the loop the standard gives operator new: after each failure call the installed new_handler,
+    // which may free memory, and try again; with no handler installed, throw bad_alloc
+    template <typename Allocate>
+    void* allocate_or_throw(std::size_t size, Allocate allocate)
+    {
+        for (;;)
+        {
+            void* pointer = allocate();
+            if (pointer != nullptr)
+            {
+                count_allocation(size);
+                return pointer;
+            }
+
+            const std::new_handler handler = std::get_new_handler();
+            if (handler == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            handler();
+        }
+    }
+
+    void* allocate(std::size_t size)
+    {
+        return allocate_or_throw(size, [size] { return malloc_block(size); });
+    }
+
+    void* allocate_aligned(std::size_t size, std::size_t alignment)
+    {
+        return allocate_or_throw(size, [size, alignment] { return malloc_aligned_block(size, alignment); });
+    }
+
+    // the nothrow forms run the same new_handler loop and turn its bad_alloc into nullptr
+    void* allocate_nothrow(std::size_t size) noexcept
+    {
+        try
+        {
+            return allocate(size);
+        }
+        catch (const std::bad_alloc&)
+        {
+            return nullptr;
+        }
+    }
+
+    void* allocate_aligned_nothrow(std::size_t size, std::size_t alignment) noexcept
+    {
+        try
+        {
+            return allocate_aligned(size, alignment);
+        }
+        catch (const std::bad_alloc&)
+        {
+            return nullptr;
+        }
+    }
+
+    void release(void* pointer) noexcept
+    {
+        if (pointer != nullptr && tracking_depth > 0)
+        {
+            ++thread_counts.deallocations;
+        }
+        std::free(pointer);
+    }
+
+    void release_aligned(void* pointer) noexcept
+    {
+        if (pointer != nullptr && tracking_depth > 0)
+        {
+            ++thread_counts.deallocations;
+        }
+#ifdef _WIN32
+        _aligned_free(pointer);
+#else
+        std::free(pointer);
+#endif
+    }
+}
+
+bool allocation_counter_installed()
+{
+    AllocationScope scope;
+    // a direct call to operator new cannot be optimized away the way a new expression can
+    ::operator delete(::operator new(1));
+    return scope.allocations() == 1 && scope.deallocations() == 1;
+}
+
+using namespace allocation_counter_detail;
+
+void* operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate_nothrow(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate_nothrow(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocate_aligned(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return allocate_aligned(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocate_aligned_nothrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocate_aligned_nothrow(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept
+{
+    release(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    release(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    release(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    release(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    release(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    release(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    release_aligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+    release_aligned(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    release_aligned(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    release_aligned(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    release_aligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    release_aligned(pointer);
+}
@@ -0,0 +1,71 @@
+// AllocationCounter.h : Counts heap allocations made by the current thread through a global operator new hook.
+//
+// The hook itself lives in AllocationCounter.cpp, which must be linked into the program. Counting is
+// off until an AllocationScope is created, so the hook costs one thread local check otherwise.
+
+#pragma once
+
+#include <cstddef>
+
+/// <summary>
+/// Running totals for one thread
+/// </summary>
+struct AllocationCounts
+{
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+    std::size_t bytes = 0;
+};
+
+namespace allocation_counter_detail
+{
+    // defined next to the operator new replacements in AllocationCounter.cpp
+    extern thread_local AllocationCounts thread_counts;
+    extern thread_local int tracking_depth;
+}
+
+/// <summary>
+/// Counts the allocations this thread makes while the scope is alive. Scopes can nest;
+/// each one reports only what happened since it was created.
+/// </summary>
+class AllocationScope
+{
+public:
+    AllocationScope() noexcept
+        : start_(allocation_counter_detail::thread_counts)
+    {
+        ++allocation_counter_detail::tracking_depth;
+    }
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+    ~AllocationScope()
+    {
+        --allocation_counter_detail::tracking_depth;
+    }
+
+    std::size_t allocations() const noexcept
+    {
+        return allocation_counter_detail::thread_counts.allocations - start_.allocations;
+    }
+
+    std::size_t deallocations() const noexcept
+    {
+        return allocation_counter_detail::thread_counts.deallocations - start_.deallocations;
+    }
+
+    std::size_t bytes() const noexcept
+    {
+        return allocation_counter_detail::thread_counts.bytes - start_.bytes;
+    }
+
+private:
+    AllocationCounts start_;
+};
+
+/// <summary>
+/// Whether the operator new hook is linked in and counting. Without it every scope would
+/// report zero and allocation assertions would pass without checking anything.
+/// </summary>
+bool allocation_counter_installed();
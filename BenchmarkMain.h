@@ -0,0 +1,94 @@
+// BenchmarkMain.h : Shared entry point helpers for the Google Benchmark programs.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+/// <summary>
+/// Pull a "--name=value" option out of argv so that Google Benchmark does not reject it.
+/// </summary>
+/// <param name="argc">argument count, updated if the option is removed</param>
+/// <param name="argv">argument vector, updated if the option is removed</param>
+/// <param name="name">option name without the leading dashes</param>
+/// <param name="default_value">value to use when the option is not present</param>
+/// <returns>the option's value</returns>
+inline std::string take_benchmark_option(int& argc, char** argv, const char* name, const std::string& default_value)
+{
+    const std::string prefix = std::string("--") + name + "=";
+    std::string value = default_value;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], prefix.c_str(), prefix.length()) == 0)
+        {
+            value = argv[i] + prefix.length();
+
+            // shift the remaining arguments down over the one we consumed
+            for (int j = i; j + 1 < argc; ++j)
+            {
+                argv[j] = argv[j + 1];
+            }
+            --argc;
+            --i;
+        }
+    }
+
+    return value;
+}
+
+/// <summary>
+/// Numeric flavour of take_benchmark_option
+/// </summary>
+inline std::size_t take_benchmark_option(int& argc, char** argv, const char* name, std::size_t default_value)
+{
+    const std::string value = take_benchmark_option(argc, argv, name, std::to_string(default_value));
+    return static_cast<std::size_t>(std::strtoull(value.c_str(), nullptr, 10));
+}
+
+/// <summary>
+/// Run every registered benchmark once the program specific options have been taken out of argv
+/// </summary>
+/// <param name="argc">argument count</param>
+/// <param name="argv">argument vector</param>
+/// <param name="default_json_out">
+/// when not empty, results are also written to this file as JSON unless --benchmark_out was given,
+/// so every run leaves a machine readable record to compare builds against
+/// </param>
+/// <returns>process exit code</returns>
+inline int run_benchmarks(int argc, char** argv, const std::string& default_json_out = std::string())
+{
+    std::vector<char*> arguments(argv, argv + argc);
+    std::string out_flag = "--benchmark_out=" + default_json_out;
+    std::string format_flag = "--benchmark_out_format=json";
+
+    const bool has_out = std::any_of(arguments.begin(), arguments.end(), [](const char* argument)
+        {
+            return std::strncmp(argument, "--benchmark_out=", 16) == 0;
+        });
+    if (!default_json_out.empty() && !has_out)
+    {
+        arguments.push_back(&out_flag[0]);
+        arguments.push_back(&format_flag[0]);
+    }
+
+    int count = static_cast<int>(arguments.size());
+    arguments.push_back(nullptr);
+
+    benchmark::Initialize(&count, arguments.data());
+    if (benchmark::ReportUnrecognizedArguments(count, arguments.data()))
+    {
+        return 1;
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
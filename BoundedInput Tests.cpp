@@ -0,0 +1,484 @@
+// BoundedInput Tests.cpp : Tests for BoundedLineReader, the delimiter scanner and FixedString.
+//
+// The reader tests go through real files with small buffers, so records regularly straddle a
+// refill and every path through next() is taken. Random inputs are checked against a plain
+// std::string split of the same text.
+
+// FixedString's guard canaries only exist without NDEBUG, so keep them in release test builds too
+#undef NDEBUG
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BoundedLineReader.h"
+#include "DelimiterScanner.h"
+#include "FixedString.h"
+#include "Random.h"
+
+namespace
+{
+    // what the reader should return: newline separated records with a trailing CR dropped and
+    // over-length ones skipped, where an empty last record after the final newline is no record
+    std::vector<std::string> expected_records(const std::string& text, std::size_t max_length, std::size_t& skipped)
+    {
+        std::vector<std::string> records;
+        skipped = 0;
+
+        std::size_t begin = 0;
+        while (begin < text.size())
+        {
+            auto end = text.find('\n', begin);
+            const bool last = end == std::string::npos;
+            if (last)
+            {
+                end = text.size();
+            }
+
+            std::string record = text.substr(begin, end - begin);
+            if (!record.empty() && record.back() == '\r')
+            {
+                record.pop_back();
+            }
+
+            if (record.size() > max_length)
+            {
+                ++skipped;
+            }
+            else if (!last || !record.empty())
+            {
+                records.push_back(std::move(record));
+            }
+            begin = end + 1;
+        }
+        return records;
+    }
+
+    std::string random_text(Xoshiro256& random, std::size_t records, std::uint32_t longest)
+    {
+        std::string text;
+        for (std::size_t i = 0; i < records; ++i)
+        {
+            text.append(random.next_below(longest + 1), static_cast<char>('a' + random.next_below(26)));
+            if (random.next_below(4) == 0)
+            {
+                text += '\r';
+            }
+            if (i + 1 < records || random.next_below(2) == 0)
+            {
+                text += '\n';
+            }
+        }
+        return text;
+    }
+
+    // the scan levels this CPU can run, scalar first
+    std::vector<ScanLevel> supported_scan_levels()
+    {
+        std::vector<ScanLevel> levels;
+        for (const ScanLevel level : {ScanLevel::scalar, ScanLevel::sse2, ScanLevel::avx2})
+        {
+            if (level <= best_scan_level())
+            {
+                levels.push_back(level);
+            }
+        }
+        return levels;
+    }
+
+    // bytes where roughly one in density is the delimiter, with the rest never equal to it
+    std::string random_delimited(Xoshiro256& random, std::size_t length, std::uint32_t density)
+    {
+        std::string text(length, '\0');
+        for (auto& c : text)
+        {
+            c = random.next_below(density) == 0 ? '\n' : static_cast<char>(random.next_below(255) + 1);
+            if (c == '\n' && random.next_below(2) == 0)
+            { // keep some bytes that differ from the delimiter in a single bit
+                c = '\n' ^ 0x80;
+            }
+        }
+        return text;
+    }
+
+    std::vector<std::size_t> delimiters_by_hand(const char* data, std::size_t length)
+    {
+        std::vector<std::size_t> positions;
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            if (data[i] == '\n')
+            {
+                positions.push_back(i);
+            }
+        }
+        return positions;
+    }
+}
+
+class BoundedLineReaderTest : public ::testing::Test
+{
+protected:
+    std::filesystem::path path;
+
+    void SetUp() override
+    {
+        const auto* test = ::testing::UnitTest::GetInstance()->current_test_info();
+        path = std::filesystem::temp_directory_path() / (std::string("bounded_line_reader_") + test->name() + ".txt");
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(path);
+    }
+
+    // write text to the test file and read every record back through a reader with the given sizes
+    std::vector<std::string> read_all(const std::string& text, std::size_t max_length, std::size_t buffer_size, std::size_t& skipped) const
+    {
+        {
+            std::ofstream file(path, std::ios::binary);
+            file << text;
+        }
+
+        auto reader = BoundedLineReader::open(path.string(), max_length, buffer_size);
+        std::vector<std::string> records;
+        std::string_view record;
+        while (reader.next(record))
+        {
+            records.emplace_back(record);
+        }
+
+        EXPECT_FALSE(reader.next(record));
+        EXPECT_EQ(reader.records_read(), records.size());
+        skipped = reader.records_skipped();
+        return records;
+    }
+};
+
+TEST_F(BoundedLineReaderTest, StripsCrlfEndings)
+{
+    std::size_t skipped = 0;
+    const auto records = read_all("alpha\r\nbeta\n\r\ngamma\r", 16, 64, skipped);
+
+    EXPECT_EQ(records, (std::vector<std::string>{"alpha", "beta", "", "gamma"}));
+    EXPECT_EQ(skipped, 0u);
+}
+
+TEST_F(BoundedLineReaderTest, OnlyTheLastCarriageReturnIsDropped)
+{
+    std::size_t skipped = 0;
+    const auto records = read_all("a\r\r\nb\rc\n", 16, 64, skipped);
+
+    EXPECT_EQ(records, (std::vector<std::string>{"a\r", "b\rc"}));
+}
+
+TEST_F(BoundedLineReaderTest, SkipsOverLengthRecords)
+{
+    std::size_t skipped = 0;
+    const auto records = read_all("12345\n123456\n1234567890123\nok\n123456", 5, 64, skipped);
+
+    EXPECT_EQ(records, (std::vector<std::string>{"12345", "ok"}));
+    EXPECT_EQ(skipped, 3u);
+}
+
+// a record that is exactly max_length with a CR still fits, one more character does not
+TEST_F(BoundedLineReaderTest, CarriageReturnDoesNotCountTowardsTheLimit)
+{
+    std::size_t skipped = 0;
+    const auto records = read_all("abcd\r\nabcde\r\nabc\r", 4, 6, skipped);
+
+    EXPECT_EQ(records, (std::vector<std::string>{"abcd", "abc"}));
+    EXPECT_EQ(skipped, 1u);
+}
+
+// the buffer only ever holds one record, so over-length ones are discarded across several refills
+TEST_F(BoundedLineReaderTest, DiscardsOverLengthRecordsAcrossRefills)
+{
+    const std::string text = "first\n" + std::string(100, 'x') + "\nsecond\n" + std::string(37, 'y') + "\r\nthird";
+
+    std::size_t skipped = 0;
+    const auto records = read_all(text, 8, 1, skipped);
+
+    EXPECT_EQ(records, (std::vector<std::string>{"first", "second", "third"}));
+    EXPECT_EQ(skipped, 2u);
+}
+
+TEST_F(BoundedLineReaderTest, EmptyInputHasNoRecords)
+{
+    std::size_t skipped = 0;
+    EXPECT_TRUE(read_all("", 8, 16, skipped).empty());
+    EXPECT_TRUE(read_all("\r", 8, 16, skipped).empty());
+    EXPECT_EQ(skipped, 0u);
+}
+
+// every buffer size from the smallest possible upwards, so each record boundary lands on a refill
+TEST_F(BoundedLineReaderTest, RecordsSplitAcrossRefillsMatchOneShotSplit)
+{
+    Xoshiro256 random = random_stream("BoundedLineReaderTest.RecordsSplitAcrossRefillsMatchOneShotSplit");
+
+    for (int round = 0; round < 20; ++round)
+    {
+        const std::string text = random_text(random, 50, 24);
+        const std::size_t max_length = 1 + random.next_below(20);
+
+        std::size_t expected_skipped = 0;
+        const auto expected = expected_records(text, max_length, expected_skipped);
+
+        for (std::size_t buffer_size = 1; buffer_size <= 64; ++buffer_size)
+        {
+            std::size_t skipped = 0;
+            EXPECT_EQ(read_all(text, max_length, buffer_size, skipped), expected) << "max_length " << max_length << ", buffer " << buffer_size;
+            EXPECT_EQ(skipped, expected_skipped) << "max_length " << max_length << ", buffer " << buffer_size;
+        }
+    }
+}
+
+TEST_F(BoundedLineReaderTest, OpenReportsMissingFiles)
+{
+    EXPECT_THROW(BoundedLineReader::open((path / "missing").string(), 8), std::runtime_error);
+}
+
+// every length up to a few 64 byte blocks, so every SSE2 and AVX2 tail length is covered, at every
+// alignment within a cache line
+TEST(DelimiterScannerTest, LevelsAgreeOnEveryTailLength)
+{
+    Xoshiro256 random = random_stream("DelimiterScannerTest.LevelsAgreeOnEveryTailLength");
+    const std::string text = random_delimited(random, 64 * 4 + 64, 8);
+
+    for (std::size_t offset = 0; offset < 64; ++offset)
+    {
+        for (std::size_t length = 0; offset + length <= text.size() && length <= 64 * 4; ++length)
+        {
+            const char* data = text.data() + offset;
+            const auto expected = delimiters_by_hand(data, length);
+
+            for (const ScanLevel level : supported_scan_levels())
+            {
+                std::vector<std::size_t> positions;
+                EXPECT_EQ(find_delimiters(data, length, '\n', positions, level), expected.size());
+                ASSERT_EQ(positions, expected) << "level " << static_cast<int>(level) << ", offset " << offset << ", length " << length;
+            }
+        }
+    }
+}
+
+TEST(DelimiterScannerTest, LevelsAgreeOnRandomBuffers)
+{
+    Xoshiro256 random = random_stream("DelimiterScannerTest.LevelsAgreeOnRandomBuffers");
+
+    for (const std::uint32_t density : {1u, 2u, 16u, 256u, 100000u})
+    {
+        for (int round = 0; round < 20; ++round)
+        {
+            const std::string text = random_delimited(random, random.next_below(20000), density);
+            const auto expected = delimiters_by_hand(text.data(), text.size());
+            const std::size_t max_length = random.next_below(64);
+
+            std::vector<LineSpan> expected_lines;
+            const std::size_t expected_tail = scan_lines(text.data(), text.size(), max_length, expected_lines, '\n', ScanLevel::scalar);
+
+            for (const ScanLevel level : supported_scan_levels())
+            {
+                std::vector<std::size_t> positions;
+                find_delimiters(text.data(), text.size(), '\n', positions, level);
+                ASSERT_EQ(positions, expected) << "level " << static_cast<int>(level) << ", density " << density;
+
+                std::vector<LineSpan> lines;
+                EXPECT_EQ(scan_lines(text.data(), text.size(), max_length, lines, '\n', level), expected_tail);
+                ASSERT_EQ(lines.size(), expected_lines.size());
+                for (std::size_t i = 0; i < lines.size(); ++i)
+                {
+                    EXPECT_EQ(lines[i].offset, expected_lines[i].offset);
+                    EXPECT_EQ(lines[i].length, expected_lines[i].length);
+                    EXPECT_EQ(lines[i].too_long, expected_lines[i].too_long);
+                }
+            }
+        }
+    }
+}
+
+// filling a small window over and over must find the same delimiters as one pass over the buffer
+TEST(DelimiterScannerTest, WindowedScanMatchesOnePass)
+{
+    Xoshiro256 random = random_stream("DelimiterScannerTest.WindowedScanMatchesOnePass");
+
+    for (const std::uint32_t density : {1u, 3u, 40u})
+    {
+        const std::string text = random_delimited(random, 5000, density);
+        const auto expected = delimiters_by_hand(text.data(), text.size());
+
+        for (const ScanLevel level : supported_scan_levels())
+        {
+            for (const std::size_t capacity : {std::size_t(1), std::size_t(7), std::size_t(64), std::size_t(512)})
+            {
+                std::vector<std::size_t> window(capacity);
+                std::vector<std::size_t> positions;
+
+                std::size_t base = 0;
+                while (base < text.size())
+                {
+                    std::size_t scanned = 0;
+                    const std::size_t count = find_delimiters(text.data() + base, text.size() - base, '\n', window.data(), capacity, scanned, level);
+                    ASSERT_GT(scanned, 0u);
+                    ASSERT_LE(count, capacity);
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        positions.push_back(base + window[i]);
+                    }
+                    base += scanned;
+                }
+
+                EXPECT_EQ(positions, expected) << "level " << static_cast<int>(level) << ", capacity " << capacity;
+            }
+        }
+    }
+}
+
+// enough short records that one chunk holds several windows of newlines
+TEST_F(BoundedLineReaderTest, ManyRecordsPerChunkSpanSeveralWindows)
+{
+    std::string text;
+    std::vector<std::string> expected;
+    for (int i = 0; i < 5000; ++i)
+    {
+        expected.push_back(std::to_string(i));
+        text += expected.back() + (i % 3 == 0 ? "\r\n" : "\n");
+    }
+
+    std::size_t skipped = 0;
+    EXPECT_EQ(read_all(text, 8, BoundedLineReader::default_buffer_size, skipped), expected);
+    EXPECT_EQ(read_all(text, 8, 1000, skipped), expected);
+}
+
+namespace
+{
+    struct ReadLine
+    {
+        std::string text;
+        bool truncated;
+
+        bool operator==(const ReadLine& other) const
+        {
+            return text == other.text && truncated == other.truncated;
+        }
+    };
+
+    std::ostream& operator<<(std::ostream& out, const ReadLine& line)
+    {
+        return out << '"' << line.text << '"' << (line.truncated ? " truncated" : "");
+    }
+
+    // every line read_line returns from input, with whether it was cut short
+    template <std::size_t N>
+    std::vector<ReadLine> read_lines(const std::string& input)
+    {
+        std::istringstream in(input);
+        std::vector<ReadLine> lines;
+        FixedString<N> line;
+        while (line.read_line(in))
+        {
+            lines.push_back(ReadLine{std::string(line.view()), line.truncated()});
+            EXPECT_TRUE(line.guards_intact());
+        }
+        return lines;
+    }
+}
+
+TEST(FixedStringTest, AssignAndAppendKeepWhatFits)
+{
+    FixedString<5> text("abc");
+    EXPECT_EQ(text.view(), "abc");
+    EXPECT_FALSE(text.truncated());
+
+    EXPECT_FALSE(text.append("defg"));
+    EXPECT_EQ(text.view(), "abcde");
+    EXPECT_TRUE(text.truncated());
+    EXPECT_FALSE(text.push_back('f'));
+
+    EXPECT_TRUE(text.assign("12345"));
+    EXPECT_FALSE(text.truncated());
+    EXPECT_EQ(std::strlen(text.c_str()), 5u);
+    EXPECT_TRUE(text.guards_intact());
+}
+
+TEST(FixedStringTest, ReadLineKeepsLinesThatFit)
+{
+    EXPECT_EQ(read_lines<4>("ab\n\nabcd\nx"), (std::vector<ReadLine>{{"ab", false}, {"", false}, {"abcd", false}, {"x", false}}));
+}
+
+// a line that fills the buffer exactly is not truncated, whether it ends in LF, CRLF or end of input
+TEST(FixedStringTest, ReadLineAtExactCapacity)
+{
+    EXPECT_EQ(read_lines<4>("abcd\nefgh"), (std::vector<ReadLine>{{"abcd", false}, {"efgh", false}}));
+    EXPECT_EQ(read_lines<4>("abcd\r\nefgh\r\n"), (std::vector<ReadLine>{{"abcd", false}, {"efgh", false}}));
+    EXPECT_EQ(read_lines<4>("abc\r\n"), (std::vector<ReadLine>{{"abc", false}}));
+}
+
+TEST(FixedStringTest, ReadLineTruncatesAndResynchronizes)
+{
+    EXPECT_EQ(read_lines<4>("abcde\nok\n" + std::string(1000, 'z') + "\r\nlast"),
+              (std::vector<ReadLine>{{"abcd", true}, {"ok", false}, {"zzzz", true}, {"last", false}}));
+
+    // a CR that is not followed by LF is part of an over-length line
+    EXPECT_EQ(read_lines<4>("abcd\rx\nnext\n"), (std::vector<ReadLine>{{"abcd", true}, {"next", false}}));
+}
+
+TEST(FixedStringTest, ReadLineClearsTheTruncationFlag)
+{
+    std::istringstream in("toolong\nfine\n");
+    FixedString<4> line;
+
+    ASSERT_TRUE(line.read_line(in));
+    EXPECT_TRUE(line.truncated());
+    ASSERT_TRUE(line.read_line(in));
+    EXPECT_FALSE(line.truncated());
+    EXPECT_EQ(line.view(), "fine");
+    EXPECT_FALSE(line.read_line(in));
+}
+
+// writing the whole capacity through data() stays inside the guards
+TEST(FixedStringTest, FullWritesLeaveTheGuardsIntact)
+{
+    FixedString<16> text;
+    std::memset(text.data(), 'q', text.capacity());
+    text.resize(text.capacity());
+
+    EXPECT_EQ(text.view(), std::string(16, 'q'));
+    EXPECT_TRUE(text.guards_intact());
+
+    FixedString<16> copy(text);
+    copy = FixedString<16>(std::string(40, 'r'));
+    EXPECT_TRUE(copy.truncated());
+    EXPECT_TRUE(copy.guards_intact());
+}
+
+// one byte past the terminator, or one before the start, is a guard byte
+TEST(FixedStringTest, GuardsCatchWritesOutsideTheBuffer)
+{
+    FixedString<8> text;
+    char* const data = text.data();
+
+    for (char* const guard : {data + text.capacity() + 1, data - 1})
+    {
+        const char saved = *guard;
+        *guard = 'x';
+        EXPECT_FALSE(text.guards_intact());
+        *guard = saved;
+        EXPECT_TRUE(text.guards_intact());
+    }
+}
+
+TEST(FixedStringDeathTest, DestructorAssertsOnAnOverwrittenGuard)
+{
+    EXPECT_DEATH(
+        {
+            FixedString<8> text;
+            text.data()[text.capacity() + 1] = 'x';
+        },
+        "guard canary");
+}
@@ -0,0 +1,313 @@
+// BoundedLineReader.h : Bounded, streaming record reader used in place of fixed size getline buffers.
+//
+
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "DelimiterScanner.h"
+
+/// <summary>
+/// Reads newline delimited records from stdin or a file through a single large buffer.
+/// Each record is handed back as a view into that buffer, so nothing is ever copied into a
+/// fixed size array. Records longer than the configured maximum are counted and skipped
+/// instead of failing the stream. Newlines are found a window at a time with the vectorized
+/// scanner, so handing out short records does not cost a memchr call apiece, and the index
+/// stays a fixed size however many records a chunk holds.
+/// </summary>
+class BoundedLineReader
+{
+public:
+    // 1 MiB keeps the number of read() calls low without blowing out the cache
+    static constexpr std::size_t default_buffer_size = std::size_t(1) << 20;
+
+    /// <summary>
+    /// Wrap an already open file descriptor. The descriptor is not closed by the reader.
+    /// </summary>
+    /// <param name="fd">file descriptor to read from</param>
+    /// <param name="max_length">longest record (excluding the newline) that will be returned</param>
+    /// <param name="buffer_size">size of the read buffer, grown to fit a max_length record if needed</param>
+    BoundedLineReader(int fd, std::size_t max_length, std::size_t buffer_size = default_buffer_size)
+        : fd_(fd),
+          owns_fd_(false),
+          max_length_(max_length),
+          capacity_(buffer_size > max_length + 1 ? buffer_size : max_length + 2),
+          buffer_(new char[capacity_])
+    {
+    }
+
+    BoundedLineReader(BoundedLineReader&& other) noexcept
+        : fd_(other.fd_),
+          owns_fd_(std::exchange(other.owns_fd_, false)),
+          max_length_(other.max_length_),
+          capacity_(other.capacity_),
+          buffer_(std::move(other.buffer_)),
+          newlines_(other.newlines_),
+          newline_count_(other.newline_count_),
+          next_newline_(other.next_newline_),
+          newline_base_(other.newline_base_),
+          scanned_(other.scanned_),
+          begin_(other.begin_),
+          end_(other.end_),
+          at_eof_(other.at_eof_),
+          discarding_(other.discarding_),
+          records_read_(other.records_read_),
+          records_skipped_(other.records_skipped_)
+    {
+    }
+
+    BoundedLineReader(const BoundedLineReader&) = delete;
+    BoundedLineReader& operator=(const BoundedLineReader&) = delete;
+    BoundedLineReader& operator=(BoundedLineReader&&) = delete;
+
+    ~BoundedLineReader()
+    {
+        if (owns_fd_)
+        {
+#ifdef _WIN32
+            _close(fd_);
+#else
+            ::close(fd_);
+#endif
+        }
+    }
+
+    /// <summary>
+    /// Create a reader over the process's standard input
+    /// </summary>
+    static BoundedLineReader from_stdin(std::size_t max_length, std::size_t buffer_size = default_buffer_size)
+    {
+        return BoundedLineReader(0, max_length, buffer_size);
+    }
+
+    /// <summary>
+    /// Open a file for reading. Throws std::runtime_error if the file cannot be opened.
+    /// </summary>
+    static BoundedLineReader open(const std::string& filename, std::size_t max_length, std::size_t buffer_size = default_buffer_size)
+    {
+#ifdef _WIN32
+        const int fd = _open(filename.c_str(), _O_RDONLY | _O_BINARY);
+#else
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+#endif
+        if (fd < 0)
+        {
+            throw std::runtime_error("Unable to open " + filename + ": " + std::strerror(errno));
+        }
+
+        BoundedLineReader reader(fd, max_length, buffer_size);
+        reader.owns_fd_ = true;
+        return reader;
+    }
+
+    /// <summary>
+    /// Fetch the next record that fits within max_length. The returned view is only valid
+    /// until the next call to next().
+    /// </summary>
+    /// <param name="record">receives the record, without its newline or trailing carriage return</param>
+    /// <returns>false once the input is exhausted</returns>
+    bool next(std::string_view& record)
+    {
+        for (;;)
+        {
+            // take the end of the current record from the newlines already found in the buffer
+            const char* start = buffer_.get() + begin_;
+
+            if (next_newline_ == newline_count_ && scanned_ < end_)
+            { // index the next window of newlines in the data not yet scanned
+                std::size_t scanned = 0;
+                newline_count_ = find_delimiters(buffer_.get() + scanned_, end_ - scanned_, '\n', newlines_.data(), newlines_.size(), scanned);
+                next_newline_ = 0;
+                newline_base_ = scanned_;
+                scanned_ += scanned;
+            }
+
+            if (next_newline_ < newline_count_)
+            {
+                const std::size_t newline = newline_base_ + newlines_[next_newline_++];
+                std::size_t length = newline - begin_;
+                begin_ = newline + 1;
+
+                if (discarding_)
+                { // this is the tail of a record we already counted as skipped
+                    discarding_ = false;
+                    continue;
+                }
+
+                if (length > 0 && start[length - 1] == '\r')
+                {
+                    --length;
+                }
+
+                if (length > max_length_)
+                {
+                    ++records_skipped_;
+                    continue;
+                }
+
+                ++records_read_;
+                record = std::string_view(start, length);
+                return true;
+            }
+
+            // everything buffered has been scanned and no newline is left in it
+            newline_count_ = next_newline_ = 0;
+
+            const std::size_t pending = end_ - begin_;
+            if (discarding_ || pending > max_length_ + 1)
+            { // the record can no longer fit, so stop buffering it and skip ahead to the next newline
+                if (!discarding_)
+                {
+                    ++records_skipped_;
+                    discarding_ = true;
+                }
+                begin_ = end_ = 0;
+            }
+            else
+            { // move the partial record to the front so the rest of the buffer can be refilled
+                if (begin_ > 0)
+                {
+                    std::memmove(buffer_.get(), start, pending);
+                    begin_ = 0;
+                    end_ = pending;
+                }
+            }
+
+            scanned_ = end_;
+            if (!fill())
+            {
+                return take_final_record(record);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Number of records returned by next() so far
+    /// </summary>
+    std::size_t records_read() const noexcept
+    {
+        return records_read_;
+    }
+
+    /// <summary>
+    /// Number of records dropped because they were longer than max_length
+    /// </summary>
+    std::size_t records_skipped() const noexcept
+    {
+        return records_skipped_;
+    }
+
+    std::size_t max_length() const noexcept
+    {
+        return max_length_;
+    }
+
+private:
+    // read more data into the free space at the end of the buffer, returns false at end of input
+    bool fill()
+    {
+        if (at_eof_)
+        {
+            return false;
+        }
+
+        for (;;)
+        {
+#ifdef _WIN32
+            const auto count = _read(fd_, buffer_.get() + end_, static_cast<unsigned int>(capacity_ - end_));
+#else
+            const auto count = ::read(fd_, buffer_.get() + end_, capacity_ - end_);
+#endif
+            if (count > 0)
+            {
+                end_ += static_cast<std::size_t>(count);
+                return true;
+            }
+            if (count == 0)
+            {
+                at_eof_ = true;
+                return false;
+            }
+            if (errno != EINTR)
+            {
+                throw std::runtime_error(std::string("Unable to read input: ") + std::strerror(errno));
+            }
+        }
+    }
+
+    // hand back whatever is left after the last newline once the input has run dry
+    bool take_final_record(std::string_view& record)
+    {
+        std::size_t length = end_ - begin_;
+        const char* start = buffer_.get() + begin_;
+        begin_ = end_;
+
+        if (discarding_)
+        {
+            discarding_ = false;
+            return false;
+        }
+
+        if (length > 0 && start[length - 1] == '\r')
+        {
+            --length;
+        }
+
+        if (length == 0)
+        {
+            return false;
+        }
+
+        if (length > max_length_)
+        {
+            ++records_skipped_;
+            return false;
+        }
+
+        ++records_read_;
+        record = std::string_view(start, length);
+        return true;
+    }
+
+    int fd_;
+    bool owns_fd_;
+    std::size_t max_length_;
+    std::size_t capacity_;
+    std::unique_ptr<char[]> buffer_;
+
+    // 1024 entries (8 KiB) make refilling the window cheap next to the records it hands out
+    static constexpr std::size_t newline_window = 1024;
+
+    // the current window of newlines, as offsets from newline_base_, and the next one to hand out;
+    // buffer_[scanned_, end_) has not been searched for newlines yet
+    std::array<std::size_t, newline_window> newlines_;
+    std::size_t newline_count_ = 0;
+    std::size_t next_newline_ = 0;
+    std::size_t newline_base_ = 0;
+    std::size_t scanned_ = 0;
+
+    // buffer_[begin_, end_) holds unconsumed input
+    std::size_t begin_ = 0;
+    std::size_t end_ = 0;
+    bool at_eof_ = false;
+    bool discarding_ = false;
+
+    std::size_t records_read_ = 0;
+    std::size_t records_skipped_ = 0;
+};
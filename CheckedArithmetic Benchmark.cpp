@@ -0,0 +1,114 @@
+// CheckedArithmetic Benchmark.cpp : Cost of the overflow and underflow checks in add_numbers and subtract_numbers.
+//
+// Every benchmark runs 1 to 64K steps for an 8-bit, a 32-bit and a 64-bit integer type and for double.
+// The increment is chosen so the last step lands on (or, for double, just short of) the type's maximum,
+// so the checks are evaluated on every step but never fire; the Throw benchmarks go one step past it.
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "BenchmarkMain.h"
+#include "CheckedArithmetic.h"
+
+namespace
+{
+    template <typename T>
+    T increment_for(unsigned long int steps)
+    {
+        const T increment = static_cast<T>(std::numeric_limits<T>::max() / static_cast<T>(steps));
+        if constexpr (std::is_floating_point<T>::value)
+        {
+            // leave room for rounding, steps * (max / steps) can come out above max
+            return increment * static_cast<T>(0.999);
+        }
+        return increment;
+    }
+
+    template <typename T>
+    void BM_AddNumbers(benchmark::State& state)
+    {
+        const auto steps = static_cast<unsigned long int>(state.range(0));
+        const T increment = increment_for<T>(steps);
+        for (auto _ : state)
+        {
+            T start = 0;
+            benchmark::DoNotOptimize(start);
+            benchmark::DoNotOptimize(add_numbers<T>(start, increment, steps));
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * steps));
+    }
+
+    template <typename T>
+    void BM_SubtractNumbers(benchmark::State& state)
+    {
+        const auto steps = static_cast<unsigned long int>(state.range(0));
+        const T decrement = increment_for<T>(steps);
+        for (auto _ : state)
+        {
+            T start = std::numeric_limits<T>::max();
+            benchmark::DoNotOptimize(start);
+            benchmark::DoNotOptimize(subtract_numbers<T>(start, decrement, steps));
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * steps));
+    }
+
+    // the unchecked loop, to show what the checks cost
+    template <typename T>
+    void BM_UncheckedAdd(benchmark::State& state)
+    {
+        const auto steps = static_cast<unsigned long int>(state.range(0));
+        const T increment = increment_for<T>(steps);
+        for (auto _ : state)
+        {
+            T result = 0;
+            benchmark::DoNotOptimize(result);
+            for (unsigned long int i = 0; i < steps; ++i)
+            {
+                result += increment;
+                benchmark::DoNotOptimize(result);
+            }
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * steps));
+    }
+
+    template <typename T>
+    void BM_AddNumbersThrow(benchmark::State& state)
+    {
+        const auto steps = static_cast<unsigned long int>(state.range(0));
+        const T increment = increment_for<T>(steps);
+        std::size_t thrown = 0;
+        for (auto _ : state)
+        {
+            try
+            {
+                benchmark::DoNotOptimize(add_numbers<T>(0, increment, steps + 1));
+            }
+            catch (const std::overflow_error&)
+            {
+                ++thrown;
+            }
+        }
+        state.counters["thrown"] = static_cast<double>(thrown);
+    }
+
+#define CHECKED_ARITHMETIC_STEPS RangeMultiplier(16)->Range(1, 1 << 16)
+
+    BENCHMARK_TEMPLATE(BM_AddNumbers, std::uint8_t)->Arg(1)->Arg(16)->Arg(255);
+    BENCHMARK_TEMPLATE(BM_AddNumbers, std::int32_t)->CHECKED_ARITHMETIC_STEPS;
+    BENCHMARK_TEMPLATE(BM_AddNumbers, std::uint64_t)->CHECKED_ARITHMETIC_STEPS;
+    BENCHMARK_TEMPLATE(BM_AddNumbers, double)->CHECKED_ARITHMETIC_STEPS;
+    BENCHMARK_TEMPLATE(BM_SubtractNumbers, std::uint8_t)->Arg(1)->Arg(16)->Arg(255);
+    BENCHMARK_TEMPLATE(BM_SubtractNumbers, std::int32_t)->CHECKED_ARITHMETIC_STEPS;
+    BENCHMARK_TEMPLATE(BM_SubtractNumbers, std::uint64_t)->CHECKED_ARITHMETIC_STEPS;
+    BENCHMARK_TEMPLATE(BM_SubtractNumbers, double)->CHECKED_ARITHMETIC_STEPS;
+    BENCHMARK_TEMPLATE(BM_UncheckedAdd, std::int32_t)->CHECKED_ARITHMETIC_STEPS;
+    BENCHMARK_TEMPLATE(BM_UncheckedAdd, double)->CHECKED_ARITHMETIC_STEPS;
+    BENCHMARK_TEMPLATE(BM_AddNumbersThrow, std::int32_t)->Arg(1)->Arg(16);
+}
+
+int main(int argc, char** argv)
+{
+    return run_benchmarks(argc, argv);
+}
@@ -0,0 +1,146 @@
+// CheckedArithmetic.h : Repeated addition and subtraction that throw instead of wrapping around.
+//
+// checked_add and checked_subtract do the work and report the outcome as a status; add_numbers and
+// subtract_numbers are the throwing interface the examples use. A step may go out of range in either
+// direction, since a negative increment or decrement moves the other way.
+
+#pragma once
+
+#include <limits>       // std::numeric_limits
+#include <stdexcept>    // std::overflow_error, std::underflow_error
+
+/// <summary>
+/// How a checked repeated addition or subtraction ended
+/// </summary>
+enum class ArithmeticStatus
+{
+    ok,
+    // a step would have gone above std::numeric_limits<T>::max()
+    overflow,
+    // a step would have gone below std::numeric_limits<T>::lowest()
+    underflow
+};
+
+/// <summary>
+/// start + (increment * steps), one step at a time, stopping before any step that would leave T's range
+/// </summary>
+/// <typeparam name="T">A type that with basic math functions</typeparam>
+/// <param name="start">The number to start with</param>
+/// <param name="increment">How much to add each step, may be negative</param>
+/// <param name="steps">The number of steps to iterate</param>
+/// <param name="result">The sum, or the last value in range if a step would have left it</param>
+/// <returns>ok, or which end of the range a step would have crossed</returns>
+template <typename T>
+ArithmeticStatus checked_add(T const& start, T const& increment, unsigned long int const& steps, T& result) noexcept
+{
+    result = start;
+
+    for (unsigned long int i = 0; i < steps; ++i)
+    {
+        // Detect if an overflow would occur if result were to be incremented, comparing against
+        // the room left before the limit so the check itself cannot overflow.
+        if (increment > 0 && result > std::numeric_limits<T>::max() - increment)
+        {
+            return ArithmeticStatus::overflow;
+        }
+        if constexpr (std::numeric_limits<T>::is_signed)
+        {
+            if (increment < 0 && result < std::numeric_limits<T>::lowest() - increment)
+            {
+                return ArithmeticStatus::underflow;
+            }
+        }
+
+        result += increment;
+    }
+
+    return ArithmeticStatus::ok;
+}
+
+/// <summary>
+/// start - (decrement * steps), one step at a time, stopping before any step that would leave T's range
+/// </summary>
+/// <typeparam name="T">A type that with basic math functions</typeparam>
+/// <param name="start">The number to start with</param>
+/// <param name="decrement">How much to subtract each step, may be negative</param>
+/// <param name="steps">The number of steps to iterate</param>
+/// <param name="result">The difference, or the last value in range if a step would have left it</param>
+/// <returns>ok, or which end of the range a step would have crossed</returns>
+template <typename T>
+ArithmeticStatus checked_subtract(T const& start, T const& decrement, unsigned long int const& steps, T& result) noexcept
+{
+    result = start;
+
+    for (unsigned long int i = 0; i < steps; ++i)
+    {
+        // Detect that an underflow is about to occur if we decrement result, again comparing
+        // against the room left so the check cannot wrap.
+        if (decrement > 0 && result < std::numeric_limits<T>::lowest() + decrement)
+        {
+            return ArithmeticStatus::underflow;
+        }
+        if constexpr (std::numeric_limits<T>::is_signed)
+        {
+            if (decrement < 0 && result > std::numeric_limits<T>::max() + decrement)
+            {
+                return ArithmeticStatus::overflow;
+            }
+        }
+
+        result -= decrement;
+    }
+
+    return ArithmeticStatus::ok;
+}
+
+namespace checked_arithmetic_detail
+{
+    template <typename T>
+    T throw_on_failure(ArithmeticStatus status, T const& result)
+    {
+        switch (status)
+        {
+        case ArithmeticStatus::overflow:
+            throw std::overflow_error("Overflow will occur");
+        case ArithmeticStatus::underflow:
+            throw std::underflow_error("Underflow will occur");
+        case ArithmeticStatus::ok:
+        default:
+            return result;
+        }
+    }
+}
+
+/// <summary>
+/// Template function to abstract away the logic of:
+///   start + (increment * steps)
+/// </summary>
+/// <typeparam name="T">A type that with basic math functions</typeparam>
+/// <param name="start">The number to start with</param>
+/// <param name="increment">How much to add each step</param>
+/// <param name="steps">The number of steps to iterate</param>
+/// <returns>start + (increment * steps); throws std::overflow_error or std::underflow_error if a step would leave T's range</returns>
+template <typename T>
+T add_numbers(T const& start, T const& increment, unsigned long int const& steps)
+{
+    T result;
+    const ArithmeticStatus status = checked_add(start, increment, steps, result);
+    return checked_arithmetic_detail::throw_on_failure(status, result);
+}
+
+/// <summary>
+/// Template function to abstract away the logic of:
+///   start - (increment * steps)
+/// </summary>
+/// <typeparam name="T">A type that with basic math functions</typeparam>
+/// <param name="start">The number to start with</param>
+/// <param name="increment">How much to subtract each step</param>
+/// <param name="steps">The number of steps to iterate</param>
+/// <returns>start - (increment * steps); throws std::underflow_error or std::overflow_error if a step would leave T's range</returns>
+template <typename T>
+T subtract_numbers(T const& start, T const& decrement, unsigned long int const& steps)
+{
+    T result;
+    const ArithmeticStatus status = checked_subtract(start, decrement, steps, result);
+    return checked_arithmetic_detail::throw_on_failure(status, result);
+}
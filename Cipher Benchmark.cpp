@@ -0,0 +1,178 @@
+// Cipher Benchmark.cpp : XOR, portable AES-CTR and AES-NI AES-CTR throughput, in memory and streamed over multi-GB inputs.
+//
+// The stream benchmarks push --stream_mb of data (4096 by default) through a 1 MiB buffer the way a
+// file would be encrypted a read at a time, so the input size is not limited by memory. Before running,
+// the AES-NI and portable paths are checked against each other on an odd-sized buffer.
+//
+// The checksum benchmarks encrypt a --checksum_mb buffer (256 by default, well past the caches) and
+// take CRC-32C of the plaintext and the ciphertext, either fused into the cipher pass or as two more
+// passes over memory afterwards.
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "BenchmarkMain.h"
+#include "Cipher.h"
+#include "Random.h"
+
+namespace
+{
+    const std::string key = "password";
+    std::uint64_t stream_bytes = 0;
+    std::size_t checksum_bytes = 0;
+
+    std::unique_ptr<Cipher> make_benchmark_cipher(int kind)
+    {
+        // the benchmarks are about throughput, so skip most of the key derivation work
+        switch (kind)
+        {
+        case 0:
+            return std::make_unique<XorKeyCipher>(key);
+        case 1:
+            return std::make_unique<AesCtrCipher>(key, 128, AesLevel::portable, 1);
+        case 2:
+            return std::make_unique<AesCtrCipher>(key, 256, AesLevel::portable, 1);
+        case 3:
+            return std::make_unique<AesCtrCipher>(key, 128, AesLevel::aesni, 1);
+        default:
+            return std::make_unique<AesCtrCipher>(key, 256, AesLevel::aesni, 1);
+        }
+    }
+
+    const char* const cipher_labels[] = {"xor", "aes-128-ctr/portable", "aes-256-ctr/portable", "aes-128-ctr/aesni", "aes-256-ctr/aesni"};
+
+    std::string make_data(std::size_t length)
+    {
+        std::string data(length, '\0');
+        Xoshiro256 random(405);
+        for (auto& c : data)
+        {
+            c = static_cast<char>(random());
+        }
+        return data;
+    }
+
+    // args: cipher kind, buffer size
+    void BM_Apply(benchmark::State& state)
+    {
+        const auto cipher = make_benchmark_cipher(static_cast<int>(state.range(0)));
+        const std::string source = make_data(static_cast<std::size_t>(state.range(1)));
+        std::string output(source.size(), '\0');
+        for (auto _ : state)
+        {
+            cipher->apply(source.data(), &output[0], source.size());
+            benchmark::DoNotOptimize(output.data());
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * source.size()));
+        state.SetLabel(cipher_labels[state.range(0)]);
+    }
+
+    // args: cipher kind; encrypts stream_bytes in place, a buffer at a time
+    void BM_Stream(benchmark::State& state)
+    {
+        const auto cipher = make_benchmark_cipher(static_cast<int>(state.range(0)));
+        std::string buffer = make_data(1 << 20);
+        for (auto _ : state)
+        {
+            for (std::uint64_t position = 0; position < stream_bytes; position += buffer.size())
+            {
+                const std::size_t length = static_cast<std::size_t>(std::min<std::uint64_t>(buffer.size(), stream_bytes - position));
+                cipher->apply(buffer.data(), &buffer[0], length, position);
+                benchmark::DoNotOptimize(buffer.data());
+            }
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * stream_bytes));
+        state.SetLabel(cipher_labels[state.range(0)]);
+    }
+
+    void BM_DeriveKey(benchmark::State& state)
+    {
+        const auto iterations = static_cast<std::uint32_t>(state.range(0));
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(pbkdf2_hmac_sha256(key, "CS-405 aes-256-ctr", iterations, 48).data());
+        }
+    }
+
+    // args: level, buffer size
+    void BM_Crc32c(benchmark::State& state)
+    {
+        const auto level = static_cast<Crc32cLevel>(state.range(0));
+        const std::string data = make_data(static_cast<std::size_t>(state.range(1)));
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(crc32c_update(0, data.data(), data.size(), level));
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * data.size()));
+        state.SetLabel(level == Crc32cLevel::sse42 ? "sse4.2" : "portable");
+    }
+
+    // args: cipher kind, fused (1) or separate passes (0)
+    void BM_Checksummed(benchmark::State& state)
+    {
+        const auto cipher = make_benchmark_cipher(static_cast<int>(state.range(0)));
+        const bool fused = state.range(1) != 0;
+        const std::string source = make_data(checksum_bytes);
+        std::string output(source.size(), '\0');
+        StreamChecksums checksums;
+        for (auto _ : state)
+        {
+            checksums = StreamChecksums();
+            if (fused)
+            {
+                cipher->apply_checksummed(source.data(), &output[0], source.size(), 0, checksums);
+            }
+            else
+            {
+                cipher->apply(source.data(), &output[0], source.size());
+                checksums.source = crc32c_update(0, source.data(), source.size());
+                checksums.output = crc32c_update(0, output.data(), output.size());
+            }
+            benchmark::DoNotOptimize(checksums);
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * source.size()));
+        state.SetLabel(std::string(cipher_labels[state.range(0)]) + (fused ? " fused" : " separate"));
+    }
+
+    bool implementations_agree()
+    {
+        const std::string source = make_data((1 << 16) + 13);
+        for (unsigned bits : {128u, 256u})
+        {
+            const AesCtrCipher portable(key, bits, AesLevel::portable, 1);
+            const AesCtrCipher aesni(key, bits, AesLevel::aesni, 1);
+            if (portable.apply(source) != aesni.apply(source))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+BENCHMARK(BM_Apply)->ArgsProduct({{0, 1, 2, 3, 4}, {4 << 10, 64 << 10, 1 << 20}});
+BENCHMARK(BM_Stream)->DenseRange(0, 4)->Iterations(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Crc32c)->ArgsProduct({{0, 1}, {4 << 10, 1 << 20}});
+BENCHMARK(BM_Checksummed)->ArgsProduct({{0, 3, 4}, {0, 1}})->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DeriveKey)->Arg(1000)->Arg(static_cast<std::int64_t>(aes_key_derivation_iterations))->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv)
+{
+    stream_bytes = static_cast<std::uint64_t>(take_benchmark_option(argc, argv, "stream_mb", std::size_t(4096))) << 20;
+    checksum_bytes = take_benchmark_option(argc, argv, "checksum_mb", std::size_t(256)) << 20;
+
+    if (best_aes_level() != AesLevel::aesni)
+    {
+        std::cerr << "AES-NI is not available, the aesni benchmarks run the portable code" << std::endl;
+    }
+    if (!implementations_agree())
+    {
+        std::cerr << "AES-NI and portable AES-CTR disagree" << std::endl;
+        return 1;
+    }
+
+    return run_benchmarks(argc, argv);
+}
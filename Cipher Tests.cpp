@@ -0,0 +1,393 @@
+// Cipher Tests.cpp : Known-answer and consistency tests for AES-CTR, PBKDF2-HMAC-SHA256, CRC-32C and saved file checks.
+//
+// The AES vectors are FIPS 197 appendix C and NIST SP 800-38A F.5, the PBKDF2 vectors RFC 7914
+// section 11. The counter wrap vectors were produced with OpenSSL's aes-128-ctr, which increments the
+// whole 128 bit block as SP 800-38A describes, and the long password vector with Python's hashlib.
+// The CRC-32C check value is the catalogue one for "123456789".
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "Cipher.h"
+#include "Random.h"
+#include "SavedDataFile.h"
+
+namespace
+{
+    using Block = std::array<std::uint8_t, AesKey::block_size>;
+
+    std::vector<std::uint8_t> from_hex(const std::string& hex)
+    {
+        std::vector<std::uint8_t> bytes;
+        for (std::size_t i = 0; i + 1 < hex.size(); i += 2)
+        {
+            bytes.push_back(static_cast<std::uint8_t>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+        }
+        return bytes;
+    }
+
+    Block block_from_hex(const std::string& hex)
+    {
+        const auto bytes = from_hex(hex);
+        Block block{};
+        std::copy(bytes.begin(), bytes.end(), block.begin());
+        return block;
+    }
+
+    std::vector<std::uint8_t> random_bytes(Xoshiro256& random, std::size_t length)
+    {
+        std::vector<std::uint8_t> bytes(length);
+        for (auto& byte : bytes)
+        {
+            byte = static_cast<std::uint8_t>(random());
+        }
+        return bytes;
+    }
+
+    std::vector<std::uint8_t> ctr(const AesKey& key, const Block& counter, const std::vector<std::uint8_t>& source, AesLevel level, std::uint64_t position = 0)
+    {
+        std::vector<std::uint8_t> output(source.size());
+        aes_ctr_apply(key, counter, position, source.data(), output.data(), source.size(), level);
+        return output;
+    }
+
+    const AesLevel levels[] = {AesLevel::portable, AesLevel::aesni};
+
+    const std::string sp800_38a_plaintext = "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+                                            "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710";
+    const std::string sp800_38a_counter = "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+}
+
+// CTR over a zero block with the plaintext as the counter is one block of ECB encryption
+TEST(AesTest, Fips197Appendix)
+{
+    const auto plaintext = block_from_hex("00112233445566778899aabbccddeeff");
+    const std::vector<std::uint8_t> zeros(AesKey::block_size);
+    const auto key128 = from_hex("000102030405060708090a0b0c0d0e0f");
+    const auto key256 = from_hex("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f");
+
+    for (const AesLevel level : levels)
+    {
+        EXPECT_EQ(ctr(AesKey(key128.data(), key128.size()), plaintext, zeros, level), from_hex("69c4e0d86a7b0430d8cdb78070b4c55a"));
+        EXPECT_EQ(ctr(AesKey(key256.data(), key256.size()), plaintext, zeros, level), from_hex("8ea2b7ca516745bfeafc49904b496089"));
+    }
+}
+
+TEST(AesTest, Sp800_38aCtrAes128)
+{
+    const auto key = from_hex("2b7e151628aed2a6abf7158809cf4f3c");
+    const auto expected = from_hex("874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+                                   "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee");
+    for (const AesLevel level : levels)
+    {
+        const AesKey aes(key.data(), key.size());
+        EXPECT_EQ(ctr(aes, block_from_hex(sp800_38a_counter), from_hex(sp800_38a_plaintext), level), expected);
+        // CTR is its own inverse
+        EXPECT_EQ(ctr(aes, block_from_hex(sp800_38a_counter), expected, level), from_hex(sp800_38a_plaintext));
+    }
+}
+
+TEST(AesTest, Sp800_38aCtrAes256)
+{
+    const auto key = from_hex("603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4");
+    const auto expected = from_hex("601ec313775789a5b7a7f504bbf3d228f443e3ca4d62b59aca84e990cacaf5c5"
+                                   "2b0930daa23de94ce87017ba2d84988ddfc9c58db67aada613c2dd08457941a6");
+    for (const AesLevel level : levels)
+    {
+        EXPECT_EQ(ctr(AesKey(key.data(), key.size()), block_from_hex(sp800_38a_counter), from_hex(sp800_38a_plaintext), level), expected);
+    }
+}
+
+// the counter carries out of its low 64 bits, and wraps around at 2^128
+TEST(AesTest, CounterCarriesAndWraps)
+{
+    const auto key = from_hex("2b7e151628aed2a6abf7158809cf4f3c");
+    const std::vector<std::uint8_t> zeros(3 * AesKey::block_size);
+    for (const AesLevel level : levels)
+    {
+        const AesKey aes(key.data(), key.size());
+        EXPECT_EQ(ctr(aes, block_from_hex("0000000000000000ffffffffffffffff"), zeros, level),
+                  from_hex("ef8737b783c4fa88e687ee9467073f6edc0a3bc38609c26f6f2a63a39cf7ee93c5eb9614bd235873ff3771254315047c"));
+        EXPECT_EQ(ctr(aes, block_from_hex("ffffffffffffffffffffffffffffffff"), zeros, level),
+                  from_hex("8af2860142f786f409307c1a3f7eaaac7df76b0c1ab899b33e42f047b91b546f57127d4034b1bebfaef466b9c7726fc6"));
+    }
+}
+
+// the AES-NI path runs eight blocks at a time, so compare long and odd lengths, and counters that
+// carry or wrap inside a batch
+TEST(AesTest, AesNiMatchesPortable)
+{
+    if (best_aes_level() != AesLevel::aesni)
+    {
+        GTEST_SKIP() << "AES-NI is not available";
+    }
+
+    Xoshiro256 random = random_stream("AesTest.AesNiMatchesPortable");
+    const std::string counters[] = {"000102030405060708090a0b0c0d0e0f", "00000000000000fffffffffffffffffa", "fffffffffffffffffffffffffffffffd"};
+    for (const std::size_t key_length : {16u, 32u})
+    {
+        const auto key_bytes = random_bytes(random, key_length);
+        const AesKey key(key_bytes.data(), key_bytes.size());
+        for (const auto& counter : counters)
+        {
+            for (const std::size_t length : {0u, 1u, 15u, 16u, 17u, 127u, 128u, 129u, 1000u, 4099u})
+            {
+                const auto source = random_bytes(random, length);
+                EXPECT_EQ(ctr(key, block_from_hex(counter), source, AesLevel::aesni), ctr(key, block_from_hex(counter), source, AesLevel::portable))
+                    << key_length * 8 << " bit key, counter " << counter << ", " << length << " bytes";
+            }
+        }
+    }
+}
+
+// a stream processed in pieces that start mid-block gives the same bytes as one call
+TEST(AesTest, PiecesAtAnyOffsetMatchOneShot)
+{
+    Xoshiro256 random = random_stream("AesTest.PiecesAtAnyOffsetMatchOneShot");
+    const auto key_bytes = random_bytes(random, 32);
+    const AesKey key(key_bytes.data(), key_bytes.size());
+    const Block counter = block_from_hex("00000000000000fffffffffffffffff0");
+    const auto source = random_bytes(random, 3000);
+
+    for (const AesLevel level : levels)
+    {
+        const auto whole = ctr(key, counter, source, level);
+        for (int trial = 0; trial < 50; ++trial)
+        {
+            std::vector<std::uint8_t> pieces(source.size());
+            for (std::size_t position = 0; position < source.size();)
+            {
+                const std::size_t length = std::min<std::size_t>(source.size() - position, 1 + random.next_below(300));
+                aes_ctr_apply(key, counter, position, source.data() + position, pieces.data() + position, length, level);
+                position += length;
+            }
+            ASSERT_EQ(pieces, whole);
+        }
+    }
+}
+
+TEST(CipherTest, ApplyTwiceGivesTheInputBack)
+{
+    Xoshiro256 random = random_stream("CipherTest.ApplyTwiceGivesTheInputBack");
+    const auto bytes = random_bytes(random, 5000);
+    const std::string source(bytes.begin(), bytes.end());
+    const XorKeyCipher xor_cipher("password");
+    const AesCtrCipher aes128("password", 128, best_aes_level(), 1);
+    const AesCtrCipher aes256("password", 256, best_aes_level(), 1);
+
+    for (const Cipher* cipher : std::initializer_list<const Cipher*>{&xor_cipher, &aes128, &aes256})
+    {
+        const std::string encrypted = cipher->apply(source);
+        EXPECT_EQ(encrypted.size(), source.size()) << cipher->name();
+        EXPECT_NE(encrypted, source) << cipher->name();
+        EXPECT_EQ(cipher->apply(encrypted), source) << cipher->name();
+    }
+}
+
+TEST(KeyDerivationTest, Sha256)
+{
+    const auto empty = Sha256::hash("", 0);
+    EXPECT_EQ(std::vector<std::uint8_t>(empty.begin(), empty.end()), from_hex("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+    const auto abc = Sha256::hash("abc", 3);
+    EXPECT_EQ(std::vector<std::uint8_t>(abc.begin(), abc.end()), from_hex("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+}
+
+TEST(KeyDerivationTest, Rfc7914Pbkdf2HmacSha256)
+{
+    EXPECT_EQ(pbkdf2_hmac_sha256("passwd", "salt", 1, 64),
+              from_hex("55ac046e56e3089fec1691c22544b605f94185216dde0465e68b9d57c20dacbc"
+                       "49ca9cccf179b645991664b39d77ef317c71b845b1e30bd509112041d3a19783"));
+    EXPECT_EQ(pbkdf2_hmac_sha256("Password", "NaCl", 80000, 64),
+              from_hex("4ddcd8f60b98be21830cee5ef22701f9641a4418d04c0414aeff08876b34ab56"
+                       "a1d425a1225833549adb841b51c9b3176a272bdebba1d078478f62b397f33c8d"));
+}
+
+// a password longer than the SHA-256 block is hashed down first; a shorter output is a prefix
+TEST(KeyDerivationTest, LongPasswordAndTruncatedOutput)
+{
+    const std::string password(100, 'p');
+    const auto full = pbkdf2_hmac_sha256(password, "salt", 2, 64);
+    EXPECT_EQ(pbkdf2_hmac_sha256(password, "salt", 2, 20), std::vector<std::uint8_t>(full.begin(), full.begin() + 20));
+    EXPECT_EQ(full, from_hex("7fb39a0c2291de62231e50ab5f6805b83bab97446d73dccf38114fb21c055427"
+                             "59977ca37b50559f49bf273aed0f0256326784bee144fe079373e38dccc10741"));
+}
+
+TEST(Crc32cTest, CheckValue)
+{
+    for (const Crc32cLevel level : {Crc32cLevel::portable, Crc32cLevel::sse42})
+    {
+        EXPECT_EQ(crc32c_update(0, "123456789", 9, level), 0xe3069283u);
+        EXPECT_EQ(crc32c_update(0, "", 0, level), 0u);
+    }
+}
+
+// every length up to a few words, at every alignment, so both the word loops and the byte tails run
+TEST(Crc32cTest, Sse42MatchesSlicingBy8)
+{
+    if (best_crc32c_level() != Crc32cLevel::sse42)
+    {
+        GTEST_SKIP() << "SSE4.2 is not available";
+    }
+
+    Xoshiro256 random = random_stream("Crc32cTest.Sse42MatchesSlicingBy8");
+    const auto data = random_bytes(random, 4096 + 64);
+    for (std::size_t offset = 0; offset < 8; ++offset)
+    {
+        for (std::size_t length = 0; length <= 64; ++length)
+        {
+            ASSERT_EQ(crc32c_update(0, data.data() + offset, length, Crc32cLevel::sse42), crc32c_update(0, data.data() + offset, length, Crc32cLevel::portable))
+                << "offset " << offset << ", length " << length;
+        }
+        EXPECT_EQ(crc32c_update(0, data.data() + offset, 4096, Crc32cLevel::sse42), crc32c_update(0, data.data() + offset, 4096, Crc32cLevel::portable));
+    }
+}
+
+TEST(Crc32cTest, SplitUpdatesMatchOneShot)
+{
+    Xoshiro256 random = random_stream("Crc32cTest.SplitUpdatesMatchOneShot");
+    const auto data = random_bytes(random, 10000);
+    for (const Crc32cLevel level : {Crc32cLevel::portable, Crc32cLevel::sse42})
+    {
+        const std::uint32_t whole = crc32c_update(0, data.data(), data.size(), level);
+        for (int trial = 0; trial < 20; ++trial)
+        {
+            std::uint32_t crc = 0;
+            for (std::size_t position = 0; position < data.size();)
+            {
+                const std::size_t length = std::min<std::size_t>(data.size() - position, random.next_below(700));
+                crc = crc32c_update(crc, data.data() + position, length, level);
+                position += length;
+            }
+            ASSERT_EQ(crc, whole);
+        }
+    }
+}
+
+// the fused pass gives the same bytes and checksums as applying the cipher and checksumming after
+TEST(Crc32cTest, ApplyChecksummedMatchesSeparatePasses)
+{
+    Xoshiro256 random = random_stream("Crc32cTest.ApplyChecksummedMatchesSeparatePasses");
+    const auto bytes = random_bytes(random, 100000);
+    const std::string source(bytes.begin(), bytes.end());
+    const XorKeyCipher xor_cipher("password");
+    const AesCtrCipher aes("password", 256, best_aes_level(), 1);
+
+    for (const Cipher* cipher : std::initializer_list<const Cipher*>{&xor_cipher, &aes})
+    {
+        StreamChecksums checksums;
+        const std::string output = cipher->apply_checksummed(source, checksums);
+        EXPECT_EQ(output, cipher->apply(source)) << cipher->name();
+        EXPECT_EQ(checksums.source, crc32c_update(0, source.data(), source.size())) << cipher->name();
+        EXPECT_EQ(checksums.output, crc32c_update(0, output.data(), output.size())) << cipher->name();
+    }
+}
+
+// saves files the way 5-2 does and checks verify_data_file accepts them and catches damage
+class SavedDataFileTest : public ::testing::Test
+{
+protected:
+    std::filesystem::path path;
+
+    void SetUp() override
+    {
+        const auto* test = ::testing::UnitTest::GetInstance()->current_test_info();
+        path = std::filesystem::temp_directory_path() / (std::string("saved_data_file_") + test->name() + ".txt");
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(path);
+    }
+
+    // encrypt source with the cipher 5-2 would make from the name and key, returning line 3 and the data
+    static std::pair<std::string, std::string> encrypt(const std::string& cipher_name, const std::string& source)
+    {
+        const auto cipher = make_cipher(cipher_name, "password");
+        StreamChecksums checksums;
+        std::string data = cipher->apply_checksummed(source, checksums);
+        return {checksum_header_line("password", *cipher, checksums), std::move(data)};
+    }
+
+    void save(const std::string& line3, const std::string& data) const
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "John Q. Smith\n2026-1-1\n" << line3 << '\n' << data << '\n';
+    }
+
+    int verify() const
+    {
+        return verify_data_file(path.string());
+    }
+
+    const std::string source = "John Q. Smith\nThis is my test string, long enough to span more than one AES block.\n";
+};
+
+TEST_F(SavedDataFileTest, AcceptsIntactFiles)
+{
+    for (const auto& name : cipher_names())
+    {
+        const auto [line3, data] = encrypt(name, source);
+        save(line3, data);
+        EXPECT_EQ(verify(), 0) << name;
+    }
+}
+
+TEST_F(SavedDataFileTest, RejectsACorruptedDataByte)
+{
+    const auto [line3, data] = encrypt("xor", source);
+    for (const std::size_t index : {std::size_t(0), data.size() / 2, data.size() - 1})
+    {
+        std::string corrupted = data;
+        corrupted[index] ^= 0x01;
+        save(line3, corrupted);
+        EXPECT_EQ(verify(), 1) << "byte " << index;
+    }
+}
+
+TEST_F(SavedDataFileTest, RejectsACorruptedHeader)
+{
+    const auto [line3, data] = encrypt("xor", source);
+
+    // a different key turns the data back into something else
+    save("passwore" + line3.substr(8), data);
+    EXPECT_EQ(verify(), 1);
+
+    // a changed checksum digit
+    std::string digit = line3;
+    const std::size_t checksum = digit.find("crc32c=") + 7;
+    digit[checksum] = digit[checksum] == '0' ? '1' : '0';
+    save(digit, data);
+    EXPECT_EQ(verify(), 1);
+
+    // checksums that are not hex, an unknown cipher and a missing field cannot be checked at all
+    std::string not_hex = line3;
+    not_hex[checksum] = 'z';
+    save(not_hex, data);
+    EXPECT_EQ(verify(), 2);
+
+    std::string unknown = line3;
+    unknown.replace(unknown.find("\txor\t") + 1, 3, "rot");
+    save(unknown, data);
+    EXPECT_EQ(verify(), 2);
+
+    save(line3.substr(0, line3.rfind('\t')), data);
+    EXPECT_EQ(verify(), 2);
+}
+
+TEST_F(SavedDataFileTest, RejectsATruncatedFile)
+{
+    const auto [line3, data] = encrypt("xor", source);
+    save(line3, data.substr(0, data.size() - 1));
+    EXPECT_EQ(verify(), 1);
+
+    std::ofstream(path, std::ios::binary) << "John Q. Smith\n";
+    EXPECT_EQ(verify(), 2);
+}
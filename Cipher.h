@@ -0,0 +1,263 @@
+// Cipher.h : The stream cipher interface the encryption example encrypts through, with XOR and AES-CTR behind it.
+//
+// Every cipher keeps encrypt_decrypt's contract: the output is exactly as long as the input and
+// applying the cipher twice gives the input back. Ciphers are also seekable, apply takes the offset
+// of the first byte in the stream, so a large file can be processed a buffer at a time.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Aes.h"
+#include "Crc32c.h"
+#include "KeyDerivation.h"
+#include "XorCipher.h"
+
+/// <summary>
+/// Running CRC-32C checksums of what went into a cipher and what came out. Both start at 0 and carry on
+/// across calls, so a stream processed a buffer at a time ends with the checksums of the whole stream.
+/// </summary>
+struct StreamChecksums
+{
+    std::uint32_t source = 0;
+    std::uint32_t output = 0;
+};
+
+/// <summary>
+/// A symmetric stream cipher keyed from the example's string key
+/// </summary>
+class Cipher
+{
+public:
+    virtual ~Cipher() = default;
+
+    /// <summary>
+    /// Name used on the command line and in the saved file header
+    /// </summary>
+    virtual const char* name() const = 0;
+
+    /// <summary>
+    /// Encrypt or decrypt length bytes
+    /// </summary>
+    /// <param name="source">input bytes</param>
+    /// <param name="output">output bytes, may be the same buffer as source</param>
+    /// <param name="length">bytes to process</param>
+    /// <param name="position">offset of source[0] in the stream</param>
+    virtual void apply(const char* source, char* output, std::size_t length, std::uint64_t position = 0) const = 0;
+
+    std::string apply(const std::string& source) const
+    {
+        std::string output(source.size(), '\0');
+        apply(source.data(), &output[0], source.size());
+        return output;
+    }
+
+    /// <summary>
+    /// apply, checksumming the input and the output in the same pass. The data goes through in pieces
+    /// small enough to stay in the L1 cache, so each byte is read from memory once and written once,
+    /// rather than once more for every checksum taken afterwards.
+    /// </summary>
+    /// <param name="checksums">updated with the source and output bytes</param>
+    void apply_checksummed(const char* source, char* output, std::size_t length, std::uint64_t position, StreamChecksums& checksums) const
+    {
+        constexpr std::size_t piece = 16 << 10;
+        for (std::size_t offset = 0; offset < length; offset += piece)
+        {
+            const std::size_t take = std::min(piece, length - offset);
+            // the source checksum goes first, output may be the same buffer
+            checksums.source = crc32c_update(checksums.source, source + offset, take);
+            apply(source + offset, output + offset, take, position + offset);
+            checksums.output = crc32c_update(checksums.output, output + offset, take);
+        }
+    }
+
+    std::string apply_checksummed(const std::string& source, StreamChecksums& checksums) const
+    {
+        std::string output(source.size(), '\0');
+        apply_checksummed(source.data(), &output[0], source.size(), 0, checksums);
+        return output;
+    }
+};
+
+/// <summary>
+/// The repeating-key XOR of encrypt_decrypt. Fast, but the key is recoverable from any known plaintext.
+/// </summary>
+class XorKeyCipher : public Cipher
+{
+public:
+    using Cipher::apply;
+
+    explicit XorKeyCipher(const std::string& key) : key_length_(key.length())
+    {
+        if (key.empty())
+        {
+            throw std::invalid_argument("XOR key must not be empty");
+        }
+
+        // the key repeated to a few hundred bytes, so the inner loop is a plain XOR of two spans the
+        // compiler can vectorize rather than a byte loop wrapping around a short key
+        while (pattern_.length() < 256)
+        {
+            pattern_ += key;
+        }
+    }
+
+    const char* name() const override
+    {
+        return "xor";
+    }
+
+    void apply(const char* source, char* output, std::size_t length, std::uint64_t position = 0) const override
+    {
+        std::size_t k = static_cast<std::size_t>(position % key_length_);
+        while (length > 0)
+        {
+            const std::size_t take = std::min(length, pattern_.length() - k);
+            const char* key = pattern_.data() + k;
+            for (std::size_t i = 0; i < take; ++i)
+            {
+                output[i] = source[i] ^ key[i];
+            }
+            source += take;
+            output += take;
+            length -= take;
+            k = (k + take) % key_length_;
+        }
+    }
+
+private:
+    std::size_t key_length_;
+    std::string pattern_;
+};
+
+/// <summary>
+/// PBKDF2 work factor for the AES keys, about a tenth of a second per cipher on a desktop CPU
+/// </summary>
+constexpr std::uint32_t aes_key_derivation_iterations = 100000;
+
+/// <summary>
+/// AES-128-CTR or AES-256-CTR. The AES key and the initial counter block both come from PBKDF2 over the
+/// string key with a salt naming the cipher.
+///
+/// The output has to be as long as the input, so there is nowhere to store a per-message nonce: two
+/// messages encrypted with the same string key share a keystream, and XORing their ciphertexts gives the
+/// XOR of the plaintexts. Use a different key per file when that matters.
+/// </summary>
+class AesCtrCipher : public Cipher
+{
+public:
+    using Cipher::apply;
+
+    /// <param name="key">string key to derive from</param>
+    /// <param name="key_bits">128 or 256</param>
+    /// <param name="level">AES implementation, the best the CPU supports by default</param>
+    /// <param name="iterations">PBKDF2 iterations</param>
+    AesCtrCipher(const std::string& key, unsigned key_bits, AesLevel level = best_aes_level(), std::uint32_t iterations = aes_key_derivation_iterations)
+        : AesCtrCipher(derive(key, key_bits, iterations), key_bits, level)
+    {
+    }
+
+    const char* name() const override
+    {
+        return key_bits_ == 128 ? "aes-128-ctr" : "aes-256-ctr";
+    }
+
+    void apply(const char* source, char* output, std::size_t length, std::uint64_t position = 0) const override
+    {
+        aes_ctr_apply(key_, initial_counter_, position, reinterpret_cast<const std::uint8_t*>(source), reinterpret_cast<std::uint8_t*>(output), length, level_);
+    }
+
+    AesLevel level() const
+    {
+        return level_;
+    }
+
+private:
+    AesCtrCipher(const std::vector<std::uint8_t>& material, unsigned key_bits, AesLevel level)
+        : key_(material.data(), key_bits / 8), key_bits_(key_bits), level_(level)
+    {
+        std::copy(material.end() - AesKey::block_size, material.end(), initial_counter_.begin());
+    }
+
+    static std::vector<std::uint8_t> derive(const std::string& key, unsigned key_bits, std::uint32_t iterations)
+    {
+        if (key_bits != 128 && key_bits != 256)
+        {
+            throw std::invalid_argument("AES key size must be 128 or 256 bits");
+        }
+        if (key.empty())
+        {
+            throw std::invalid_argument("AES key must not be empty");
+        }
+        const std::string salt = key_bits == 128 ? "CS-405 aes-128-ctr" : "CS-405 aes-256-ctr";
+        return pbkdf2_hmac_sha256(key, salt, iterations, key_bits / 8 + AesKey::block_size);
+    }
+
+    AesKey key_;
+    std::array<std::uint8_t, AesKey::block_size> initial_counter_{};
+    unsigned key_bits_;
+    AesLevel level_;
+};
+
+/// <summary>
+/// The names make_cipher accepts
+/// </summary>
+inline const std::vector<std::string>& cipher_names()
+{
+    static const std::vector<std::string> names = {"xor", "aes-128-ctr", "aes-256-ctr"};
+    return names;
+}
+
+/// <summary>
+/// Create a cipher by name
+/// </summary>
+/// <param name="name">one of cipher_names()</param>
+/// <param name="key">string key to use or derive from</param>
+/// <returns>the cipher; throws std::invalid_argument for an unknown name</returns>
+inline std::unique_ptr<Cipher> make_cipher(const std::string& name, const std::string& key)
+{
+    if (name == "xor")
+    {
+        return std::make_unique<XorKeyCipher>(key);
+    }
+    if (name == "aes-128-ctr")
+    {
+        return std::make_unique<AesCtrCipher>(key, 128);
+    }
+    if (name == "aes-256-ctr")
+    {
+        return std::make_unique<AesCtrCipher>(key, 256);
+    }
+    throw std::invalid_argument("unknown cipher " + name);
+}
+
+/// <summary>
+/// encrypt_decrypt through a chosen cipher
+/// </summary>
+/// <param name="source">input string to process</param>
+/// <param name="cipher">cipher to apply</param>
+/// <returns>transformed string, the same length as source</returns>
+inline std::string encrypt_decrypt(const std::string& source, const Cipher& cipher)
+{
+    return cipher.apply(source);
+}
+
+/// <summary>
+/// encrypt_decrypt through a chosen cipher, checksumming the source and the result on the way
+/// </summary>
+/// <param name="source">input string to process</param>
+/// <param name="cipher">cipher to apply</param>
+/// <param name="checksums">CRC-32C of source and of the returned string</param>
+/// <returns>transformed string, the same length as source</returns>
+inline std::string encrypt_decrypt(const std::string& source, const Cipher& cipher, StreamChecksums& checksums)
+{
+    checksums = StreamChecksums();
+    return cipher.apply_checksummed(source, checksums);
+}
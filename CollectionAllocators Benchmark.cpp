@@ -0,0 +1,107 @@
+// CollectionAllocators Benchmark.cpp : Allocation heavy collection workloads under each policy in CollectionAllocators.h.
+//
+// Every iteration creates a fresh policy, the way every CollectionTest gets a fresh fixture, so setting
+// up and tearing down the memory resource is part of the cost. Results go to the console and, unless
+// --benchmark_out is given, to collection_allocators_benchmark.json.
+
+#include <memory>
+#include <vector>
+
+#include "BenchmarkMain.h"
+#include "CollectionAllocators.h"
+#include "Random.h"
+
+namespace
+{
+    // one collection grown element by element without a reserve
+    template <typename Allocation>
+    void BM_GrowCollection(benchmark::State& state)
+    {
+        const auto count = static_cast<int>(state.range(0));
+        for (auto _ : state)
+        {
+            Allocation allocation;
+            Collection<Allocation> collection(allocation.allocator());
+            for (auto i = 0; i < count; ++i)
+                collection.push_back(i);
+            benchmark::DoNotOptimize(collection.data());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    // many short lived small collections, the case pools are built for
+    template <typename Allocation>
+    void BM_ManySmallCollections(benchmark::State& state)
+    {
+        const auto count = static_cast<int>(state.range(0));
+        for (auto _ : state)
+        {
+            Allocation allocation;
+            for (auto i = 0; i < count; ++i)
+            {
+                Collection<Allocation> collection(allocation.allocator());
+                for (auto j = 0; j < 16; ++j)
+                    collection.push_back(j);
+                benchmark::DoNotOptimize(collection.data());
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    // small collections that stay alive together and are freed at the end
+    template <typename Allocation>
+    void BM_LiveSmallCollections(benchmark::State& state)
+    {
+        const auto count = static_cast<std::size_t>(state.range(0));
+        for (auto _ : state)
+        {
+            Allocation allocation;
+            std::vector<Collection<Allocation>> collections;
+            collections.reserve(count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                collections.emplace_back(allocation.allocator());
+                collections.back().resize(16);
+            }
+            benchmark::DoNotOptimize(collections.data());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    // one CollectionTest from SetUp to TearDown: a heap allocated collection, add_entries,
+    // a resize up, a reserve and a clear
+    template <typename Allocation>
+    void BM_TestLifecycle(benchmark::State& state)
+    {
+        const auto count = static_cast<int>(state.range(0));
+        for (auto _ : state)
+        {
+            Allocation allocation;
+            std::unique_ptr<Collection<Allocation>> collection(new Collection<Allocation>(allocation.allocator()));
+            for (auto i = 0; i < count; ++i)
+                collection->push_back(thread_random().next_below(100));
+            collection->resize(static_cast<std::size_t>(count) * 2);
+            collection->reserve(static_cast<std::size_t>(count) * 4);
+            collection->clear();
+            benchmark::DoNotOptimize(collection->data());
+            collection.reset(nullptr);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    // the policy is a template argument, so register each one separately
+#define BENCHMARK_ALLOCATIONS(name, ...)                                   \
+    BENCHMARK_TEMPLATE(name, StandardAllocation)->__VA_ARGS__;          \
+    BENCHMARK_TEMPLATE(name, MonotonicArenaAllocation)->__VA_ARGS__;    \
+    BENCHMARK_TEMPLATE(name, PoolAllocation)->__VA_ARGS__
+
+    BENCHMARK_ALLOCATIONS(BM_GrowCollection, RangeMultiplier(10)->Range(10, 1000000));
+    BENCHMARK_ALLOCATIONS(BM_ManySmallCollections, RangeMultiplier(10)->Range(10, 100000));
+    BENCHMARK_ALLOCATIONS(BM_LiveSmallCollections, RangeMultiplier(10)->Range(10, 100000));
+    BENCHMARK_ALLOCATIONS(BM_TestLifecycle, Arg(1)->Arg(15)->Arg(50)->Arg(1000));
+}
+
+int main(int argc, char** argv)
+{
+    return run_benchmarks(argc, argv, "collection_allocators_benchmark.json");
+}
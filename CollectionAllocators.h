@@ -0,0 +1,170 @@
+// CollectionAllocators.h : The allocation strategies the collection tests and benchmarks are run against.
+//
+// Each policy owns whatever memory resource it needs and hands out allocators for std::vector<int>.
+// A policy lives as long as the fixture that uses it, so every collection made from it is freed first.
+// The pmr policies also expose their resource, so a test can put a CountingResource in front of it and
+// count the requests the collection makes rather than the heap allocations behind them.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+/// <summary>
+/// A memory_resource that counts the requests passing through it to an upstream resource
+/// </summary>
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream) noexcept
+        : upstream_(upstream)
+    {
+    }
+
+    CountingResource(const CountingResource&) = delete;
+    CountingResource& operator=(const CountingResource&) = delete;
+
+    std::size_t allocations() const noexcept
+    {
+        return allocations_;
+    }
+
+    std::size_t deallocations() const noexcept
+    {
+        return deallocations_;
+    }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        void* memory = upstream_->allocate(bytes, alignment);
+        ++allocations_;
+        return memory;
+    }
+
+    void do_deallocate(void* memory, std::size_t bytes, std::size_t alignment) override
+    {
+        ++deallocations_;
+        upstream_->deallocate(memory, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream_;
+    std::size_t allocations_ = 0;
+    std::size_t deallocations_ = 0;
+};
+
+/// <summary>
+/// The default: every allocation goes to the global operator new
+/// </summary>
+class StandardAllocation
+{
+public:
+    using allocator_type = std::allocator<int>;
+
+    static constexpr const char* name = "std_allocator";
+
+    // allocates straight from operator new, so the heap counts are the allocator requests
+    static constexpr bool uses_memory_resource = false;
+
+    // the most operator new calls one allocation through allocator() can make
+    static constexpr std::size_t max_heap_allocations_per_request = 1;
+
+    allocator_type allocator() noexcept
+    {
+        return allocator_type();
+    }
+};
+
+/// <summary>
+/// A bump allocator: allocations come from an inline buffer and then from ever larger blocks
+/// taken from the heap. Deallocation does nothing; memory comes back when the policy is destroyed.
+/// </summary>
+class MonotonicArenaAllocation
+{
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<int>;
+
+    static constexpr const char* name = "monotonic_arena";
+
+    static constexpr bool uses_memory_resource = true;
+
+    // a request that does not fit takes one new block from the heap
+    static constexpr std::size_t max_heap_allocations_per_request = 1;
+
+    // enough for the small collections most tests build without touching the heap
+    static constexpr std::size_t inline_buffer_size = 16 * 1024;
+
+    MonotonicArenaAllocation() noexcept
+        : resource_(buffer_.data(), buffer_.size(), std::pmr::new_delete_resource())
+    {
+    }
+
+    MonotonicArenaAllocation(const MonotonicArenaAllocation&) = delete;
+    MonotonicArenaAllocation& operator=(const MonotonicArenaAllocation&) = delete;
+
+    allocator_type allocator() noexcept
+    {
+        return allocator_type(&resource_);
+    }
+
+    std::pmr::memory_resource* resource() noexcept
+    {
+        return &resource_;
+    }
+
+private:
+    alignas(std::max_align_t) std::array<std::byte, inline_buffer_size> buffer_;
+    std::pmr::monotonic_buffer_resource resource_;
+};
+
+/// <summary>
+/// Size-class pools: freed blocks are kept for the next allocation of the same size instead of
+/// going back to the heap. Single threaded, like the fixtures that use it.
+/// </summary>
+class PoolAllocation
+{
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<int>;
+
+    static constexpr const char* name = "pool";
+
+    static constexpr bool uses_memory_resource = true;
+
+    // a request can need both a new chunk and room in the resource's own bookkeeping
+    static constexpr std::size_t max_heap_allocations_per_request = 2;
+
+    PoolAllocation() noexcept
+        : resource_(std::pmr::new_delete_resource())
+    {
+    }
+
+    PoolAllocation(const PoolAllocation&) = delete;
+    PoolAllocation& operator=(const PoolAllocation&) = delete;
+
+    allocator_type allocator() noexcept
+    {
+        return allocator_type(&resource_);
+    }
+
+    std::pmr::memory_resource* resource() noexcept
+    {
+        return &resource_;
+    }
+
+private:
+    std::pmr::unsynchronized_pool_resource resource_;
+};
+
+/// <summary>
+/// The collection type a policy produces
+/// </summary>
+template <typename Allocation>
+using Collection = std::vector<int, typename Allocation::allocator_type>;
@@ -0,0 +1,157 @@
+// CppcheckReport Benchmark.cpp : Streaming parse, index build and lookups on a synthetic cppcheck report.
+//
+// The report is generated once into the temp directory by CppcheckReportGenerator.h, --report_mb=1024 by
+// default. --input=<path> benchmarks an existing report instead.
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "BenchmarkMain.h"
+#include "CppcheckReport.h"
+#include "CppcheckReportGenerator.h"
+#include "Random.h"
+
+namespace
+{
+    std::string report_path;
+
+    std::size_t report_size()
+    {
+        return static_cast<std::size_t>(std::filesystem::file_size(report_path));
+    }
+
+    // the index the lookup benchmarks share, built on first use
+    const CppcheckIndex& shared_index()
+    {
+        static const CppcheckIndex index = CppcheckIndex::load(report_path);
+        return index;
+    }
+
+    struct NullHandler
+    {
+        std::size_t elements = 0;
+
+        void start_element(std::string_view, const std::vector<XmlAttribute>& attributes)
+        {
+            elements += attributes.size();
+        }
+
+        void end_element(std::string_view)
+        {
+        }
+    };
+
+    // reading the file alone, the floor for everything else
+    void BM_ReadReport(benchmark::State& state)
+    {
+        std::vector<char> buffer(XmlSaxParser<NullHandler>::default_buffer_size);
+        for (auto _ : state)
+        {
+            std::FILE* file = std::fopen(report_path.c_str(), "rb");
+            while (std::fread(buffer.data(), 1, buffer.size(), file) > 0)
+            {
+                benchmark::DoNotOptimize(buffer.data());
+            }
+            std::fclose(file);
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * report_size()));
+    }
+
+    void BM_StreamingParse(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            NullHandler handler;
+            XmlSaxParser<NullHandler>(handler).parse_file(report_path);
+            benchmark::DoNotOptimize(handler.elements);
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * report_size()));
+    }
+
+    void BM_BuildIndex(benchmark::State& state)
+    {
+        std::size_t findings = 0;
+        std::size_t string_bytes = 0;
+        for (auto _ : state)
+        {
+            const CppcheckIndex index = CppcheckIndex::load(report_path);
+            findings = index.size();
+            string_bytes = index.strings().bytes();
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * report_size()));
+        state.counters["findings"] = static_cast<double>(findings);
+        state.counters["interned_bytes"] = static_cast<double>(string_bytes);
+    }
+
+    void BM_CountById(benchmark::State& state)
+    {
+        const CppcheckIndex& index = shared_index();
+        std::size_t next = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(index.with_id(synthetic_checks[next++ % (sizeof(synthetic_checks) / sizeof(synthetic_checks[0]))].id).size());
+        }
+    }
+
+    void BM_CountBySeverity(benchmark::State& state)
+    {
+        const CppcheckIndex& index = shared_index();
+        const char* severities[] = { "error", "warning", "style", "performance" };
+        std::size_t next = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(index.with_severity(severities[next++ % 4]).size());
+        }
+    }
+
+    void BM_CountByCwe(benchmark::State& state)
+    {
+        const CppcheckIndex& index = shared_index();
+        const std::uint32_t cwes[] = { 398, 476, 562, 563, 664, 788 };
+        std::size_t next = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(index.with_cwe(cwes[next++ % 6]).size());
+        }
+    }
+
+    void BM_LookupFileLine(benchmark::State& state)
+    {
+        const CppcheckIndex& index = shared_index();
+        Xoshiro256 random(1);
+        std::vector<std::string> files;
+        for (int i = 0; i < 256; ++i)
+        {
+            files.push_back(synthetic_file_name(random.next_below(synthetic_file_count)));
+        }
+
+        std::size_t next = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(index.at(files[next++ % files.size()], 1 + random.next_below(5000)));
+        }
+    }
+
+    BENCHMARK(BM_ReadReport)->Unit(benchmark::kMillisecond)->UseRealTime();
+    BENCHMARK(BM_StreamingParse)->Unit(benchmark::kMillisecond)->UseRealTime();
+    BENCHMARK(BM_BuildIndex)->Unit(benchmark::kMillisecond)->UseRealTime();
+    BENCHMARK(BM_CountById);
+    BENCHMARK(BM_CountBySeverity);
+    BENCHMARK(BM_CountByCwe);
+    BENCHMARK(BM_LookupFileLine);
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t report_mb = take_benchmark_option(argc, argv, "report_mb", std::size_t(1024));
+    report_path = take_benchmark_option(argc, argv, "input", "");
+
+    if (report_path.empty())
+    {
+        report_path = synthetic_cppcheck_report(report_mb);
+    }
+
+    return run_benchmarks(argc, argv);
+}
@@ -0,0 +1,961 @@
+// CppcheckReport.h : Streaming reader and in-memory index for cppcheck XML results such as 5-3 Static Testing.xml.
+//
+// The report is parsed SAX style from a fixed size buffer, so a report of any size is read without ever
+// holding its text in memory. Every string is interned once and findings refer to strings by number,
+// which keeps the index compact when the same check fires hundreds of thousands of times.
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// Stores each distinct string once and hands out dense 32-bit ids for them. Id 0 is always
+/// the empty string, which stands for a missing attribute. Lookups go through an open addressed
+/// table of hashes, so a miss rarely touches the string data at all. A moved-from pool is empty
+/// and starts over, with id 0 the empty string again, on its next intern.
+/// </summary>
+class StringPool
+{
+public:
+    static constexpr std::uint32_t npos = 0xffffffffu;
+
+    StringPool()
+    {
+        intern(std::string_view());
+    }
+
+    StringPool(StringPool&& other) noexcept
+        : blocks_(std::move(other.blocks_)),
+          current_(std::exchange(other.current_, nullptr)),
+          block_used_(std::exchange(other.block_used_, 0)),
+          bytes_(std::exchange(other.bytes_, 0)),
+          strings_(std::move(other.strings_)),
+          slots_(std::move(other.slots_))
+    {
+    }
+
+    StringPool& operator=(StringPool&& other) noexcept
+    {
+        if (this != &other)
+        {
+            blocks_ = std::move(other.blocks_);
+            current_ = std::exchange(other.current_, nullptr);
+            block_used_ = std::exchange(other.block_used_, 0);
+            bytes_ = std::exchange(other.bytes_, 0);
+            strings_ = std::move(other.strings_);
+            slots_ = std::move(other.slots_);
+            other.blocks_.clear();
+            other.strings_.clear();
+            other.slots_.clear();
+        }
+        return *this;
+    }
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    std::uint32_t intern(std::string_view text)
+    {
+        if (slots_.empty())
+        { // moved from, so there is no table to probe
+            *this = StringPool();
+        }
+
+        const std::uint64_t hash = hash_text(text);
+        std::size_t slot = probe(text, hash);
+        if (slots_[slot].id != npos)
+        {
+            return slots_[slot].id;
+        }
+
+        const auto id = static_cast<std::uint32_t>(strings_.size());
+        strings_.push_back(store(text));
+        slots_[slot] = { hash, id };
+
+        // keep the table at most half full so probe sequences stay short
+        if (strings_.size() * 2 > slots_.size())
+        {
+            grow();
+        }
+        return id;
+    }
+
+    /// <summary>
+    /// The id of text, or npos if it was never interned
+    /// </summary>
+    std::uint32_t find(std::string_view text) const noexcept
+    {
+        if (slots_.empty())
+        {
+            return npos;
+        }
+        return slots_[probe(text, hash_text(text))].id;
+    }
+
+    std::string_view operator[](std::uint32_t id) const noexcept
+    {
+        return strings_[id];
+    }
+
+    std::size_t size() const noexcept
+    {
+        return strings_.size();
+    }
+
+    /// <summary>
+    /// Bytes of string data held, not counting the lookup table
+    /// </summary>
+    std::size_t bytes() const noexcept
+    {
+        return bytes_;
+    }
+
+private:
+    static constexpr std::size_t block_size = 64 * 1024;
+
+    struct Slot
+    {
+        std::uint64_t hash;
+        std::uint32_t id;
+    };
+
+    // mixes eight bytes at a time, which is all interning needs and much cheaper than std::hash
+    static std::uint64_t hash_text(std::string_view text) noexcept
+    {
+        std::uint64_t hash = 0x9e3779b97f4a7c15ull ^ text.size();
+        std::size_t i = 0;
+        for (; i + 8 <= text.size(); i += 8)
+        {
+            std::uint64_t word;
+            std::memcpy(&word, text.data() + i, 8);
+            hash = (hash ^ word) * 0xbf58476d1ce4e5b9ull;
+            hash ^= hash >> 29;
+        }
+        std::uint64_t tail = 0;
+        if (i < text.size())
+        {
+            std::memcpy(&tail, text.data() + i, text.size() - i);
+        }
+        hash = (hash ^ tail) * 0x94d049bb133111ebull;
+        return hash ^ (hash >> 32);
+    }
+
+    // the slot holding text, or the empty slot where it belongs; slots_ must not be empty
+    std::size_t probe(std::string_view text, std::uint64_t hash) const noexcept
+    {
+        const std::size_t mask = slots_.size() - 1;
+        for (std::size_t slot = static_cast<std::size_t>(hash) & mask;; slot = (slot + 1) & mask)
+        {
+            const Slot& entry = slots_[slot];
+            if (entry.id == npos || (entry.hash == hash && strings_[entry.id] == text))
+            {
+                return slot;
+            }
+        }
+    }
+
+    void grow()
+    {
+        std::vector<Slot> old(slots_.size() * 2, Slot{ 0, npos });
+        old.swap(slots_);
+        const std::size_t mask = slots_.size() - 1;
+        for (const Slot& entry : old)
+        {
+            if (entry.id != npos)
+            {
+                std::size_t slot = static_cast<std::size_t>(entry.hash) & mask;
+                while (slots_[slot].id != npos)
+                {
+                    slot = (slot + 1) & mask;
+                }
+                slots_[slot] = entry;
+            }
+        }
+    }
+
+    // strings are packed into large blocks that never move, so the views stay valid
+    std::string_view store(std::string_view text)
+    {
+        if (text.empty())
+        {
+            return std::string_view("", 0);
+        }
+        if (text.size() > block_size / 4)
+        { // a long string gets a block of its own rather than wasting the rest of the current one
+            blocks_.emplace_back(new char[text.size()]);
+            std::memcpy(blocks_.back().get(), text.data(), text.size());
+            bytes_ += text.size();
+            return std::string_view(blocks_.back().get(), text.size());
+        }
+        if (current_ == nullptr || block_used_ + text.size() > block_size)
+        {
+            blocks_.emplace_back(new char[block_size]);
+            current_ = blocks_.back().get();
+            block_used_ = 0;
+        }
+
+        char* destination = current_ + block_used_;
+        std::memcpy(destination, text.data(), text.size());
+        block_used_ += text.size();
+        bytes_ += text.size();
+        return std::string_view(destination, text.size());
+    }
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* current_ = nullptr;
+    std::size_t block_used_ = 0;
+    std::size_t bytes_ = 0;
+    std::vector<std::string_view> strings_;
+    std::vector<Slot> slots_ = std::vector<Slot>(64, Slot{ 0, npos });
+};
+
+/// <summary>
+/// Replace XML entity and character references with the characters they stand for.
+/// Returns text itself when it has none, otherwise a view of scratch.
+/// </summary>
+inline std::string_view decode_xml_text(std::string_view text, std::string& scratch)
+{
+    std::size_t ampersand = text.find('&');
+    if (ampersand == std::string_view::npos)
+    {
+        return text;
+    }
+
+    scratch.clear();
+    std::size_t position = 0;
+    while (ampersand != std::string_view::npos)
+    {
+        const std::size_t semicolon = text.find(';', ampersand);
+        if (semicolon == std::string_view::npos)
+        {
+            break;
+        }
+        scratch.append(text.data() + position, ampersand - position);
+
+        const std::string_view entity = text.substr(ampersand + 1, semicolon - ampersand - 1);
+        std::uint32_t code = 0;
+        bool known = true;
+        if (entity == "amp") code = '&';
+        else if (entity == "lt") code = '<';
+        else if (entity == "gt") code = '>';
+        else if (entity == "quot") code = '"';
+        else if (entity == "apos") code = '\'';
+        else if (entity.size() > 1 && entity[0] == '#')
+        {
+            const bool hex = entity[1] == 'x' || entity[1] == 'X';
+            const char* first = entity.data() + (hex ? 2 : 1);
+            const char* last = entity.data() + entity.size();
+            const auto result = std::from_chars(first, last, code, hex ? 16 : 10);
+            known = result.ec == std::errc() && result.ptr == last && first != last && code <= 0x10ffff;
+        }
+        else
+        {
+            known = false;
+        }
+
+        if (!known)
+        { // not a reference we understand, keep it as written
+            scratch.append(text.data() + ampersand, semicolon + 1 - ampersand);
+        }
+        else if (code < 0x80)
+        {
+            scratch.push_back(static_cast<char>(code));
+        }
+        else if (code < 0x800)
+        {
+            scratch.push_back(static_cast<char>(0xc0 | (code >> 6)));
+            scratch.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+        }
+        else if (code < 0x10000)
+        {
+            scratch.push_back(static_cast<char>(0xe0 | (code >> 12)));
+            scratch.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+            scratch.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+        }
+        else
+        {
+            scratch.push_back(static_cast<char>(0xf0 | (code >> 18)));
+            scratch.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+            scratch.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+            scratch.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+        }
+
+        position = semicolon + 1;
+        ampersand = text.find('&', position);
+    }
+    scratch.append(text.data() + position, text.size() - position);
+    return scratch;
+}
+
+/// <summary>
+/// Append text to out escaped for an XML attribute value, the reverse of decode_xml_text.
+/// Line breaks and tabs become character references so they survive attribute normalization.
+/// </summary>
+inline void append_xml_escaped(std::string& out, std::string_view text)
+{
+    for (const char c : text)
+    {
+        switch (c)
+        {
+        case '&': out += "&amp;"; break;
+        case '<': out += "&lt;"; break;
+        case '>': out += "&gt;"; break;
+        case '"': out += "&quot;"; break;
+        case '\'': out += "&apos;"; break;
+        case '\n': out += "&#10;"; break;
+        case '\r': out += "&#13;"; break;
+        case '\t': out += "&#9;"; break;
+        default: out += c; break;
+        }
+    }
+}
+
+/// <summary>
+/// One attribute of an element, with the value exactly as written (references not decoded)
+/// </summary>
+struct XmlAttribute
+{
+    std::string_view name;
+    std::string_view value;
+};
+
+/// <summary>
+/// Minimal SAX parser for machine generated XML. The handler receives
+///   void start_element(std::string_view name, const std::vector&lt;XmlAttribute&gt;&amp; attributes);
+///   void end_element(std::string_view name);
+/// and a self-closing element gets both calls. Text, comments, CDATA, processing instructions
+/// and the DOCTYPE are skipped; the views passed to the handler are only valid during the call.
+/// Throws std::runtime_error on malformed markup.
+/// </summary>
+template <typename Handler>
+class XmlSaxParser
+{
+public:
+    static constexpr std::size_t default_buffer_size = std::size_t(1) << 20;
+
+    explicit XmlSaxParser(Handler& handler)
+        : handler_(handler)
+    {
+    }
+
+    /// <summary>
+    /// Parse a whole document held in memory
+    /// </summary>
+    void parse(const char* data, std::size_t size)
+    {
+        feed(data, size, true);
+    }
+
+    /// <summary>
+    /// Parse a file through a buffer of buffer_size bytes, grown only if a single tag does not fit.
+    /// Throws std::runtime_error if the file cannot be read.
+    /// </summary>
+    void parse_file(const std::string& filename, std::size_t buffer_size = default_buffer_size)
+    {
+        std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(std::fopen(filename.c_str(), "rb"), &std::fclose);
+        if (!file)
+        {
+            throw std::runtime_error("Unable to open " + filename + ": " + std::strerror(errno));
+        }
+
+        std::vector<char> buffer(buffer_size);
+        std::size_t pending = 0;
+        for (;;)
+        {
+            if (pending == buffer.size())
+            { // one tag is larger than the whole buffer
+                buffer.resize(buffer.size() * 2);
+            }
+
+            const std::size_t read = std::fread(buffer.data() + pending, 1, buffer.size() - pending, file.get());
+            if (read == 0 && std::ferror(file.get()))
+            {
+                throw std::runtime_error("Unable to read " + filename + ": " + std::strerror(errno));
+            }
+
+            const std::size_t available = pending + read;
+            const bool last = read == 0;
+            const std::size_t consumed = feed(buffer.data(), available, last);
+            if (last)
+            {
+                return;
+            }
+
+            // keep the incomplete tag for the next read
+            pending = available - consumed;
+            std::memmove(buffer.data(), buffer.data() + consumed, pending);
+        }
+    }
+
+    /// <summary>
+    /// Bytes of the document consumed so far
+    /// </summary>
+    std::uint64_t offset() const noexcept
+    {
+        return offset_;
+    }
+
+    /// <summary>
+    /// Parse every complete piece of markup in data and return how many bytes were used. When
+    /// last is false, an incomplete tag at the end is left for the next call; when it is true,
+    /// one is an error.
+    /// </summary>
+    std::size_t feed(const char* data, std::size_t size, bool last)
+    {
+        const char* const end = data + size;
+        const char* position = data;
+
+        for (;;)
+        {
+            const char* open = static_cast<const char*>(std::memchr(position, '<', static_cast<std::size_t>(end - position)));
+            if (open == nullptr)
+            { // only text is left
+                offset_ += static_cast<std::uint64_t>(end - data);
+                return size;
+            }
+
+            const char* next = parse_markup(open, end, data);
+            if (next == nullptr)
+            {
+                if (last)
+                {
+                    fail("unexpected end of document", data, open);
+                }
+                offset_ += static_cast<std::uint64_t>(open - data);
+                return static_cast<std::size_t>(open - data);
+            }
+            position = next;
+        }
+    }
+
+private:
+    static bool is_space(char c) noexcept
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    static bool ends_name(char c) noexcept
+    {
+        return is_space(c) || c == '>' || c == '/' || c == '=';
+    }
+
+    [[noreturn]] void fail(const char* problem, const char* data, const char* at) const
+    {
+        throw std::runtime_error(std::string("Malformed XML at byte ") + std::to_string(offset_ + static_cast<std::uint64_t>(at - data)) + ": " + problem);
+    }
+
+    static const char* find(const char* position, const char* end, std::string_view terminator) noexcept
+    {
+        const std::string_view rest(position, static_cast<std::size_t>(end - position));
+        const std::size_t found = rest.find(terminator);
+        return found == std::string_view::npos ? nullptr : position + found + terminator.size();
+    }
+
+    // returns the first byte after the markup starting at open, or nullptr if it is incomplete
+    const char* parse_markup(const char* open, const char* end, const char* data)
+    {
+        const char* p = open + 1;
+        if (p == end)
+        {
+            return nullptr;
+        }
+
+        if (*p == '?')
+        {
+            return find(p, end, "?>");
+        }
+        if (*p == '!')
+        {
+            const std::string_view rest(p, static_cast<std::size_t>(end - p));
+            if (rest.size() < 8)
+            {
+                return nullptr;
+            }
+            if (rest.compare(0, 3, "!--") == 0)
+            {
+                return find(p + 3, end, "-->");
+            }
+            if (rest.compare(0, 8, "![CDATA[") == 0)
+            {
+                return find(p + 8, end, "]]>");
+            }
+            return find(p, end, ">");
+        }
+
+        if (*p == '/')
+        {
+            const char* name = ++p;
+            while (p != end && !ends_name(*p))
+            {
+                ++p;
+            }
+            const char* name_end = p;
+            while (p != end && is_space(*p))
+            {
+                ++p;
+            }
+            if (p == end)
+            {
+                return nullptr;
+            }
+            if (*p != '>' || name == name_end)
+            {
+                fail("bad end tag", data, open);
+            }
+            handler_.end_element(std::string_view(name, static_cast<std::size_t>(name_end - name)));
+            return p + 1;
+        }
+
+        const char* name = p;
+        while (p != end && !ends_name(*p))
+        {
+            ++p;
+        }
+        if (p == end)
+        {
+            return nullptr;
+        }
+        if (p == name)
+        {
+            fail("missing element name", data, open);
+        }
+        const std::string_view element(name, static_cast<std::size_t>(p - name));
+
+        attributes_.clear();
+        for (;;)
+        {
+            while (p != end && is_space(*p))
+            {
+                ++p;
+            }
+            if (p == end)
+            {
+                return nullptr;
+            }
+
+            if (*p == '>')
+            {
+                handler_.start_element(element, attributes_);
+                return p + 1;
+            }
+            if (*p == '/')
+            {
+                if (p + 1 == end)
+                {
+                    return nullptr;
+                }
+                if (p[1] != '>')
+                {
+                    fail("bad empty element", data, open);
+                }
+                handler_.start_element(element, attributes_);
+                handler_.end_element(element);
+                return p + 2;
+            }
+
+            const char* attribute = p;
+            while (p != end && !ends_name(*p))
+            {
+                ++p;
+            }
+            const char* attribute_end = p;
+            while (p != end && is_space(*p))
+            {
+                ++p;
+            }
+            if (p == end)
+            {
+                return nullptr;
+            }
+            if (*p != '=' || attribute == attribute_end)
+            {
+                fail("bad attribute", data, p);
+            }
+            ++p;
+            while (p != end && is_space(*p))
+            {
+                ++p;
+            }
+            if (p == end)
+            {
+                return nullptr;
+            }
+            if (*p != '"' && *p != '\'')
+            {
+                fail("unquoted attribute value", data, p);
+            }
+
+            const char* value = p + 1;
+            const char* close = static_cast<const char*>(std::memchr(value, *p, static_cast<std::size_t>(end - value)));
+            if (close == nullptr)
+            {
+                return nullptr;
+            }
+            attributes_.push_back({ std::string_view(attribute, static_cast<std::size_t>(attribute_end - attribute)),
+                                    std::string_view(value, static_cast<std::size_t>(close - value)) });
+            p = close + 1;
+        }
+    }
+
+    Handler& handler_;
+    std::vector<XmlAttribute> attributes_;
+    std::uint64_t offset_ = 0;
+};
+
+/// <summary>
+/// One &lt;location&gt; of a finding. Strings are ids in the index's string pool.
+/// </summary>
+struct CppcheckLocation
+{
+    std::uint32_t file = 0;
+    std::uint32_t line = 0;
+    std::uint32_t column = 0;
+    std::uint32_t info = 0;
+};
+
+/// <summary>
+/// One &lt;error&gt;. Strings are ids in the index's string pool, 0 when the attribute is missing.
+/// </summary>
+struct CppcheckFinding
+{
+    std::uint32_t id = 0;
+    std::uint32_t severity = 0;
+    std::uint32_t msg = 0;
+    std::uint32_t verbose = 0;
+    std::uint32_t file0 = 0;
+    // 0 when the check has no CWE
+    std::uint32_t cwe = 0;
+    bool inconclusive = false;
+    std::uint32_t first_location = 0;
+    std::uint32_t location_count = 0;
+};
+
+/// <summary>
+/// A run of contiguous elements, usable in a range-based for
+/// </summary>
+template <typename T>
+struct IndexRange
+{
+    const T* first = nullptr;
+    const T* last = nullptr;
+
+    const T* begin() const noexcept
+    {
+        return first;
+    }
+
+    const T* end() const noexcept
+    {
+        return last;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return static_cast<std::size_t>(last - first);
+    }
+
+    bool empty() const noexcept
+    {
+        return first == last;
+    }
+};
+
+/// <summary>
+/// All findings of a cppcheck report, indexed by check id, severity, CWE and file/line.
+/// Lookups by id, severity and CWE are hash lookups; file/line lookups are binary searches.
+/// Findings are referred to by their position in the report.
+/// </summary>
+class CppcheckIndex
+{
+public:
+    /// <summary>
+    /// Parse and index a report file. Throws std::runtime_error if it cannot be read or parsed.
+    /// </summary>
+    static CppcheckIndex load(const std::string& filename)
+    {
+        CppcheckIndex index;
+        XmlSaxParser<CppcheckIndex> parser(index);
+        parser.parse_file(filename);
+        index.finish();
+        return index;
+    }
+
+    /// <summary>
+    /// Parse and index a report held in memory
+    /// </summary>
+    static CppcheckIndex parse(std::string_view xml)
+    {
+        CppcheckIndex index;
+        XmlSaxParser<CppcheckIndex> parser(index);
+        parser.parse(xml.data(), xml.size());
+        index.finish();
+        return index;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return findings_.size();
+    }
+
+    const CppcheckFinding& operator[](std::size_t finding) const noexcept
+    {
+        return findings_[finding];
+    }
+
+    const StringPool& strings() const noexcept
+    {
+        return strings_;
+    }
+
+    /// <summary>
+    /// The text of an interned string, with XML references already decoded
+    /// </summary>
+    std::string_view text(std::uint32_t string) const noexcept
+    {
+        return strings_[string];
+    }
+
+    IndexRange<CppcheckLocation> locations(const CppcheckFinding& finding) const noexcept
+    {
+        const CppcheckLocation* first = locations_.data() + finding.first_location;
+        return { first, first + finding.location_count };
+    }
+
+    // the version attributes of <results> and <cppcheck>
+    std::string_view format_version() const noexcept
+    {
+        return strings_[format_version_];
+    }
+
+    std::string_view cppcheck_version() const noexcept
+    {
+        return strings_[cppcheck_version_];
+    }
+
+    /// <summary>
+    /// Findings of one check, such as shadowVariable
+    /// </summary>
+    const std::vector<std::uint32_t>& with_id(std::string_view id) const
+    {
+        return postings(by_id_, strings_.find(id));
+    }
+
+    const std::vector<std::uint32_t>& with_severity(std::string_view severity) const
+    {
+        return postings(by_severity_, strings_.find(severity));
+    }
+
+    const std::vector<std::uint32_t>& with_cwe(std::uint32_t cwe) const
+    {
+        return postings(by_cwe_, cwe);
+    }
+
+    /// <summary>
+    /// Findings with any location in file between first_line and last_line inclusive, in report order
+    /// </summary>
+    std::vector<std::uint32_t> in_file(std::string_view file, std::uint32_t first_line = 0, std::uint32_t last_line = 0xffffffffu) const
+    {
+        std::vector<std::uint32_t> found;
+        const std::uint32_t file_id = strings_.find(file);
+        if (file_id == StringPool::npos)
+        {
+            return found;
+        }
+
+        auto entry = std::lower_bound(by_line_.begin(), by_line_.end(), LineEntry{ file_id, first_line, 0 });
+        for (; entry != by_line_.end() && entry->file == file_id && entry->line <= last_line; ++entry)
+        {
+            found.push_back(entry->finding);
+        }
+
+        // a finding whose trace passes the range more than once is listed once
+        std::sort(found.begin(), found.end());
+        found.erase(std::unique(found.begin(), found.end()), found.end());
+        return found;
+    }
+
+    std::vector<std::uint32_t> at(std::string_view file, std::uint32_t line) const
+    {
+        return in_file(file, line, line);
+    }
+
+    /// <summary>
+    /// Call visit(key, findings) for every distinct check id, severity or CWE
+    /// </summary>
+    template <typename Visit>
+    void for_each_id(Visit visit) const
+    {
+        for (const auto& entry : by_id_)
+        {
+            visit(strings_[entry.first], entry.second);
+        }
+    }
+
+    template <typename Visit>
+    void for_each_severity(Visit visit) const
+    {
+        for (const auto& entry : by_severity_)
+        {
+            visit(strings_[entry.first], entry.second);
+        }
+    }
+
+    template <typename Visit>
+    void for_each_cwe(Visit visit) const
+    {
+        for (const auto& entry : by_cwe_)
+        {
+            visit(entry.first, entry.second);
+        }
+    }
+
+    // XmlSaxParser handler
+
+    void start_element(std::string_view name, const std::vector<XmlAttribute>& attributes)
+    {
+        if (name == "location" && in_error_)
+        {
+            CppcheckLocation location;
+            for (const auto& attribute : attributes)
+            {
+                if (attribute.name == "file") location.file = intern(attribute.value);
+                else if (attribute.name == "line") location.line = number(attribute.value);
+                else if (attribute.name == "column") location.column = number(attribute.value);
+                else if (attribute.name == "info") location.info = intern(attribute.value);
+            }
+            locations_.push_back(location);
+            ++current_.location_count;
+        }
+        else if (name == "error")
+        {
+            current_ = CppcheckFinding();
+            current_.first_location = static_cast<std::uint32_t>(locations_.size());
+            for (const auto& attribute : attributes)
+            {
+                if (attribute.name == "id") current_.id = intern(attribute.value);
+                else if (attribute.name == "severity") current_.severity = intern(attribute.value);
+                else if (attribute.name == "msg") current_.msg = intern(attribute.value);
+                else if (attribute.name == "verbose") current_.verbose = intern(attribute.value);
+                else if (attribute.name == "file0") current_.file0 = intern(attribute.value);
+                else if (attribute.name == "cwe") current_.cwe = number(attribute.value);
+                else if (attribute.name == "inconclusive") current_.inconclusive = attribute.value == "true";
+            }
+            in_error_ = true;
+        }
+        else if (name == "results" || name == "cppcheck")
+        {
+            for (const auto& attribute : attributes)
+            {
+                if (attribute.name == "version")
+                {
+                    (name == "results" ? format_version_ : cppcheck_version_) = intern(attribute.value);
+                }
+            }
+        }
+    }
+
+    void end_element(std::string_view name)
+    {
+        if (name == "error" && in_error_)
+        {
+            const auto finding = static_cast<std::uint32_t>(findings_.size());
+            findings_.push_back(current_);
+            by_id_[current_.id].push_back(finding);
+            by_severity_[current_.severity].push_back(finding);
+            if (current_.cwe != 0)
+            {
+                by_cwe_[current_.cwe].push_back(finding);
+            }
+            in_error_ = false;
+        }
+    }
+
+private:
+    struct LineEntry
+    {
+        std::uint32_t file;
+        std::uint32_t line;
+        std::uint32_t finding;
+
+        bool operator<(const LineEntry& other) const noexcept
+        {
+            if (file != other.file) return file < other.file;
+            if (line != other.line) return line < other.line;
+            return finding < other.finding;
+        }
+    };
+
+    using Postings = std::unordered_map<std::uint32_t, std::vector<std::uint32_t>>;
+
+    static const std::vector<std::uint32_t>& postings(const Postings& map, std::uint32_t key)
+    {
+        static const std::vector<std::uint32_t> none;
+        const auto found = map.find(key);
+        return found == map.end() ? none : found->second;
+    }
+
+    std::uint32_t intern(std::string_view raw)
+    {
+        // consecutive attributes often repeat, such as msg and verbose or file0 and the first
+        // location's file, so remember the last one and skip decoding and hashing it again
+        if (raw == last_raw_)
+        {
+            return last_id_;
+        }
+        last_raw_.assign(raw.data(), raw.size());
+        last_id_ = strings_.intern(decode_xml_text(raw, scratch_));
+        return last_id_;
+    }
+
+    static std::uint32_t number(std::string_view text) noexcept
+    {
+        std::uint32_t value = 0;
+        std::from_chars(text.data(), text.data() + text.size(), value);
+        return value;
+    }
+
+    // sort every location into file/line order once the whole report is in
+    void finish()
+    {
+        by_line_.clear();
+        by_line_.reserve(locations_.size());
+        for (std::uint32_t finding = 0; finding < findings_.size(); ++finding)
+        {
+            for (const auto& location : locations(findings_[finding]))
+            {
+                by_line_.push_back({ location.file, location.line, finding });
+            }
+        }
+        std::sort(by_line_.begin(), by_line_.end());
+    }
+
+    StringPool strings_;
+    std::vector<CppcheckFinding> findings_;
+    std::vector<CppcheckLocation> locations_;
+    Postings by_id_;
+    Postings by_severity_;
+    Postings by_cwe_;
+    std::vector<LineEntry> by_line_;
+    std::uint32_t format_version_ = 0;
+    std::uint32_t cppcheck_version_ = 0;
+
+    // parser state
+    CppcheckFinding current_;
+    bool in_error_ = false;
+    std::string scratch_;
+    std::string last_raw_;
+    std::uint32_t last_id_ = 0;
+};
@@ -0,0 +1,167 @@
+// CppcheckReportGenerator.h : Synthetic cppcheck reports for the report benchmarks.
+//
+// Reports use the checks, severities and CWEs of 5-3 Static Testing.xml spread over a few thousand
+// source files, always from the same seed, so two runs with the same options produce identical files.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+#include "Random.h"
+
+struct SyntheticCheck
+{
+    const char* id;
+    const char* severity;
+    int cwe;
+    const char* message;
+};
+
+// the checks from 5-3 Static Testing.xml, %s is replaced by a variable name
+inline const SyntheticCheck synthetic_checks[] = {
+    { "throwInNoexceptFunction", "error", 398, "Exception thrown in function declared not to throw exceptions." },
+    { "autoVariables", "error", 562, "Address of local auto-variable assigned to a function parameter." },
+    { "invalidContainer", "error", 664, "Using iterator to local container &amp;#039;%s&amp;#039; that may be invalid." },
+    { "functionStatic", "performance", 398, "Technically the member function &amp;#039;%s::get&amp;#039; can be static." },
+    { "variableScope", "style", 398, "The scope of the variable &amp;#039;%s&amp;#039; can be reduced." },
+    { "unreadVariable", "style", 563, "Variable &amp;#039;%s&amp;#039; is assigned a value that is never used." },
+    { "returnNonBoolInBooleanFunction", "style", 0, "Non-boolean value returned from function returning bool" },
+    { "shadowVariable", "style", 398, "Local variable &amp;#039;%s&amp;#039; shadows outer variable" },
+    { "uninitMemberVarPrivate", "warning", 398, "Member variable &amp;#039;A::%s&amp;#039; is not initialized in the constructor." },
+    { "arrayIndexOutOfBoundsCond", "warning", 788, "Either the condition &amp;#039;count==1000&amp;#039; is redundant or the array &amp;#039;%s[10]&amp;#039; is accessed at index 1000, which is out of bounds." },
+    { "uselessAssignmentPtrArg", "warning", 398, "Assignment of function parameter has no effect outside the function. Did you forget dereferencing it?" },
+    { "nullPointerRedundantCheck", "warning", 476, "Either the condition &amp;#039;%s&amp;#039; is redundant or there is possible null pointer dereference: %s." },
+    { "assignmentInAssert", "warning", 398, "Assert statement modifies &amp;#039;%s&amp;#039;." },
+    { "assertWithSideEffect", "warning", 398, "Assert statement calls a function which may have desired side effects: &amp;#039;%s&amp;#039;." },
+};
+
+constexpr std::uint32_t synthetic_file_count = 4000;
+constexpr std::uint32_t synthetic_variable_count = 64;
+
+inline std::string synthetic_file_name(std::uint32_t file)
+{
+    return "src/module_" + std::to_string(file % 97) + "/file_" + std::to_string(file) + ".cpp";
+}
+
+/// <summary>
+/// How a generated report differs from the baseline with the same size
+/// </summary>
+struct SyntheticReportChanges
+{
+    // added to every line number, as if code had been inserted at the top of every file
+    std::uint32_t line_shift = 0;
+    // findings per thousand that name a different variable, so they count as fixed plus new
+    std::uint32_t changed_permille = 0;
+};
+
+/// <summary>
+/// Write a report of at least megabytes MiB. Returns false if the file cannot be written.
+/// </summary>
+inline bool generate_cppcheck_report(const std::string& path, std::size_t megabytes, SyntheticReportChanges changes = {})
+{
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    const auto expand = [](const char* message, const std::string& variable) {
+        std::string text;
+        for (const char* c = message; *c != '\0'; ++c)
+        {
+            if (c[0] == '%' && c[1] == 's')
+            {
+                text += variable;
+                ++c;
+            }
+            else
+            {
+                text += *c;
+            }
+        }
+        return text;
+    };
+
+    Xoshiro256 random(405);
+    const std::size_t target = megabytes << 20;
+    std::size_t written = 0;
+    std::string block = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<results version=\"2\">\n    <cppcheck version=\"2.7\"/>\n    <errors>\n";
+
+    while (written + block.size() < target)
+    {
+        // every draw happens whatever the changes are, so the baseline and a changed report line up
+        const SyntheticCheck& check = synthetic_checks[random.next_below(sizeof(synthetic_checks) / sizeof(synthetic_checks[0]))];
+        const std::string file_name = synthetic_file_name(random.next_below(synthetic_file_count));
+        std::uint32_t variable = random.next_below(synthetic_variable_count);
+        if (random.next_below(1000) < changes.changed_permille)
+        {
+            variable += synthetic_variable_count;
+        }
+        const std::string message = expand(check.message, "var" + std::to_string(variable));
+
+        block += "        <error id=\"";
+        block += check.id;
+        block += "\" severity=\"";
+        block += check.severity;
+        block += "\" msg=\"" + message + "\" verbose=\"" + message + "\"";
+        if (check.cwe != 0)
+        {
+            block += " cwe=\"" + std::to_string(check.cwe) + "\"";
+        }
+        block += " file0=\"" + file_name + "\">\n";
+
+        const std::uint32_t locations = 1 + random.next_below(3);
+        std::uint32_t line = 1 + random.next_below(5000);
+        for (std::uint32_t i = 0; i < locations; ++i)
+        {
+            block += "            <location file=\"" + file_name + "\" line=\"" + std::to_string(line + changes.line_shift) + "\" column=\""
+                + std::to_string(1 + random.next_below(80)) + "\"";
+            block += i == 0 ? "/>\n" : " info=\"Assuming condition is true.\"/>\n";
+            line = line > 10 ? line - random.next_below(10) : line;
+        }
+        block += "        </error>\n";
+
+        if (block.size() >= (1 << 20))
+        {
+            std::fwrite(block.data(), 1, block.size(), file);
+            written += block.size();
+            block.clear();
+        }
+    }
+
+    block += "    </errors>\n</results>\n";
+    std::fwrite(block.data(), 1, block.size(), file);
+    return std::fclose(file) == 0;
+}
+
+/// <summary>
+/// The path of a cached synthetic report in the temp directory, generated on first use.
+/// Exits if it cannot be written.
+/// </summary>
+inline std::string synthetic_cppcheck_report(std::size_t megabytes, SyntheticReportChanges changes = {})
+{
+    std::string name = "synthetic_cppcheck_" + std::to_string(megabytes) + "mb";
+    if (changes.line_shift != 0 || changes.changed_permille != 0)
+    {
+        name += "_shift" + std::to_string(changes.line_shift) + "_changed" + std::to_string(changes.changed_permille);
+    }
+    const std::string path = (std::filesystem::temp_directory_path() / (name + ".xml")).string();
+
+    std::error_code error;
+    if (std::filesystem::file_size(path, error) < (megabytes << 20) || error)
+    {
+        std::fprintf(stderr, "Generating %zu MiB report %s\n", megabytes, path.c_str());
+        if (!generate_cppcheck_report(path, megabytes, changes))
+        {
+            std::perror(path.c_str());
+            std::exit(1);
+        }
+    }
+    return path;
+}
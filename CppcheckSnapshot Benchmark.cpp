@@ -0,0 +1,108 @@
+// CppcheckSnapshot Benchmark.cpp : Snapshot writing, opening and diffing against a large baseline.
+//
+// The baseline is a synthetic report from CppcheckReportGenerator.h, --report_mb=512 by default (about
+// a million findings). The new report is the same code with every line shifted by 3 and 1% of the
+// findings changed. Both reports are parsed once up front; only the snapshot work is timed.
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "BenchmarkMain.h"
+#include "CppcheckReport.h"
+#include "CppcheckReportGenerator.h"
+#include "CppcheckSnapshot.h"
+
+namespace
+{
+    std::string snapshot_path;
+    const CppcheckIndex* baseline = nullptr;
+    const CppcheckIndex* current = nullptr;
+
+    void BM_WriteSnapshot(benchmark::State& state)
+    {
+        const std::string path = snapshot_path + ".write";
+        for (auto _ : state)
+        {
+            write_cppcheck_snapshot(path, *baseline);
+        }
+        std::filesystem::remove(path);
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * baseline->size()));
+    }
+
+    void BM_OpenSnapshot(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            const CppcheckSnapshot snapshot = CppcheckSnapshot::open(snapshot_path);
+            benchmark::DoNotOptimize(snapshot.size());
+        }
+    }
+
+    void BM_FingerprintReport(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(fingerprint_report(*current).data());
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * current->size()));
+    }
+
+    // the merge alone, with the new report already fingerprinted
+    void BM_DiffFingerprints(benchmark::State& state)
+    {
+        const CppcheckSnapshot snapshot = CppcheckSnapshot::open(snapshot_path);
+        const auto fingerprints = fingerprint_report(*current);
+        CppcheckDiff changes;
+        for (auto _ : state)
+        {
+            changes = diff_cppcheck_snapshot(snapshot, fingerprints);
+            benchmark::DoNotOptimize(changes.unchanged.data());
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * snapshot.size()));
+        state.counters["new"] = static_cast<double>(changes.added.size());
+        state.counters["fixed"] = static_cast<double>(changes.fixed.size());
+        state.counters["unchanged"] = static_cast<double>(changes.unchanged.size());
+    }
+
+    // everything the diff tool does after parsing the new report
+    void BM_OpenFingerprintAndDiff(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            const CppcheckSnapshot snapshot = CppcheckSnapshot::open(snapshot_path);
+            const CppcheckDiff changes = diff_cppcheck_snapshot(snapshot, fingerprint_report(*current));
+            benchmark::DoNotOptimize(changes.unchanged.data());
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * current->size()));
+    }
+
+    BENCHMARK(BM_WriteSnapshot)->Unit(benchmark::kMillisecond)->UseRealTime();
+    BENCHMARK(BM_OpenSnapshot)->Unit(benchmark::kMicrosecond);
+    BENCHMARK(BM_FingerprintReport)->Unit(benchmark::kMillisecond);
+    BENCHMARK(BM_DiffFingerprints)->Unit(benchmark::kMillisecond);
+    BENCHMARK(BM_OpenFingerprintAndDiff)->Unit(benchmark::kMillisecond);
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t report_mb = take_benchmark_option(argc, argv, "report_mb", std::size_t(512));
+
+    SyntheticReportChanges changes;
+    changes.line_shift = 3;
+    changes.changed_permille = 10;
+
+    std::fprintf(stderr, "Indexing the baseline and the new report\n");
+    const CppcheckIndex baseline_index = CppcheckIndex::load(synthetic_cppcheck_report(report_mb));
+    const CppcheckIndex current_index = CppcheckIndex::load(synthetic_cppcheck_report(report_mb, changes));
+    baseline = &baseline_index;
+    current = &current_index;
+
+    snapshot_path = (std::filesystem::temp_directory_path() / ("synthetic_cppcheck_" + std::to_string(report_mb) + "mb.snapshot")).string();
+    write_cppcheck_snapshot(snapshot_path, baseline_index);
+
+    const int result = run_benchmarks(argc, argv);
+    std::filesystem::remove(snapshot_path);
+    return result;
+}
@@ -0,0 +1,452 @@
+// CppcheckSnapshot.h : Compact snapshots of cppcheck findings and diffs of a new report against them.
+//
+// A finding's fingerprint covers its check id, its files, its message and the info text of its trace,
+// but no line or column numbers, so code moving up or down does not make a finding new. Snapshots are
+// a flat native-endian file of fingerprint-sorted records plus a string table, with the byte order
+// recorded in the header; opening one maps it into memory without parsing anything, and a diff is one
+// merge of two sorted sequences. Writing goes to a temporary file that is renamed over the old one, so
+// an interrupted update never leaves a truncated baseline behind.
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "CppcheckReport.h"
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/// <summary>
+/// One finding as stored in a snapshot. Strings are indexes into the snapshot's string table.
+/// </summary>
+struct SnapshotRecord
+{
+    std::uint64_t fingerprint;
+    std::uint32_t id;
+    std::uint32_t severity;
+    std::uint32_t file;
+    std::uint32_t line;
+    std::uint32_t msg;
+    std::uint32_t cwe;
+};
+
+static_assert(sizeof(SnapshotRecord) == 32, "snapshot records are written to disk as is");
+
+/// <summary>
+/// The first bytes of a snapshot file. Every field is in the byte order of the machine that
+/// wrote it, which byte_order records. Offsets are from the start of the file.
+/// </summary>
+struct SnapshotHeader
+{
+    char magic[8];
+    // snapshot_byte_order as written, so a reader with the other byte order sees it swapped
+    std::uint32_t byte_order;
+    std::uint32_t version;
+    std::uint32_t record_size;
+    std::uint32_t reserved;
+    std::uint64_t record_count;
+    std::uint64_t records_offset;
+    std::uint64_t string_count;
+    // string_count + 1 offsets into the string data, the last one being its size
+    std::uint64_t string_offsets_offset;
+    std::uint64_t string_data_offset;
+    std::uint64_t string_data_size;
+};
+
+static_assert(sizeof(SnapshotHeader) == 72, "the snapshot header is written to disk as is");
+
+constexpr char snapshot_magic[8] = { 'C', 'P', 'P', 'C', 'H', 'K', 'S', 'N' };
+constexpr std::uint32_t snapshot_byte_order = 0x01020304;
+constexpr std::uint32_t snapshot_version = 2;
+
+namespace snapshot_detail
+{
+    // FNV-1a, spelled out so fingerprints are the same on every platform and in every build.
+    // Runs of whitespace count as one space, so re-wrapped messages keep their fingerprint.
+    inline std::uint64_t hash_normalized(std::string_view text) noexcept
+    {
+        std::uint64_t hash = 0xcbf29ce484222325ull;
+        bool in_space = false;
+        for (const char c : text)
+        {
+            const bool space = c == ' ' || c == '\t' || c == '\n' || c == '\r';
+            if (space)
+            {
+                in_space = true;
+                continue;
+            }
+            if (in_space)
+            {
+                hash = (hash ^ static_cast<unsigned char>(' ')) * 0x100000001b3ull;
+                in_space = false;
+            }
+            hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    inline std::uint32_t primary_line(const CppcheckIndex& index, const CppcheckFinding& finding) noexcept
+    {
+        const auto locations = index.locations(finding);
+        return locations.empty() ? 0 : locations.begin()->line;
+    }
+
+    inline std::uint32_t primary_file(const CppcheckIndex& index, const CppcheckFinding& finding) noexcept
+    {
+        const auto locations = index.locations(finding);
+        return locations.empty() ? finding.file0 : locations.begin()->file;
+    }
+
+    // push what has been written to file out to the disk, so a rename never exposes missing data
+    inline bool sync(std::FILE* file) noexcept
+    {
+        if (std::fflush(file) != 0)
+        {
+            return false;
+        }
+#ifdef _WIN32
+        return _commit(_fileno(file)) == 0;
+#else
+        return ::fsync(fileno(file)) == 0;
+#endif
+    }
+
+    // atomically put temporary in place of filename, whether or not filename exists
+    inline bool replace_file(const std::string& temporary, const std::string& filename) noexcept
+    {
+#ifdef _WIN32
+        return MoveFileExA(temporary.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        return std::rename(temporary.c_str(), filename.c_str()) == 0;
+#endif
+    }
+}
+
+/// <summary>
+/// Computes the identity of a finding that survives line shifts: check id, primary file, message,
+/// and the file and info text of every location in its trace. Each interned string of the index
+/// is hashed once and findings only combine those hashes, so fingerprinting a million findings
+/// does not rehash the same few thousand messages a million times.
+/// </summary>
+class FindingFingerprinter
+{
+public:
+    explicit FindingFingerprinter(const CppcheckIndex& index)
+        : index_(index), hashes_(index.strings().size()), hashed_(index.strings().size(), false)
+    {
+    }
+
+    std::uint64_t operator()(const CppcheckFinding& finding)
+    {
+        std::uint64_t hash = 0;
+        combine(hash, finding.id);
+        combine(hash, snapshot_detail::primary_file(index_, finding));
+        combine(hash, finding.msg);
+        for (const auto& location : index_.locations(finding))
+        {
+            combine(hash, location.file);
+            combine(hash, location.info);
+        }
+        return hash;
+    }
+
+private:
+    void combine(std::uint64_t& hash, std::uint32_t string) noexcept
+    {
+        if (!hashed_[string])
+        {
+            hashes_[string] = snapshot_detail::hash_normalized(index_.text(string));
+            hashed_[string] = true;
+        }
+        // rotating first makes the order of the strings matter
+        hash = ((hash << 5) | (hash >> 59)) ^ hashes_[string];
+        hash *= 0x9e3779b97f4a7c15ull;
+    }
+
+    const CppcheckIndex& index_;
+    std::vector<std::uint64_t> hashes_;
+    std::vector<bool> hashed_;
+};
+
+/// <summary>
+/// A finding of the new report, by its position in the index
+/// </summary>
+struct CurrentFingerprint
+{
+    std::uint64_t fingerprint;
+    std::uint32_t line;
+    std::uint32_t finding;
+};
+
+/// <summary>
+/// Fingerprints of every finding in index, sorted the way snapshot records are
+/// </summary>
+inline std::vector<CurrentFingerprint> fingerprint_report(const CppcheckIndex& index)
+{
+    FindingFingerprinter fingerprint(index);
+    std::vector<CurrentFingerprint> fingerprints(index.size());
+    for (std::uint32_t finding = 0; finding < index.size(); ++finding)
+    {
+        fingerprints[finding] = { fingerprint(index[finding]), snapshot_detail::primary_line(index, index[finding]), finding };
+    }
+    std::sort(fingerprints.begin(), fingerprints.end(), [](const CurrentFingerprint& left, const CurrentFingerprint& right) {
+        return left.fingerprint != right.fingerprint ? left.fingerprint < right.fingerprint : left.line < right.line;
+    });
+    return fingerprints;
+}
+
+/// <summary>
+/// A snapshot file mapped into memory. Opening validates the layout but reads no records.
+/// </summary>
+class CppcheckSnapshot
+{
+public:
+    /// <summary>
+    /// Map a snapshot. Throws std::runtime_error if it cannot be read or is not a valid snapshot.
+    /// </summary>
+    static CppcheckSnapshot open(const std::string& filename)
+    {
+        CppcheckSnapshot snapshot;
+        snapshot.file_ = MappedFile(filename);
+
+        const char* data = snapshot.file_.data();
+        const std::uint64_t size = snapshot.file_.size();
+        if (size < sizeof(SnapshotHeader))
+        {
+            throw std::runtime_error(filename + " is not a cppcheck snapshot");
+        }
+        std::memcpy(&snapshot.header_, data, sizeof(SnapshotHeader));
+        const SnapshotHeader& header = snapshot.header_;
+        if (std::memcmp(header.magic, snapshot_magic, sizeof(snapshot_magic)) != 0)
+        {
+            throw std::runtime_error(filename + " is not a cppcheck snapshot");
+        }
+        if (header.byte_order != snapshot_byte_order)
+        {
+            throw std::runtime_error(filename + " is a snapshot written with a different byte order");
+        }
+        if (header.version != snapshot_version || header.record_size != sizeof(SnapshotRecord))
+        {
+            throw std::runtime_error(filename + " is a snapshot in an unsupported format, version " + std::to_string(header.version));
+        }
+
+        // every section must lie inside the file and be aligned for direct access
+        const auto fits = [size](std::uint64_t offset, std::uint64_t count, std::uint64_t element) {
+            return offset % 8 == 0 && offset <= size && count <= (size - offset) / element;
+        };
+        if (header.string_count >= size || !fits(header.records_offset, header.record_count, sizeof(SnapshotRecord)) || !fits(header.string_offsets_offset, header.string_count + 1, sizeof(std::uint64_t))
+            || header.string_data_offset > size || header.string_data_size > size - header.string_data_offset)
+        {
+            throw std::runtime_error(filename + " is truncated or corrupt");
+        }
+
+        snapshot.records_ = reinterpret_cast<const SnapshotRecord*>(data + header.records_offset);
+        snapshot.string_offsets_ = reinterpret_cast<const std::uint64_t*>(data + header.string_offsets_offset);
+        snapshot.string_data_ = data + header.string_data_offset;
+
+        if (snapshot.string_offsets_[header.string_count] != header.string_data_size)
+        {
+            throw std::runtime_error(filename + " is truncated or corrupt");
+        }
+        return snapshot;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return static_cast<std::size_t>(header_.record_count);
+    }
+
+    const SnapshotRecord& operator[](std::size_t record) const noexcept
+    {
+        return records_[record];
+    }
+
+    const SnapshotRecord* begin() const noexcept
+    {
+        return records_;
+    }
+
+    const SnapshotRecord* end() const noexcept
+    {
+        return records_ + size();
+    }
+
+    /// <summary>
+    /// A string from the table, or an empty string for an index that is out of range
+    /// </summary>
+    std::string_view text(std::uint32_t string) const noexcept
+    {
+        if (string >= header_.string_count)
+        {
+            return std::string_view();
+        }
+        const std::uint64_t first = string_offsets_[string];
+        const std::uint64_t last = string_offsets_[string + 1];
+        if (first > last || last > header_.string_data_size)
+        {
+            return std::string_view();
+        }
+        return std::string_view(string_data_ + first, static_cast<std::size_t>(last - first));
+    }
+
+private:
+    CppcheckSnapshot() = default;
+
+    MappedFile file_;
+    SnapshotHeader header_{};
+    const SnapshotRecord* records_ = nullptr;
+    const std::uint64_t* string_offsets_ = nullptr;
+    const char* string_data_ = nullptr;
+};
+
+/// <summary>
+/// Write every finding of index to a snapshot file. The file is replaced in one step, so readers and
+/// interrupted writes only ever see the old snapshot or the complete new one. Throws
+/// std::runtime_error if it cannot be written.
+/// </summary>
+inline void write_cppcheck_snapshot(const std::string& filename, const CppcheckIndex& index)
+{
+    // only the strings records use go into the table
+    StringPool strings;
+    FindingFingerprinter fingerprint(index);
+    std::vector<SnapshotRecord> records(index.size());
+    for (std::uint32_t number = 0; number < index.size(); ++number)
+    {
+        const CppcheckFinding& finding = index[number];
+        SnapshotRecord& record = records[number];
+        record.fingerprint = fingerprint(finding);
+        record.id = strings.intern(index.text(finding.id));
+        record.severity = strings.intern(index.text(finding.severity));
+        record.file = strings.intern(index.text(snapshot_detail::primary_file(index, finding)));
+        record.line = snapshot_detail::primary_line(index, finding);
+        record.msg = strings.intern(index.text(finding.msg));
+        record.cwe = finding.cwe;
+    }
+    std::sort(records.begin(), records.end(), [](const SnapshotRecord& left, const SnapshotRecord& right) {
+        return left.fingerprint != right.fingerprint ? left.fingerprint < right.fingerprint : left.line < right.line;
+    });
+
+    std::vector<std::uint64_t> string_offsets;
+    string_offsets.reserve(strings.size() + 1);
+    std::uint64_t string_data_size = 0;
+    for (std::uint32_t string = 0; string < strings.size(); ++string)
+    {
+        string_offsets.push_back(string_data_size);
+        string_data_size += strings[string].size();
+    }
+    string_offsets.push_back(string_data_size);
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, snapshot_magic, sizeof(snapshot_magic));
+    header.byte_order = snapshot_byte_order;
+    header.version = snapshot_version;
+    header.record_size = sizeof(SnapshotRecord);
+    header.record_count = records.size();
+    header.records_offset = sizeof(SnapshotHeader);
+    header.string_count = strings.size();
+    header.string_offsets_offset = header.records_offset + records.size() * sizeof(SnapshotRecord);
+    header.string_data_offset = header.string_offsets_offset + string_offsets.size() * sizeof(std::uint64_t);
+    header.string_data_size = string_data_size;
+
+    // in the same directory as filename, so the rename stays on one file system
+    const std::string temporary = filename + "." + std::to_string(std::random_device()()) + ".tmp";
+    std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(std::fopen(temporary.c_str(), "wb"), &std::fclose);
+    if (!file)
+    {
+        throw std::runtime_error("Unable to create " + temporary + ": " + std::strerror(errno));
+    }
+
+    bool written = std::fwrite(&header, sizeof(header), 1, file.get()) == 1;
+    written = written && std::fwrite(records.data(), sizeof(SnapshotRecord), records.size(), file.get()) == records.size();
+    written = written && std::fwrite(string_offsets.data(), sizeof(std::uint64_t), string_offsets.size(), file.get()) == string_offsets.size();
+    for (std::uint32_t string = 0; written && string < strings.size(); ++string)
+    {
+        const std::string_view text = strings[string];
+        written = std::fwrite(text.data(), 1, text.size(), file.get()) == text.size();
+    }
+    written = written && snapshot_detail::sync(file.get());
+    if (!written || std::fclose(file.release()) != 0)
+    {
+        file.reset();
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Unable to write " + temporary);
+    }
+    if (!snapshot_detail::replace_file(temporary, filename))
+    {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Unable to replace " + filename);
+    }
+}
+
+/// <summary>
+/// How a new report differs from a snapshot
+/// </summary>
+struct CppcheckDiff
+{
+    // findings of the new report with no match in the snapshot
+    std::vector<std::uint32_t> added;
+    // snapshot records with no match in the new report
+    std::vector<std::uint32_t> fixed;
+    // matched pairs of snapshot record and new finding, possibly on different lines
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> unchanged;
+};
+
+/// <summary>
+/// Match the sorted fingerprints of a new report against the snapshot's records. When the same
+/// fingerprint occurs several times, occurrences are paired in line order and any extra ones are
+/// added or fixed.
+/// </summary>
+inline CppcheckDiff diff_cppcheck_snapshot(const CppcheckSnapshot& snapshot, const std::vector<CurrentFingerprint>& current)
+{
+    CppcheckDiff diff;
+    diff.unchanged.reserve(std::min(snapshot.size(), current.size()));
+
+    std::size_t old_position = 0;
+    std::size_t new_position = 0;
+    while (old_position < snapshot.size() && new_position < current.size())
+    {
+        const std::uint64_t old_fingerprint = snapshot[old_position].fingerprint;
+        const std::uint64_t new_fingerprint = current[new_position].fingerprint;
+        if (old_fingerprint < new_fingerprint)
+        {
+            diff.fixed.push_back(static_cast<std::uint32_t>(old_position++));
+        }
+        else if (new_fingerprint < old_fingerprint)
+        {
+            diff.added.push_back(current[new_position++].finding);
+        }
+        else
+        {
+            diff.unchanged.emplace_back(static_cast<std::uint32_t>(old_position++), current[new_position++].finding);
+        }
+    }
+    for (; old_position < snapshot.size(); ++old_position)
+    {
+        diff.fixed.push_back(static_cast<std::uint32_t>(old_position));
+    }
+    for (; new_position < current.size(); ++new_position)
+    {
+        diff.added.push_back(current[new_position].finding);
+    }
+    return diff;
+}
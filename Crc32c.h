@@ -0,0 +1,158 @@
+// Crc32c.h : CRC-32C (Castagnoli), with the SSE4.2 crc32 instruction and a portable slicing-by-8 fallback.
+//
+// CRC-32C is the checksum iSCSI, ext4 and SSE4.2 use. Values are the finished checksum, so an update
+// can be resumed from the value a previous call returned: crc32c_update(crc32c_update(0, a), b) is
+// the checksum of a followed by b.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CRC32C_SSE42 1
+#define CRC32C_SSE42_TARGET __attribute__((target("sse4.2")))
+#include <nmmintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define CRC32C_SSE42 1
+#define CRC32C_SSE42_TARGET
+#include <intrin.h>
+#include <nmmintrin.h>
+#endif
+
+/// <summary>
+/// The CRC-32C implementations, best last
+/// </summary>
+enum class Crc32cLevel
+{
+    portable,
+    sse42
+};
+
+namespace crc32c_detail
+{
+    // reflected Castagnoli polynomial
+    constexpr std::uint32_t polynomial = 0x82f63b78;
+
+    struct Tables
+    {
+        std::uint32_t slice[8][256];
+    };
+
+    constexpr Tables make_tables()
+    {
+        Tables tables{};
+        for (std::uint32_t n = 0; n < 256; ++n)
+        {
+            std::uint32_t crc = n;
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc >> 1) ^ ((crc & 1) ? polynomial : 0);
+            }
+            tables.slice[0][n] = crc;
+        }
+        for (std::uint32_t n = 0; n < 256; ++n)
+        {
+            for (int k = 1; k < 8; ++k)
+            {
+                const std::uint32_t previous = tables.slice[k - 1][n];
+                tables.slice[k][n] = (previous >> 8) ^ tables.slice[0][previous & 0xff];
+            }
+        }
+        return tables;
+    }
+
+    inline constexpr Tables tables = make_tables();
+
+    inline std::uint32_t update_portable(std::uint32_t crc, const std::uint8_t* data, std::size_t length)
+    {
+        const auto& slice = tables.slice;
+        for (; length >= 8; data += 8, length -= 8)
+        {
+            const std::uint32_t low = crc ^ (std::uint32_t(data[0]) | (std::uint32_t(data[1]) << 8) | (std::uint32_t(data[2]) << 16) | (std::uint32_t(data[3]) << 24));
+            const std::uint32_t high = std::uint32_t(data[4]) | (std::uint32_t(data[5]) << 8) | (std::uint32_t(data[6]) << 16) | (std::uint32_t(data[7]) << 24);
+            crc = slice[7][low & 0xff] ^ slice[6][(low >> 8) & 0xff] ^ slice[5][(low >> 16) & 0xff] ^ slice[4][low >> 24] ^ slice[3][high & 0xff]
+                ^ slice[2][(high >> 8) & 0xff] ^ slice[1][(high >> 16) & 0xff] ^ slice[0][high >> 24];
+        }
+        for (; length > 0; ++data, --length)
+        {
+            crc = (crc >> 8) ^ slice[0][(crc ^ *data) & 0xff];
+        }
+        return crc;
+    }
+
+#ifdef CRC32C_SSE42
+    CRC32C_SSE42_TARGET inline std::uint32_t update_sse42(std::uint32_t crc, const std::uint8_t* data, std::size_t length)
+    {
+#if defined(__x86_64__) || defined(_M_X64)
+        std::uint64_t crc64 = crc;
+        for (; length >= 8; data += 8, length -= 8)
+        {
+            std::uint64_t word;
+            std::memcpy(&word, data, sizeof(word));
+            crc64 = _mm_crc32_u64(crc64, word);
+        }
+        crc = static_cast<std::uint32_t>(crc64);
+#endif
+        for (; length >= 4; data += 4, length -= 4)
+        {
+            std::uint32_t word;
+            std::memcpy(&word, data, sizeof(word));
+            crc = _mm_crc32_u32(crc, word);
+        }
+        for (; length > 0; ++data, --length)
+        {
+            crc = _mm_crc32_u8(crc, *data);
+        }
+        return crc;
+    }
+#endif
+}
+
+/// <summary>
+/// The best CRC-32C implementation this CPU supports, detected once per process
+/// </summary>
+inline Crc32cLevel best_crc32c_level()
+{
+    static const Crc32cLevel level = []
+    {
+#if defined(CRC32C_SSE42) && defined(_MSC_VER)
+        int registers[4];
+        __cpuid(registers, 1);
+        if (registers[2] & (1 << 20))
+        {
+            return Crc32cLevel::sse42;
+        }
+#elif defined(CRC32C_SSE42)
+        if (__builtin_cpu_supports("sse4.2"))
+        {
+            return Crc32cLevel::sse42;
+        }
+#endif
+        return Crc32cLevel::portable;
+    }();
+
+    return level;
+}
+
+/// <summary>
+/// Extend a CRC-32C over more data
+/// </summary>
+/// <param name="crc">checksum of the data so far, 0 to start</param>
+/// <param name="data">next bytes</param>
+/// <param name="length">number of bytes</param>
+/// <param name="level">implementation to use, SSE4.2 falls back to portable when the CPU or compiler lacks it</param>
+/// <returns>checksum of the data so far followed by these bytes</returns>
+inline std::uint32_t crc32c_update(std::uint32_t crc, const void* data, std::size_t length, Crc32cLevel level = best_crc32c_level())
+{
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+#ifdef CRC32C_SSE42
+    if (level == Crc32cLevel::sse42 && best_crc32c_level() == Crc32cLevel::sse42)
+    {
+        return ~crc32c_detail::update_sse42(~crc, bytes, length);
+    }
+#endif
+    (void)level;
+    return ~crc32c_detail::update_portable(~crc, bytes, length);
+}
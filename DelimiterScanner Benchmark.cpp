@@ -0,0 +1,131 @@
+// DelimiterScanner Benchmark.cpp : Vectorized line splitting against memchr and getline.
+//
+// Usage: "DelimiterScanner Benchmark" [--corpus_mb=16] [benchmark flags]
+//   Every benchmark runs on a short line corpus (about 16 bytes a line) and a long line
+//   corpus (about 4 KiB a line), both held in memory.
+
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BenchmarkMain.h"
+#include "DelimiterScanner.h"
+
+namespace
+{
+    // lines over this are flagged, the same cap the bounded input reader uses
+    const std::size_t max_line_length = 19;
+
+    enum Corpus
+    {
+        short_lines = 0,
+        long_lines = 1
+    };
+
+    std::size_t corpus_bytes = 0;
+    std::string corpora[2];
+
+    std::string make_corpus(std::size_t target_bytes, int mean_length)
+    {
+        std::mt19937 engine(405);
+        std::uniform_int_distribution<int> length(1, mean_length * 2);
+        std::string corpus;
+        corpus.reserve(target_bytes + mean_length * 2 + 1);
+
+        while (corpus.length() < target_bytes)
+        {
+            corpus.append(length(engine), 'x');
+            corpus.push_back('\n');
+        }
+
+        return corpus;
+    }
+
+    void set_corpus_label(benchmark::State& state)
+    {
+        state.SetLabel(state.range(0) == short_lines ? "short lines" : "long lines");
+    }
+
+    void BM_ScanLines(benchmark::State& state, ScanLevel level)
+    {
+        const std::string& corpus = corpora[state.range(0)];
+        std::vector<LineSpan> lines;
+        lines.reserve(corpus.length() / 8);
+
+        for (auto _ : state)
+        {
+            lines.clear();
+            benchmark::DoNotOptimize(scan_lines(corpus.data(), corpus.length(), max_line_length, lines, '\n', level));
+            benchmark::ClobberMemory();
+        }
+
+        set_corpus_label(state);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * corpus.length()));
+    }
+    BENCHMARK_CAPTURE(BM_ScanLines, scalar, ScanLevel::scalar)->Arg(short_lines)->Arg(long_lines);
+#ifdef DELIMITER_SCANNER_SSE2
+    BENCHMARK_CAPTURE(BM_ScanLines, sse2, ScanLevel::sse2)->Arg(short_lines)->Arg(long_lines);
+#endif
+#ifdef DELIMITER_SCANNER_AVX2
+    BENCHMARK_CAPTURE(BM_ScanLines, avx2, ScanLevel::avx2)->Arg(short_lines)->Arg(long_lines);
+#endif
+
+    // one memchr call per line, which is what the reader did before the batch scan
+    void BM_MemchrPerLine(benchmark::State& state)
+    {
+        const std::string& corpus = corpora[state.range(0)];
+        std::vector<LineSpan> lines;
+        lines.reserve(corpus.length() / 8);
+
+        for (auto _ : state)
+        {
+            lines.clear();
+            const char* data = corpus.data();
+            const char* end = data + corpus.length();
+            const char* start = data;
+            while (const char* newline = static_cast<const char*>(std::memchr(start, '\n', end - start)))
+            {
+                const std::size_t length = static_cast<std::size_t>(newline - start);
+                lines.push_back(LineSpan{ static_cast<std::size_t>(start - data), length, length > max_line_length });
+                start = newline + 1;
+            }
+            benchmark::ClobberMemory();
+        }
+
+        set_corpus_label(state);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * corpus.length()));
+    }
+    BENCHMARK(BM_MemchrPerLine)->Arg(short_lines)->Arg(long_lines);
+
+    void BM_Getline(benchmark::State& state)
+    {
+        const std::string& corpus = corpora[state.range(0)];
+
+        for (auto _ : state)
+        {
+            std::istringstream stream(corpus);
+            std::string line;
+            std::size_t too_long = 0;
+            while (std::getline(stream, line))
+            {
+                too_long += line.length() > max_line_length;
+            }
+            benchmark::DoNotOptimize(too_long);
+        }
+
+        set_corpus_label(state);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * corpus.length()));
+    }
+    BENCHMARK(BM_Getline)->Arg(short_lines)->Arg(long_lines);
+}
+
+int main(int argc, char** argv)
+{
+    corpus_bytes = take_benchmark_option(argc, argv, "corpus_mb", std::size_t(16)) << 20;
+    corpora[short_lines] = make_corpus(corpus_bytes, 16);
+    corpora[long_lines] = make_corpus(corpus_bytes, 4096);
+
+    return run_benchmarks(argc, argv);
+}
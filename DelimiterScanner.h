@@ -0,0 +1,270 @@
+// DelimiterScanner.h : Vectorized newline / delimiter scanning shared by the line and header readers.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DELIMITER_SCANNER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(DELIMITER_SCANNER_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define DELIMITER_SCANNER_AVX2 1
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/// <summary>
+/// One line found by scan_lines. The delimiter itself is not included in the length.
+/// </summary>
+struct LineSpan
+{
+    std::size_t offset;
+    std::size_t length;
+    // set when length is over the cap passed to scan_lines
+    bool too_long;
+};
+
+/// <summary>
+/// The instruction sets the scanner can use, best last
+/// </summary>
+enum class ScanLevel
+{
+    scalar,
+    sse2,
+    avx2
+};
+
+namespace delimiter_scanner_detail
+{
+    inline unsigned count_trailing_zeros(std::uint64_t mask)
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanForward64(&index, mask);
+        return static_cast<unsigned>(index);
+#elif defined(_MSC_VER)
+        unsigned long index;
+        if (_BitScanForward(&index, static_cast<unsigned long>(mask)))
+        {
+            return static_cast<unsigned>(index);
+        }
+        _BitScanForward(&index, static_cast<unsigned long>(mask >> 32));
+        return static_cast<unsigned>(index) + 32;
+#else
+        return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+    }
+
+    // hand every set bit of a block mask to the callback as an absolute position
+    template <typename Emit>
+    inline void emit_mask(std::uint64_t mask, std::size_t base, Emit& emit)
+    {
+        while (mask != 0)
+        {
+            emit(base + count_trailing_zeros(mask));
+            mask &= mask - 1;
+        }
+    }
+
+    template <typename Emit>
+    inline void scan_scalar(const char* data, std::size_t begin, std::size_t length, char delimiter, Emit& emit)
+    {
+        for (std::size_t i = begin; i < length; ++i)
+        {
+            if (data[i] == delimiter)
+            {
+                emit(i);
+            }
+        }
+    }
+
+#ifdef DELIMITER_SCANNER_SSE2
+    template <typename Emit>
+    inline void scan_sse2(const char* data, std::size_t length, char delimiter, Emit& emit)
+    {
+        const __m128i needle = _mm_set1_epi8(delimiter);
+        std::size_t i = 0;
+
+        // four 16 byte blocks per iteration, folded into one 64 bit mask
+        for (; i + 64 <= length; i += 64)
+        {
+            std::uint64_t mask = 0;
+            for (int block = 0; block < 4; ++block)
+            {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + block * 16));
+                mask |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, needle)))) << (block * 16);
+            }
+            emit_mask(mask, i, emit);
+        }
+
+        for (; i + 16 <= length; i += 16)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            emit_mask(static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle))), i, emit);
+        }
+
+        scan_scalar(data, i, length, delimiter, emit);
+    }
+#endif
+
+#ifdef DELIMITER_SCANNER_AVX2
+    template <typename Emit>
+    __attribute__((target("avx2"))) inline void scan_avx2(const char* data, std::size_t length, char delimiter, Emit& emit)
+    {
+        const __m256i needle = _mm256_set1_epi8(delimiter);
+        std::size_t i = 0;
+
+        // two 32 byte blocks per iteration, folded into one 64 bit mask
+        for (; i + 64 <= length; i += 64)
+        {
+            const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+            const std::uint64_t mask =
+                static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, needle)))) |
+                (static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, needle)))) << 32);
+            emit_mask(mask, i, emit);
+        }
+
+        for (; i + 32 <= length; i += 32)
+        {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            emit_mask(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle))), i, emit);
+        }
+
+        scan_scalar(data, i, length, delimiter, emit);
+    }
+#endif
+
+    template <typename Emit>
+    inline void scan(const char* data, std::size_t length, char delimiter, ScanLevel level, Emit& emit)
+    {
+        switch (level)
+        {
+#ifdef DELIMITER_SCANNER_AVX2
+        case ScanLevel::avx2:
+            scan_avx2(data, length, delimiter, emit);
+            return;
+#endif
+#ifdef DELIMITER_SCANNER_SSE2
+        case ScanLevel::sse2:
+            scan_sse2(data, length, delimiter, emit);
+            return;
+#endif
+        default:
+            scan_scalar(data, 0, length, delimiter, emit);
+            return;
+        }
+    }
+}
+
+/// <summary>
+/// The best scan level this CPU supports, detected once per process
+/// </summary>
+inline ScanLevel best_scan_level()
+{
+    static const ScanLevel level = []
+    {
+#if defined(DELIMITER_SCANNER_AVX2)
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return ScanLevel::avx2;
+        }
+#endif
+#if defined(DELIMITER_SCANNER_SSE2)
+        return ScanLevel::sse2;
+#else
+        return ScanLevel::scalar;
+#endif
+    }();
+
+    return level;
+}
+
+/// <summary>
+/// Find the first delimiter in a buffer
+/// </summary>
+/// <returns>pointer to the delimiter, or nullptr if there is none</returns>
+inline const char* find_first_delimiter(const char* data, std::size_t length, char delimiter)
+{
+    // the C library's memchr is already vectorized and stops at the first hit
+    return static_cast<const char*>(std::memchr(data, delimiter, length));
+}
+
+/// <summary>
+/// Append the position of every delimiter in a buffer to positions, in one pass
+/// </summary>
+/// <param name="data">buffer to scan</param>
+/// <param name="length">number of bytes in the buffer</param>
+/// <param name="delimiter">byte to look for</param>
+/// <param name="positions">receives offsets relative to data</param>
+/// <param name="level">instruction set to use, defaults to the best available</param>
+/// <returns>the number of delimiters found</returns>
+inline std::size_t find_delimiters(const char* data, std::size_t length, char delimiter, std::vector<std::size_t>& positions, ScanLevel level = best_scan_level())
+{
+    const std::size_t before = positions.size();
+    auto emit = [&positions](std::size_t position) { positions.push_back(position); };
+    delimiter_scanner_detail::scan(data, length, delimiter, level, emit);
+    return positions.size() - before;
+}
+
+/// <summary>
+/// Fill a fixed size array with the positions of the delimiters at the start of a buffer, for
+/// callers that index a large buffer a window at a time instead of all at once. The buffer is
+/// scanned in slices of capacity bytes, stopping after the first slice that holds a delimiter.
+/// </summary>
+/// <param name="data">buffer to scan</param>
+/// <param name="length">number of bytes in the buffer</param>
+/// <param name="delimiter">byte to look for</param>
+/// <param name="positions">receives offsets relative to data</param>
+/// <param name="capacity">number of entries positions can hold</param>
+/// <param name="scanned">receives how many bytes were scanned, less than length if a delimiter was found first</param>
+/// <param name="level">instruction set to use, defaults to the best available</param>
+/// <returns>the number of delimiters found</returns>
+inline std::size_t find_delimiters(const char* data, std::size_t length, char delimiter, std::size_t* positions, std::size_t capacity, std::size_t& scanned, ScanLevel level = best_scan_level())
+{
+    std::size_t count = 0;
+    scanned = 0;
+    auto emit = [&](std::size_t position) { positions[count++] = scanned + position; };
+
+    // each byte is at most one delimiter, so a slice no longer than capacity cannot overflow
+    while (scanned < length && count == 0)
+    {
+        const std::size_t slice = std::min(length - scanned, capacity);
+        delimiter_scanner_detail::scan(data + scanned, slice, delimiter, level, emit);
+        scanned += slice;
+    }
+    return count;
+}
+
+/// <summary>
+/// Split a buffer into delimiter terminated lines in one pass, flagging the ones over max_length
+/// </summary>
+/// <param name="data">buffer to scan</param>
+/// <param name="length">number of bytes in the buffer</param>
+/// <param name="max_length">longest line that is not flagged as too long</param>
+/// <param name="lines">receives the terminated lines found</param>
+/// <param name="delimiter">line terminator, newline by default</param>
+/// <param name="level">instruction set to use, defaults to the best available</param>
+/// <returns>offset of the unterminated tail, which equals length if the buffer ends with a delimiter</returns>
+inline std::size_t scan_lines(const char* data, std::size_t length, std::size_t max_length, std::vector<LineSpan>& lines, char delimiter = '\n', ScanLevel level = best_scan_level())
+{
+    std::size_t line_start = 0;
+    auto emit = [&](std::size_t position)
+    {
+        const std::size_t line_length = position - line_start;
+        lines.push_back(LineSpan{ line_start, line_length, line_length > max_length });
+        line_start = position + 1;
+    };
+    delimiter_scanner_detail::scan(data, length, delimiter, level, emit);
+    return line_start;
+}
@@ -0,0 +1,356 @@
+// ErrorEventRing.h : Lock-free error event queue so exception handlers never block on std::cerr.
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <typeinfo>
+
+#if defined(__GNUG__)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+#include "Expected.h"
+#include "FixedString.h"
+
+/// <summary>
+/// How serious a reported error is: error for failures the program anticipates and handles,
+/// critical for anything that only reached a generic handler
+/// </summary>
+enum class ErrorSeverity
+{
+    error,
+    critical,
+};
+
+inline const char* severity_name(ErrorSeverity severity) noexcept
+{
+    return severity == ErrorSeverity::critical ? "critical" : "error";
+}
+
+/// <summary>
+/// One reported error. Everything is stored inline so pushing an event never allocates;
+/// the message is truncated to fit.
+/// </summary>
+struct ErrorEvent
+{
+    // exception type or error category name, always a string with static storage duration
+    const char* type = "";
+    // true when type is a mangled typeid name that should be demangled for display
+    bool mangled = false;
+    ErrorSeverity severity = ErrorSeverity::error;
+    FixedString<127> what;
+    std::chrono::system_clock::time_point timestamp;
+    std::thread::id thread_id;
+};
+
+/// <summary>
+/// Bounded multi-producer, single-consumer ring of error events. Every slot carries a
+/// sequence number that tells producers and the consumer whose turn it is, so pushes
+/// only ever contend on one atomic counter and never wait for each other. When the ring
+/// is full the event is dropped and counted instead of stalling the caller.
+/// </summary>
+class ErrorEventRing
+{
+public:
+    /// <summary>
+    /// Create a ring with room for capacity events, rounded up to a power of two
+    /// </summary>
+    explicit ErrorEventRing(std::size_t capacity)
+    {
+        std::size_t size = 2;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+
+        mask_ = size - 1;
+        slots_.reset(new Slot[size]);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /// <summary>
+    /// Add an event without blocking. Safe to call from any number of threads.
+    /// </summary>
+    /// <returns>false if the ring was full and the event was dropped</returns>
+    bool try_push(const ErrorEvent& event) noexcept
+    {
+        std::size_t position = enqueue_position_.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        for (;;)
+        {
+            slot = &slots_[position & mask_];
+            const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+            if (difference == 0)
+            { // the slot is free for this position, claim it
+                if (enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (difference < 0)
+            { // the consumer has not freed this slot yet, so the ring is full
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else
+            { // another producer got here first
+                position = enqueue_position_.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->event = event;
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// <summary>
+    /// Take the oldest event. Only one thread may call this.
+    /// </summary>
+    /// <returns>false if there is no completed event waiting</returns>
+    bool try_pop(ErrorEvent& event) noexcept
+    {
+        Slot& slot = slots_[dequeue_position_ & mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeue_position_ + 1)
+        {
+            return false;
+        }
+
+        event = slot.event;
+        slot.sequence.store(dequeue_position_ + mask_ + 1, std::memory_order_release);
+        ++dequeue_position_;
+        return true;
+    }
+
+    /// <summary>
+    /// Number of events dropped because the ring was full
+    /// </summary>
+    std::size_t dropped() const noexcept
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    std::size_t capacity() const noexcept
+    {
+        return mask_ + 1;
+    }
+
+private:
+    struct alignas(64) Slot
+    {
+        std::atomic<std::size_t> sequence;
+        ErrorEvent event;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t mask_ = 0;
+
+    // producers and the consumer each get their own cache line
+    alignas(64) std::atomic<std::size_t> enqueue_position_{ 0 };
+    alignas(64) std::size_t dequeue_position_ = 0;
+    alignas(64) std::atomic<std::size_t> dropped_{ 0 };
+};
+
+/// <summary>
+/// Collects error events from catch sites and writes them out in batches on a background
+/// thread, so a storm of errors never serializes threads on the output stream's lock.
+/// </summary>
+class ErrorReporter
+{
+public:
+    /// <summary>
+    /// Start the drainer thread
+    /// </summary>
+    /// <param name="out">stream the events are written to</param>
+    /// <param name="capacity">events that can be waiting before new ones are dropped</param>
+    /// <param name="interval">how long the drainer sleeps when the ring is empty</param>
+    explicit ErrorReporter(std::ostream& out, std::size_t capacity = 4096, std::chrono::milliseconds interval = std::chrono::milliseconds(5))
+        : out_(out), ring_(capacity), interval_(interval), drainer_([this] { drain_loop(); })
+    {
+    }
+
+    ErrorReporter(const ErrorReporter&) = delete;
+    ErrorReporter& operator=(const ErrorReporter&) = delete;
+
+    ~ErrorReporter()
+    {
+        running_.store(false, std::memory_order_release);
+        drainer_.join();
+    }
+
+    /// <summary>
+    /// Queue an exception caught by a handler
+    /// </summary>
+    void report(const std::exception& exception, ErrorSeverity severity = ErrorSeverity::error) noexcept
+    {
+        push(typeid(exception).name(), true, exception.what(), severity);
+    }
+
+    /// <summary>
+    /// Queue an error result from one of the non-throwing code paths
+    /// </summary>
+    void report(const Error& error, ErrorSeverity severity = ErrorSeverity::error) noexcept
+    {
+        push(error.category().name(), false, error.what(), severity);
+    }
+
+    /// <summary>
+    /// Queue an event that has no exception object, such as one caught by catch (...)
+    /// </summary>
+    void report(const char* type, std::string_view what, ErrorSeverity severity = ErrorSeverity::error) noexcept
+    {
+        push(type, false, what, severity);
+    }
+
+    /// <summary>
+    /// Wait until every event accepted so far has been written out
+    /// </summary>
+    void flush() const
+    {
+        const std::size_t target = accepted_.load(std::memory_order_acquire);
+        while (written_.load(std::memory_order_acquire) < target)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    /// <summary>
+    /// Number of events dropped because the ring was full
+    /// </summary>
+    std::size_t dropped() const noexcept
+    {
+        return ring_.dropped();
+    }
+
+private:
+    void push(const char* type, bool mangled, std::string_view what, ErrorSeverity severity) noexcept
+    {
+        ErrorEvent event;
+        event.type = type;
+        event.mangled = mangled;
+        event.severity = severity;
+        event.what.assign(what);
+        event.timestamp = std::chrono::system_clock::now();
+        event.thread_id = std::this_thread::get_id();
+
+        if (ring_.try_push(event))
+        {
+            accepted_.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    void drain_loop()
+    {
+        std::string batch;
+        ErrorEvent event;
+        std::size_t dropped_reported = 0;
+
+        for (;;)
+        {
+            // read the flag first so nothing pushed before shutdown is missed by the last pass
+            const bool running = running_.load(std::memory_order_acquire);
+
+            std::size_t count = 0;
+            batch.clear();
+            while (ring_.try_pop(event))
+            {
+                append_event(batch, event);
+                ++count;
+            }
+
+            const std::size_t dropped = ring_.dropped();
+            if (dropped != dropped_reported)
+            {
+                batch += "ErrorReporter: " + std::to_string(dropped - dropped_reported) + " error event(s) dropped\n";
+                dropped_reported = dropped;
+            }
+
+            if (!batch.empty())
+            {
+                out_.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+                out_.flush();
+                written_.fetch_add(count, std::memory_order_release);
+            }
+
+            if (!running)
+            {
+                return;
+            }
+            if (count == 0)
+            {
+                std::this_thread::sleep_for(interval_);
+            }
+        }
+    }
+
+    static void append_event(std::string& batch, const ErrorEvent& event)
+    {
+        const std::time_t seconds = std::chrono::system_clock::to_time_t(event.timestamp);
+        const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(event.timestamp.time_since_epoch()).count() % 1000;
+        std::tm utc{};
+#ifdef _WIN32
+        gmtime_s(&utc, &seconds);
+#else
+        gmtime_r(&seconds, &utc);
+#endif
+
+        std::ostringstream line;
+        line << std::put_time(&utc, "%Y-%m-%dT%H:%M:%S") << '.' << std::setw(3) << std::setfill('0') << milliseconds
+             << "Z " << severity_name(event.severity) << " [thread " << event.thread_id << "] " << display_type(event) << ": " << event.what << '\n';
+        batch += line.str();
+    }
+
+    static std::string display_type(const ErrorEvent& event)
+    {
+#if defined(__GNUG__)
+        if (event.mangled)
+        {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(event.type, nullptr, nullptr, &status);
+            if (status == 0 && demangled != nullptr)
+            {
+                std::string name(demangled);
+                std::free(demangled);
+                return name;
+            }
+        }
+#endif
+        return event.type;
+    }
+
+    std::ostream& out_;
+    ErrorEventRing ring_;
+    std::chrono::milliseconds interval_;
+    std::atomic<bool> running_{ true };
+    std::atomic<std::size_t> accepted_{ 0 };
+    std::atomic<std::size_t> written_{ 0 };
+    // declared last so everything it uses exists before the thread starts
+    std::thread drainer_;
+};
+
+/// <summary>
+/// The process wide reporter that writes to std::cerr
+/// </summary>
+inline ErrorReporter& error_reporter()
+{
+    static ErrorReporter reporter(std::cerr);
+    return reporter;
+}
@@ -0,0 +1,471 @@
+// ErrorHandling Tests.cpp : Tests for Expected, the error categories, the error event ring and the
+// background error reporter.
+//
+// Expected's assignments are driven with values whose copies and moves throw on demand, so every
+// path that could leave a half-assigned result is taken. The ring is checked with real producer
+// threads racing a consumer, so every event has to come out exactly once and in the order its
+// producer pushed it, however the pushes interleave.
+
+#include <chrono>
+#include <cstddef>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ErrorEventRing.h"
+#include "Exceptions.h"
+#include "Expected.h"
+
+namespace
+{
+    // event text naming its producer and its position in that producer's sequence
+    std::string event_text(std::size_t producer, std::size_t index)
+    {
+        return std::to_string(producer) + ":" + std::to_string(index);
+    }
+
+    bool parse_event_text(std::string_view text, std::size_t& producer, std::size_t& index)
+    {
+        const auto colon = text.find(':');
+        if (colon == std::string_view::npos)
+        {
+            return false;
+        }
+
+        producer = std::stoul(std::string(text.substr(0, colon)));
+        index = std::stoul(std::string(text.substr(colon + 1)));
+        return true;
+    }
+
+    ErrorEvent make_event(std::string_view what)
+    {
+        ErrorEvent event;
+        event.what.assign(what);
+        return event;
+    }
+
+    // a value whose copies and moves throw while the test has armed them, before changing anything
+    struct Fragile
+    {
+        static bool copies_throw;
+        static bool moves_throw;
+
+        int id;
+
+        explicit Fragile(int id) noexcept
+            : id(id)
+        {
+        }
+
+        Fragile(const Fragile& other)
+            : id(other.id)
+        {
+            if (copies_throw)
+            {
+                throw std::runtime_error("Fragile copy");
+            }
+        }
+
+        Fragile(Fragile&& other)
+            : id(other.id)
+        {
+            if (moves_throw)
+            {
+                throw std::runtime_error("Fragile move");
+            }
+        }
+
+        Fragile& operator=(const Fragile& other)
+        {
+            if (copies_throw)
+            {
+                throw std::runtime_error("Fragile copy");
+            }
+            id = other.id;
+            return *this;
+        }
+
+        Fragile& operator=(Fragile&& other)
+        {
+            if (moves_throw)
+            {
+                throw std::runtime_error("Fragile move");
+            }
+            id = other.id;
+            return *this;
+        }
+    };
+
+    bool Fragile::copies_throw = false;
+    bool Fragile::moves_throw = false;
+
+    inline constexpr ErrorCategory test_error_category{ "test error", &logic_error_category };
+
+    class ExpectedAssignmentTest : public ::testing::Test
+    {
+    protected:
+        void TearDown() override
+        {
+            Fragile::copies_throw = false;
+            Fragile::moves_throw = false;
+        }
+    };
+
+    std::size_t count_occurrences(const std::string& text, const std::string& needle)
+    {
+        std::size_t count = 0;
+        for (auto position = text.find(needle); position != std::string::npos; position = text.find(needle, position + needle.size()))
+        {
+            ++count;
+        }
+        return count;
+    }
+}
+
+TEST(ErrorEventRingTest, CapacityRoundsUpToAPowerOfTwo)
+{
+    EXPECT_EQ(ErrorEventRing(0).capacity(), 2u);
+    EXPECT_EQ(ErrorEventRing(5).capacity(), 8u);
+    EXPECT_EQ(ErrorEventRing(64).capacity(), 64u);
+}
+
+TEST(ErrorEventRingTest, PopsInPushOrder)
+{
+    ErrorEventRing ring(4);
+    ErrorEvent event;
+    EXPECT_FALSE(ring.try_pop(event));
+
+    // go round the ring several times so the slot sequence numbers wrap
+    for (std::size_t round = 0; round < 5; ++round)
+    {
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            ASSERT_TRUE(ring.try_push(make_event(event_text(round, i))));
+        }
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            ASSERT_TRUE(ring.try_pop(event));
+            EXPECT_EQ(std::string_view(event.what), event_text(round, i));
+        }
+        EXPECT_FALSE(ring.try_pop(event));
+    }
+    EXPECT_EQ(ring.dropped(), 0u);
+}
+
+TEST(ErrorEventRingTest, FullRingDropsAndCounts)
+{
+    ErrorEventRing ring(5);
+    ASSERT_EQ(ring.capacity(), 8u);
+
+    for (std::size_t i = 0; i < ring.capacity(); ++i)
+    {
+        ASSERT_TRUE(ring.try_push(make_event(event_text(0, i))));
+    }
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        EXPECT_FALSE(ring.try_push(make_event("dropped")));
+    }
+    EXPECT_EQ(ring.dropped(), 4u);
+
+    // freeing one slot makes room for exactly one more event
+    ErrorEvent event;
+    ASSERT_TRUE(ring.try_pop(event));
+    EXPECT_EQ(std::string_view(event.what), event_text(0, 0));
+    EXPECT_TRUE(ring.try_push(make_event(event_text(0, ring.capacity()))));
+    EXPECT_FALSE(ring.try_push(make_event("dropped")));
+    EXPECT_EQ(ring.dropped(), 5u);
+
+    // the dropped events never show up, the accepted ones all do in order
+    for (std::size_t i = 1; i <= ring.capacity(); ++i)
+    {
+        ASSERT_TRUE(ring.try_pop(event));
+        EXPECT_EQ(std::string_view(event.what), event_text(0, i));
+    }
+    EXPECT_FALSE(ring.try_pop(event));
+}
+
+TEST(ErrorEventRingTest, MultipleProducersLoseAndDuplicateNothing)
+{
+    constexpr std::size_t producers = 4;
+    constexpr std::size_t events_per_producer = 20000;
+
+    // a small ring keeps it full most of the time, so producers race for slots and hit drops
+    ErrorEventRing ring(16);
+
+    std::vector<std::thread> threads;
+    for (std::size_t producer = 0; producer < producers; ++producer)
+    {
+        threads.emplace_back([&ring, producer] {
+            for (std::size_t i = 0; i < events_per_producer; ++i)
+            {
+                const ErrorEvent event = make_event(event_text(producer, i));
+                while (!ring.try_push(event))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<std::size_t> next_index(producers, 0);
+    std::size_t received = 0;
+    bool in_order = true;
+    ErrorEvent event;
+    while (received < producers * events_per_producer)
+    {
+        if (!ring.try_pop(event))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::size_t producer = 0;
+        std::size_t index = 0;
+        ASSERT_TRUE(parse_event_text(event.what, producer, index)) << event.what;
+        ASSERT_LT(producer, producers);
+
+        // each producer's events arrive in its push order, so a skip is a loss and a repeat a duplicate
+        in_order = in_order && index == next_index[producer];
+        next_index[producer] = index + 1;
+        ++received;
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_TRUE(in_order);
+    for (std::size_t producer = 0; producer < producers; ++producer)
+    {
+        EXPECT_EQ(next_index[producer], events_per_producer) << "producer " << producer;
+    }
+    EXPECT_FALSE(ring.try_pop(event));
+}
+
+TEST(ErrorReporterTest, FlushWritesEverythingQueued)
+{
+    constexpr std::size_t producers = 4;
+    constexpr std::size_t events_per_producer = 200;
+
+    std::ostringstream out;
+    // room for every report, so none can be dropped however far behind the drainer is
+    ErrorReporter reporter(out, 2 * producers * events_per_producer);
+
+    std::vector<std::thread> threads;
+    for (std::size_t producer = 0; producer < producers; ++producer)
+    {
+        threads.emplace_back([&reporter, producer] {
+            for (std::size_t i = 0; i < events_per_producer; ++i)
+            {
+                const std::string what = event_text(producer, i);
+                reporter.report(Error(runtime_error_category, "unused"), ErrorSeverity::critical);
+                reporter.report("test event", what);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    ASSERT_EQ(reporter.dropped(), 0u);
+    reporter.flush();
+
+    // the reporter keeps running, but everything reported before flush() is already written
+    const std::string written = out.str();
+    EXPECT_EQ(count_occurrences(written, "std::runtime_error: unused\n"), producers * events_per_producer);
+    EXPECT_EQ(count_occurrences(written, "Z critical [thread "), producers * events_per_producer);
+    EXPECT_EQ(count_occurrences(written, "Z error [thread "), producers * events_per_producer);
+    for (std::size_t producer = 0; producer < producers; ++producer)
+    {
+        for (std::size_t i = 0; i < events_per_producer; ++i)
+        {
+            EXPECT_EQ(count_occurrences(written, "test event: " + event_text(producer, i) + "\n"), 1u);
+        }
+    }
+}
+
+TEST(ErrorReporterTest, ShutdownAccountsForEveryReport)
+{
+    constexpr std::size_t reports = 1000;
+
+    std::ostringstream out;
+    std::size_t dropped = 0;
+    {
+        // a tiny ring and a slow drainer, so most reports are dropped
+        ErrorReporter reporter(out, 2, std::chrono::milliseconds(50));
+        for (std::size_t i = 0; i < reports; ++i)
+        {
+            reporter.report("test event", event_text(0, i));
+        }
+        dropped = reporter.dropped();
+        EXPECT_GT(dropped, 0u);
+    }
+
+    // the destructor's last pass writes the queued events and the final drop count
+    const std::string written = out.str();
+    std::size_t reported_drops = 0;
+    std::istringstream lines(written);
+    const std::string prefix = "ErrorReporter: ";
+    for (std::string line; std::getline(lines, line);)
+    {
+        if (line.compare(0, prefix.size(), prefix) == 0)
+        {
+            reported_drops += std::stoul(line.substr(prefix.size()));
+        }
+    }
+
+    EXPECT_EQ(reported_drops, dropped);
+    EXPECT_EQ(count_occurrences(written, "test event: ") + dropped, reports);
+}
+
+TEST(ErrorCategoryTest, IsAFollowsTheHierarchy)
+{
+    EXPECT_TRUE(overflow_error_category.is_a(overflow_error_category));
+    EXPECT_TRUE(overflow_error_category.is_a(runtime_error_category));
+    EXPECT_TRUE(overflow_error_category.is_a(std_exception_category));
+    EXPECT_FALSE(overflow_error_category.is_a(underflow_error_category));
+    EXPECT_FALSE(overflow_error_category.is_a(logic_error_category));
+
+    // a base is never a derived category
+    EXPECT_FALSE(runtime_error_category.is_a(overflow_error_category));
+    EXPECT_FALSE(std_exception_category.is_a(runtime_error_category));
+
+    EXPECT_TRUE(custom_exception_category.is_a(std_exception_category));
+    EXPECT_FALSE(custom_exception_category.is_a(runtime_error_category));
+    EXPECT_TRUE(test_error_category.is_a(logic_error_category));
+    EXPECT_FALSE(test_error_category.is_a(custom_exception_category));
+
+    const Error error(underflow_error_category, "underflow");
+    EXPECT_TRUE(error.is_a(runtime_error_category));
+    EXPECT_TRUE(error.is_a(std_exception_category));
+    EXPECT_FALSE(error.is_a(overflow_error_category));
+}
+
+TEST_F(ExpectedAssignmentTest, ThrowingValueCopyKeepsOldValue)
+{
+    Expected<Fragile> target(Fragile(1));
+    const Expected<Fragile> source(Fragile(2));
+
+    Fragile::copies_throw = true;
+    EXPECT_THROW(target = source, std::runtime_error);
+    Fragile::copies_throw = false;
+
+    ASSERT_TRUE(target.has_value());
+    EXPECT_EQ(target.value().id, 1);
+}
+
+TEST_F(ExpectedAssignmentTest, ThrowingValueCopyKeepsOldError)
+{
+    Expected<Fragile> target = make_unexpected(Error(runtime_error_category, "old error"));
+    const Expected<Fragile> source(Fragile(2));
+
+    Fragile::copies_throw = true;
+    EXPECT_THROW(target = source, std::runtime_error);
+    Fragile::copies_throw = false;
+
+    ASSERT_FALSE(target.has_value());
+    EXPECT_TRUE(target.error().is_a(runtime_error_category));
+    EXPECT_STREQ(target.error().what(), "old error");
+}
+
+TEST_F(ExpectedAssignmentTest, ThrowingValueMoveKeepsOldError)
+{
+    // an error that owns memory, so an error destroyed and never put back would be caught
+    const std::string old_error(100, 'e');
+    Expected<Fragile, std::string> target = make_unexpected(old_error);
+    Expected<Fragile, std::string> source(Fragile(2));
+
+    // the copy succeeds and only moving it into place throws, so this takes the restoring path
+    Fragile::moves_throw = true;
+    EXPECT_THROW(target = std::move(source), std::runtime_error);
+    EXPECT_THROW((target = Expected<Fragile, std::string>(source)), std::runtime_error);
+    Fragile::moves_throw = false;
+
+    ASSERT_FALSE(target.has_value());
+    EXPECT_EQ(target.error(), old_error);
+
+    target = std::move(source);
+    ASSERT_TRUE(target.has_value());
+    EXPECT_EQ(target.value().id, 2);
+}
+
+TEST_F(ExpectedAssignmentTest, ThrowingErrorMoveKeepsOldValue)
+{
+    Expected<int, Fragile> target(1);
+    Expected<int, Fragile> source = make_unexpected(Fragile(2));
+
+    Fragile::moves_throw = true;
+    EXPECT_THROW(target = std::move(source), std::runtime_error);
+    Fragile::moves_throw = false;
+    ASSERT_TRUE(target.has_value());
+    EXPECT_EQ(*target, 1);
+
+    Fragile::copies_throw = true;
+    EXPECT_THROW(target = source, std::runtime_error);
+    Fragile::copies_throw = false;
+    ASSERT_TRUE(target.has_value());
+    EXPECT_EQ(*target, 1);
+
+    target = source;
+    ASSERT_FALSE(target.has_value());
+    EXPECT_EQ(target.error().id, 2);
+}
+
+TEST_F(ExpectedAssignmentTest, ThrowingErrorAssignmentKeepsOldError)
+{
+    Expected<int, Fragile> target = make_unexpected(Fragile(1));
+    Expected<int, Fragile> source = make_unexpected(Fragile(2));
+
+    Fragile::copies_throw = true;
+    EXPECT_THROW(target = source, std::runtime_error);
+    Fragile::copies_throw = false;
+    Fragile::moves_throw = true;
+    EXPECT_THROW(target = std::move(source), std::runtime_error);
+    Fragile::moves_throw = false;
+
+    ASSERT_FALSE(target.has_value());
+    EXPECT_EQ(target.error().id, 1);
+}
+
+TEST_F(ExpectedAssignmentTest, AssignmentsSwitchBetweenValueAndError)
+{
+    Expected<Fragile> target(Fragile(1));
+    target = Expected<Fragile>(make_unexpected(Error(overflow_error_category, "overflow")));
+    ASSERT_FALSE(target.has_value());
+    EXPECT_TRUE(target.error().is_a(runtime_error_category));
+
+    const Expected<Fragile> value(Fragile(3));
+    target = value;
+    ASSERT_TRUE(target.has_value());
+    EXPECT_EQ(target.value().id, 3);
+    EXPECT_EQ(value.value().id, 3);
+
+    target = target;
+    ASSERT_TRUE(target.has_value());
+    EXPECT_EQ(target.value().id, 3);
+}
+
+TEST_F(ExpectedAssignmentTest, VoidThrowingErrorCopyKeepsSuccess)
+{
+    Expected<void, Fragile> target;
+    const Expected<void, Fragile> source = make_unexpected(Fragile(2));
+
+    Fragile::copies_throw = true;
+    EXPECT_THROW(target = source, std::runtime_error);
+    Fragile::copies_throw = false;
+    EXPECT_TRUE(target.has_value());
+
+    target = source;
+    ASSERT_FALSE(target.has_value());
+    EXPECT_EQ(target.error().id, 2);
+
+    target = Expected<void, Fragile>();
+    EXPECT_TRUE(target.has_value());
+}
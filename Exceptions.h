@@ -0,0 +1,51 @@
+// Exceptions.h : The exception types and division helpers shared by the exceptions example and its benchmarks.
+//
+
+#pragma once
+
+#include <exception>
+#include <stdexcept>
+
+#include "Expected.h"
+
+// message shared by the exception and its non-throwing error counterpart
+inline constexpr const char* custom_exception_message = "Custom exception has been thrown!";
+inline constexpr const char* division_by_zero_message = "Error: division by zero is undefined!";
+
+//Custom exception class that extends from the std::exception
+struct MyCustomException : public std::exception
+{
+    virtual const char* what() const throw()
+    {
+        return custom_exception_message;
+    }
+};
+
+// error category matching MyCustomException, so results can be tested for it like a catch block would
+inline constexpr ErrorCategory custom_exception_category{ "MyCustomException", &std_exception_category };
+
+inline float divide(float num, float den)
+{
+    // TODO: Throw an exception to deal with divide by zero errors using
+    //  a standard C++ defined exception
+    if (den == 0) {
+        throw std::runtime_error(division_by_zero_message);
+    }
+
+    return (num / den);
+}
+
+/// <summary>
+/// Non-throwing variant of divide that reports division by zero as a runtime_error result
+/// </summary>
+/// <param name="num">numerator</param>
+/// <param name="den">denominator</param>
+/// <returns>num / den, or a runtime_error_category error when den is zero</returns>
+inline Expected<float> try_divide(float num, float den) noexcept
+{
+    if (den == 0) {
+        return make_unexpected(Error(runtime_error_category, division_by_zero_message));
+    }
+
+    return (num / den);
+}
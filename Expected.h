@@ -0,0 +1,398 @@
+// Expected.h : Non-throwing result type and error categories for hot paths where unwinding is too costly.
+//
+
+#pragma once
+
+#include <cassert>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/// <summary>
+/// A family of errors. Categories form a hierarchy that mirrors the standard exception
+/// classes, so a caller can test for a base category the same way a catch block for a
+/// base exception type would match every derived type.
+/// </summary>
+class ErrorCategory
+{
+public:
+    constexpr ErrorCategory(const char* name, const ErrorCategory* parent) noexcept
+        : name_(name), parent_(parent)
+    {
+    }
+
+    ErrorCategory(const ErrorCategory&) = delete;
+    ErrorCategory& operator=(const ErrorCategory&) = delete;
+
+    const char* name() const noexcept
+    {
+        return name_;
+    }
+
+    const ErrorCategory* parent() const noexcept
+    {
+        return parent_;
+    }
+
+    /// <summary>
+    /// Whether this category is other or derives from it
+    /// </summary>
+    bool is_a(const ErrorCategory& other) const noexcept
+    {
+        for (const ErrorCategory* category = this; category != nullptr; category = category->parent_)
+        {
+            if (category == &other)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    const char* name_;
+    const ErrorCategory* parent_;
+};
+
+// the standard exception hierarchy, as far as this code base uses it
+inline constexpr ErrorCategory std_exception_category{ "std::exception", nullptr };
+inline constexpr ErrorCategory logic_error_category{ "std::logic_error", &std_exception_category };
+inline constexpr ErrorCategory runtime_error_category{ "std::runtime_error", &std_exception_category };
+inline constexpr ErrorCategory overflow_error_category{ "std::overflow_error", &runtime_error_category };
+inline constexpr ErrorCategory underflow_error_category{ "std::underflow_error", &runtime_error_category };
+
+/// <summary>
+/// An error value: its category plus a message with static storage duration, so creating
+/// and copying one never allocates.
+/// </summary>
+class Error
+{
+public:
+    constexpr Error(const ErrorCategory& category, const char* message) noexcept
+        : category_(&category), message_(message)
+    {
+    }
+
+    const ErrorCategory& category() const noexcept
+    {
+        return *category_;
+    }
+
+    // named after std::exception::what so handlers read the same either way
+    const char* what() const noexcept
+    {
+        return message_;
+    }
+
+    bool is_a(const ErrorCategory& category) const noexcept
+    {
+        return category_->is_a(category);
+    }
+
+private:
+    const ErrorCategory* category_;
+    const char* message_;
+};
+
+/// <summary>
+/// Wraps an error so it can be returned from a function whose result is Expected
+/// </summary>
+template <typename E>
+struct Unexpected
+{
+    E error;
+};
+
+template <typename E>
+Unexpected<E> make_unexpected(E error)
+{
+    return Unexpected<E>{ std::move(error) };
+}
+
+/// <summary>
+/// Holds either a value of type T or an error of type E. This is the non-throwing
+/// counterpart to a function that returns T and throws on failure: the error travels
+/// back up the call chain as an ordinary return value instead of unwinding the stack.
+/// </summary>
+template <typename T, typename E = Error>
+class Expected
+{
+public:
+    Expected(const T& value) noexcept(std::is_nothrow_copy_constructible<T>::value)
+        : has_value_(true)
+    {
+        new (&value_) T(value);
+    }
+
+    Expected(T&& value) noexcept(std::is_nothrow_move_constructible<T>::value)
+        : has_value_(true)
+    {
+        new (&value_) T(std::move(value));
+    }
+
+    Expected(Unexpected<E> unexpected) noexcept(std::is_nothrow_move_constructible<E>::value)
+        : has_value_(false)
+    {
+        new (&error_) E(std::move(unexpected.error));
+    }
+
+    Expected(const Expected& other)
+        : has_value_(other.has_value_)
+    {
+        if (has_value_)
+        {
+            new (&value_) T(other.value_);
+        }
+        else
+        {
+            new (&error_) E(other.error_);
+        }
+    }
+
+    Expected(Expected&& other) noexcept(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_constructible<E>::value)
+        : has_value_(other.has_value_)
+    {
+        if (has_value_)
+        {
+            new (&value_) T(std::move(other.value_));
+        }
+        else
+        {
+            new (&error_) E(std::move(other.error_));
+        }
+    }
+
+    Expected& operator=(const Expected& other)
+    {
+        if (this != &other)
+        {
+            // copy first, so a throwing copy of T or E leaves *this as it was
+            Expected copy(other);
+            assign(std::move(copy));
+        }
+        return *this;
+    }
+
+    Expected& operator=(Expected&& other) noexcept(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_constructible<E>::value)
+    {
+        if (this != &other)
+        {
+            assign(std::move(other));
+        }
+        return *this;
+    }
+
+    ~Expected()
+    {
+        destroy();
+    }
+
+    bool has_value() const noexcept
+    {
+        return has_value_;
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return has_value_;
+    }
+
+    T& value() noexcept
+    {
+        assert(has_value_);
+        return value_;
+    }
+
+    const T& value() const noexcept
+    {
+        assert(has_value_);
+        return value_;
+    }
+
+    T& operator*() noexcept
+    {
+        return value();
+    }
+
+    const T& operator*() const noexcept
+    {
+        return value();
+    }
+
+    const E& error() const noexcept
+    {
+        assert(!has_value_);
+        return error_;
+    }
+
+    /// <summary>
+    /// The value, or fallback if this holds an error
+    /// </summary>
+    T value_or(T fallback) const
+    {
+        return has_value_ ? value_ : std::move(fallback);
+    }
+
+private:
+    static_assert(std::is_nothrow_move_constructible<T>::value || std::is_nothrow_move_constructible<E>::value,
+                  "assignment needs T or E to move without throwing, to restore the old value if the new one throws");
+
+    // move assignment that leaves *this holding its old value or error if moving the new one throws
+    void assign(Expected&& other)
+    {
+        if (has_value_ && other.has_value_)
+        {
+            value_ = std::move(other.value_);
+        }
+        else if (!has_value_ && !other.has_value_)
+        {
+            error_ = std::move(other.error_);
+        }
+        else if (other.has_value_)
+        {
+            replace(error_, &value_, std::move(other.value_));
+            has_value_ = true;
+        }
+        else
+        {
+            replace(value_, &error_, std::move(other.error_));
+            has_value_ = false;
+        }
+    }
+
+    // end the union member current and start its other member from replacement
+    template <typename Current, typename Replacement>
+    static void replace(Current& current, Replacement* storage, Replacement&& replacement)
+    {
+        if constexpr (std::is_nothrow_move_constructible<Replacement>::value)
+        {
+            current.~Current();
+            new (storage) Replacement(std::move(replacement));
+        }
+        else
+        {
+            // Current is nothrow movable (see the static_assert), so it can be put back
+            Current saved(std::move(current));
+            current.~Current();
+            try
+            {
+                new (storage) Replacement(std::move(replacement));
+            }
+            catch (...)
+            {
+                new (&current) Current(std::move(saved));
+                throw;
+            }
+        }
+    }
+
+    void destroy() noexcept
+    {
+        if (has_value_)
+        {
+            value_.~T();
+        }
+        else
+        {
+            error_.~E();
+        }
+    }
+
+    union
+    {
+        T value_;
+        E error_;
+    };
+    bool has_value_;
+};
+
+/// <summary>
+/// Expected for functions that produce no value, only success or an error
+/// </summary>
+template <typename E>
+class Expected<void, E>
+{
+public:
+    Expected() noexcept
+        : has_value_(true)
+    {
+    }
+
+    Expected(Unexpected<E> unexpected) noexcept(std::is_nothrow_move_constructible<E>::value)
+        : has_value_(false)
+    {
+        new (&error_) E(std::move(unexpected.error));
+    }
+
+    Expected(const Expected& other)
+        : has_value_(other.has_value_)
+    {
+        if (!has_value_)
+        {
+            new (&error_) E(other.error_);
+        }
+    }
+
+    Expected& operator=(const Expected& other)
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+        if (!has_value_ && !other.has_value_)
+        {
+            error_ = other.error_;
+        }
+        else if (!other.has_value_)
+        {
+            // nothing to destroy first, so a throwing copy leaves *this a success
+            new (&error_) E(other.error_);
+            has_value_ = false;
+        }
+        else
+        {
+            destroy();
+            has_value_ = true;
+        }
+        return *this;
+    }
+
+    ~Expected()
+    {
+        destroy();
+    }
+
+    bool has_value() const noexcept
+    {
+        return has_value_;
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return has_value_;
+    }
+
+    const E& error() const noexcept
+    {
+        assert(!has_value_);
+        return error_;
+    }
+
+private:
+    void destroy() noexcept
+    {
+        if (!has_value_)
+        {
+            error_.~E();
+        }
+    }
+
+    // error_ is only constructed when has_value_ is false
+    union
+    {
+        char empty_;
+        E error_;
+    };
+    bool has_value_;
+};
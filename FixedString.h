@@ -0,0 +1,266 @@
+// FixedString.h : Fixed capacity, stack allocated string for overflow safe input buffers.
+//
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string_view>
+
+/// <summary>
+/// A string that holds at most N characters inline and never touches the heap.
+/// Every write is bounded by the capacity; anything that does not fit is dropped and
+/// reported through the return value and truncated(). Debug builds surround the
+/// buffer with guard canaries that are checked when the string is destroyed, so a
+/// write through data() that runs past the end is caught.
+/// </summary>
+/// <typeparam name="N">the number of characters the string can hold, excluding the terminator</typeparam>
+template <std::size_t N>
+class FixedString
+{
+public:
+    FixedString() noexcept
+    {
+        init_guards();
+        data_[0] = '\0';
+    }
+
+    explicit FixedString(std::string_view text) noexcept
+        : FixedString()
+    {
+        assign(text);
+    }
+
+    FixedString(const FixedString& other) noexcept
+        : FixedString()
+    {
+        assign(other.view());
+        truncated_ = other.truncated_;
+    }
+
+    FixedString& operator=(const FixedString& other) noexcept
+    {
+        assign(other.view());
+        truncated_ = other.truncated_;
+        return *this;
+    }
+
+    ~FixedString()
+    {
+        assert(guards_intact() && "FixedString guard canary overwritten");
+    }
+
+    /// <summary>
+    /// The maximum number of characters the string can hold
+    /// </summary>
+    static constexpr std::size_t capacity() noexcept
+    {
+        return N;
+    }
+
+    /// <summary>
+    /// Replace the contents, keeping as much of text as fits
+    /// </summary>
+    /// <returns>true if all of text was stored</returns>
+    bool assign(std::string_view text) noexcept
+    {
+        size_ = 0;
+        truncated_ = false;
+        return append(text);
+    }
+
+    /// <summary>
+    /// Add to the end of the string, keeping as much of text as fits
+    /// </summary>
+    /// <returns>true if all of text was stored</returns>
+    bool append(std::string_view text) noexcept
+    {
+        const std::size_t room = N - size_;
+        const std::size_t count = text.length() < room ? text.length() : room;
+
+        std::memcpy(data_ + size_, text.data(), count);
+        size_ += count;
+        data_[size_] = '\0';
+
+        if (count < text.length())
+        {
+            truncated_ = true;
+            return false;
+        }
+        return true;
+    }
+
+    /// <summary>
+    /// Add a single character to the end of the string
+    /// </summary>
+    /// <returns>true if there was room for it</returns>
+    bool push_back(char c) noexcept
+    {
+        return append(std::string_view(&c, 1));
+    }
+
+    /// <summary>
+    /// Read one line from a stream, keeping the first N characters and discarding the rest of
+    /// the line. Unlike istream::getline into a char array, an over-length line does not leave
+    /// the stream in a failed state; it is reported through truncated() instead.
+    /// </summary>
+    /// <returns>the stream, which converts to false once there is nothing left to read</returns>
+    std::istream& read_line(std::istream& in)
+    {
+        size_ = 0;
+        truncated_ = false;
+        data_[0] = '\0';
+
+        in.getline(data_, N + 1);
+        size_ = std::strlen(data_);
+
+        if (in.fail() && !in.eof() && size_ == N)
+        { // the line did not end where we stopped, so check whether it was just a CRLF terminator
+            in.clear();
+            if (in.peek() == '\r')
+            {
+                in.get();
+            }
+
+            const auto next = in.peek();
+            if (next == '\n')
+            {
+                in.get();
+            }
+            else if (next != std::istream::traits_type::eof())
+            { // the line was longer than we can hold, so drop the remainder and carry on
+                truncated_ = true;
+                in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            }
+            in.clear(in.rdstate() & ~std::ios::failbit);
+        }
+
+        if (size_ > 0 && data_[size_ - 1] == '\r')
+        {
+            data_[--size_] = '\0';
+        }
+
+        return in;
+    }
+
+    /// <summary>
+    /// Shorten the string, or record how much was written through data()
+    /// </summary>
+    void resize(std::size_t count) noexcept
+    {
+        assert(count <= N);
+        size_ = count < N ? count : N;
+        data_[size_] = '\0';
+    }
+
+    void clear() noexcept
+    {
+        resize(0);
+        truncated_ = false;
+    }
+
+    /// <summary>
+    /// Whether the last assign, append or read_line had to drop characters
+    /// </summary>
+    bool truncated() const noexcept
+    {
+        return truncated_;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    std::size_t length() const noexcept
+    {
+        return size_;
+    }
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    const char* c_str() const noexcept
+    {
+        return data_;
+    }
+
+    const char* data() const noexcept
+    {
+        return data_;
+    }
+
+    // writable access for C style APIs, which must stay within capacity() and then call resize()
+    char* data() noexcept
+    {
+        return data_;
+    }
+
+    char operator[](std::size_t index) const noexcept
+    {
+        assert(index <= size_);
+        return data_[index];
+    }
+
+    std::string_view view() const noexcept
+    {
+        return std::string_view(data_, size_);
+    }
+
+    operator std::string_view() const noexcept
+    {
+        return view();
+    }
+
+    /// <summary>
+    /// Check the debug guard canaries. Always true in release builds, which have none.
+    /// </summary>
+    bool guards_intact() const noexcept
+    {
+#ifndef NDEBUG
+        for (std::size_t i = 0; i < guard_size; ++i)
+        {
+            if (front_guard_[i] != guard_byte || back_guard_[i] != guard_byte)
+            {
+                return false;
+            }
+        }
+#endif
+        return true;
+    }
+
+private:
+    void init_guards() noexcept
+    {
+#ifndef NDEBUG
+        std::memset(front_guard_, guard_byte, guard_size);
+        std::memset(back_guard_, guard_byte, guard_size);
+#endif
+    }
+
+#ifndef NDEBUG
+    static constexpr std::size_t guard_size = 8;
+    static constexpr char guard_byte = static_cast<char>(0xA5);
+
+    // char arrays so the guards sit right against the buffer without any padding in between
+    char front_guard_[guard_size];
+#endif
+    char data_[N + 1];
+#ifndef NDEBUG
+    char back_guard_[guard_size];
+#endif
+    std::size_t size_ = 0;
+    bool truncated_ = false;
+};
+
+template <std::size_t N>
+std::ostream& operator<<(std::ostream& out, const FixedString<N>& text)
+{
+    return out << text.view();
+}
@@ -0,0 +1,264 @@
+// KeyDerivation.h : SHA-256 and PBKDF2-HMAC-SHA256, used to turn the example's string key into cipher keys.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace key_derivation_detail
+{
+    constexpr std::uint32_t sha256_round_constants[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+    inline std::uint32_t rotate_right(std::uint32_t value, unsigned bits)
+    {
+        return (value >> bits) | (value << (32 - bits));
+    }
+}
+
+/// <summary>
+/// Incremental SHA-256 (FIPS 180-4)
+/// </summary>
+class Sha256
+{
+public:
+    static constexpr std::size_t digest_size = 32;
+    static constexpr std::size_t block_size = 64;
+    using Digest = std::array<std::uint8_t, digest_size>;
+
+    Sha256()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        state_ = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        length_ = 0;
+        buffered_ = 0;
+    }
+
+    void update(const void* data, std::size_t length)
+    {
+        const auto* bytes = static_cast<const std::uint8_t*>(data);
+        length_ += length;
+
+        if (buffered_ > 0)
+        {
+            const std::size_t take = std::min(length, block_size - buffered_);
+            std::memcpy(buffer_.data() + buffered_, bytes, take);
+            buffered_ += take;
+            bytes += take;
+            length -= take;
+            if (buffered_ < block_size)
+            {
+                return;
+            }
+            compress(buffer_.data());
+            buffered_ = 0;
+        }
+
+        for (; length >= block_size; bytes += block_size, length -= block_size)
+        {
+            compress(bytes);
+        }
+
+        std::memcpy(buffer_.data(), bytes, length);
+        buffered_ = length;
+    }
+
+    void update(const std::string& text)
+    {
+        update(text.data(), text.size());
+    }
+
+    Digest finish()
+    {
+        const std::uint64_t bit_length = length_ * 8;
+        const std::uint8_t pad = 0x80;
+        update(&pad, 1);
+        const std::uint8_t zero = 0;
+        while (buffered_ != block_size - 8)
+        {
+            update(&zero, 1);
+        }
+        std::uint8_t length_bytes[8];
+        for (int i = 0; i < 8; ++i)
+        {
+            length_bytes[i] = static_cast<std::uint8_t>(bit_length >> (56 - 8 * i));
+        }
+        update(length_bytes, sizeof(length_bytes));
+
+        Digest digest;
+        for (std::size_t i = 0; i < state_.size(); ++i)
+        {
+            for (std::size_t b = 0; b < 4; ++b)
+            {
+                digest[4 * i + b] = static_cast<std::uint8_t>(state_[i] >> (24 - 8 * b));
+            }
+        }
+        reset();
+        return digest;
+    }
+
+    static Digest hash(const void* data, std::size_t length)
+    {
+        Sha256 sha;
+        sha.update(data, length);
+        return sha.finish();
+    }
+
+private:
+    void compress(const std::uint8_t* block)
+    {
+        using key_derivation_detail::rotate_right;
+
+        std::uint32_t w[64];
+        for (std::size_t i = 0; i < 16; ++i)
+        {
+            w[i] = (std::uint32_t(block[4 * i]) << 24) | (std::uint32_t(block[4 * i + 1]) << 16) | (std::uint32_t(block[4 * i + 2]) << 8) | block[4 * i + 3];
+        }
+        for (std::size_t i = 16; i < 64; ++i)
+        {
+            const std::uint32_t s0 = rotate_right(w[i - 15], 7) ^ rotate_right(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const std::uint32_t s1 = rotate_right(w[i - 2], 17) ^ rotate_right(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        std::uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+        std::uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+        for (std::size_t i = 0; i < 64; ++i)
+        {
+            const std::uint32_t s1 = rotate_right(e, 6) ^ rotate_right(e, 11) ^ rotate_right(e, 25);
+            const std::uint32_t choose = (e & f) ^ (~e & g);
+            const std::uint32_t t1 = h + s1 + choose + key_derivation_detail::sha256_round_constants[i] + w[i];
+            const std::uint32_t s0 = rotate_right(a, 2) ^ rotate_right(a, 13) ^ rotate_right(a, 22);
+            const std::uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + s0 + majority;
+        }
+
+        state_[0] += a;
+        state_[1] += b;
+        state_[2] += c;
+        state_[3] += d;
+        state_[4] += e;
+        state_[5] += f;
+        state_[6] += g;
+        state_[7] += h;
+    }
+
+    std::array<std::uint32_t, 8> state_;
+    std::array<std::uint8_t, block_size> buffer_;
+    std::uint64_t length_;
+    std::size_t buffered_;
+};
+
+/// <summary>
+/// HMAC-SHA256 with the key's inner and outer pads absorbed once, so the same key can be applied to
+/// many messages cheaply (PBKDF2 applies it to every iteration)
+/// </summary>
+class HmacSha256
+{
+public:
+    explicit HmacSha256(const std::string& key)
+    {
+        std::array<std::uint8_t, Sha256::block_size> block{};
+        if (key.size() > Sha256::block_size)
+        {
+            const Sha256::Digest digest = Sha256::hash(key.data(), key.size());
+            std::memcpy(block.data(), digest.data(), digest.size());
+        }
+        else
+        {
+            std::memcpy(block.data(), key.data(), key.size());
+        }
+
+        std::array<std::uint8_t, Sha256::block_size> pad;
+        for (std::size_t i = 0; i < pad.size(); ++i)
+        {
+            pad[i] = block[i] ^ 0x36;
+        }
+        inner_.update(pad.data(), pad.size());
+        for (std::size_t i = 0; i < pad.size(); ++i)
+        {
+            pad[i] = block[i] ^ 0x5c;
+        }
+        outer_.update(pad.data(), pad.size());
+    }
+
+    Sha256::Digest mac(const void* data, std::size_t length) const
+    {
+        Sha256 inner = inner_;
+        inner.update(data, length);
+        const Sha256::Digest inner_digest = inner.finish();
+
+        Sha256 outer = outer_;
+        outer.update(inner_digest.data(), inner_digest.size());
+        return outer.finish();
+    }
+
+private:
+    Sha256 inner_;
+    Sha256 outer_;
+};
+
+/// <summary>
+/// PBKDF2-HMAC-SHA256 (RFC 8018)
+/// </summary>
+/// <param name="password">the string key the user typed</param>
+/// <param name="salt">fixed per use so that different uses of one password get unrelated keys</param>
+/// <param name="iterations">work factor, every iteration is two SHA-256 compressions</param>
+/// <param name="length">bytes of key material to produce</param>
+/// <returns>the derived key material</returns>
+inline std::vector<std::uint8_t> pbkdf2_hmac_sha256(const std::string& password, const std::string& salt, std::uint32_t iterations, std::size_t length)
+{
+    const HmacSha256 hmac(password);
+    std::vector<std::uint8_t> derived;
+    derived.reserve(length);
+
+    std::vector<std::uint8_t> message(salt.begin(), salt.end());
+    message.resize(salt.size() + 4);
+    for (std::uint32_t block = 1; derived.size() < length; ++block)
+    {
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            message[salt.size() + i] = static_cast<std::uint8_t>(block >> (24 - 8 * i));
+        }
+
+        Sha256::Digest u = hmac.mac(message.data(), message.size());
+        Sha256::Digest t = u;
+        for (std::uint32_t i = 1; i < iterations; ++i)
+        {
+            u = hmac.mac(u.data(), u.size());
+            for (std::size_t b = 0; b < t.size(); ++b)
+            {
+                t[b] ^= u[b];
+            }
+        }
+
+        const std::size_t take = std::min(t.size(), length - derived.size());
+        derived.insert(derived.end(), t.begin(), t.begin() + static_cast<std::ptrdiff_t>(take));
+    }
+
+    return derived;
+}
@@ -0,0 +1,191 @@
+// MappedFile.h : Read-only memory mapping of a whole file.
+//
+
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// <summary>
+/// Maps a file into memory for reading. The pages are loaded on first touch by the OS, so
+/// opening is cheap however large the file is, and several threads can read it at once.
+/// </summary>
+class MappedFile
+{
+public:
+    MappedFile() noexcept = default;
+
+    /// <summary>
+    /// Map filename. Throws std::runtime_error if it cannot be opened or mapped.
+    /// </summary>
+    explicit MappedFile(const std::string& filename)
+    {
+#ifdef _WIN32
+        file_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE)
+        {
+            throw std::runtime_error("Unable to open " + filename);
+        }
+        LARGE_INTEGER size;
+        GetFileSizeEx(file_, &size);
+        size_ = static_cast<std::size_t>(size.QuadPart);
+        if (size_ > 0)
+        {
+            mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            data_ = mapping_ == nullptr ? nullptr : static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+            if (data_ == nullptr)
+            {
+                close();
+                throw std::runtime_error("Unable to map " + filename);
+            }
+        }
+#else
+        fd_ = ::open(filename.c_str(), O_RDONLY);
+        if (fd_ < 0)
+        {
+            throw std::runtime_error("Unable to open " + filename + ": " + std::strerror(errno));
+        }
+        struct stat status;
+        if (::fstat(fd_, &status) != 0)
+        {
+            const int error = errno;
+            close();
+            throw std::runtime_error("Unable to stat " + filename + ": " + std::strerror(error));
+        }
+        size_ = static_cast<std::size_t>(status.st_size);
+        if (size_ > 0)
+        { // mapping zero bytes is an error, so an empty file just has no data
+            void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+            if (data == MAP_FAILED)
+            {
+                const int error = errno;
+                close();
+                throw std::runtime_error("Unable to map " + filename + ": " + std::strerror(error));
+            }
+            data_ = static_cast<const char*>(data);
+        }
+#endif
+    }
+
+    MappedFile(MappedFile&& other) noexcept
+    {
+        swap(other);
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            swap(other);
+        }
+        return *this;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    const char* data() const noexcept
+    {
+        return data_;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    std::string_view view() const noexcept
+    {
+        return std::string_view(data_ == nullptr ? "" : data_, size_);
+    }
+
+    /// <summary>
+    /// Tell the OS the file will be read front to back, so it can read ahead aggressively
+    /// </summary>
+    void advise_sequential() const noexcept
+    {
+#ifndef _WIN32
+        if (data_ != nullptr)
+        {
+            ::madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+        }
+#endif
+    }
+
+private:
+    void swap(MappedFile& other) noexcept
+    {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+#ifdef _WIN32
+        std::swap(file_, other.file_);
+        std::swap(mapping_, other.mapping_);
+#else
+        std::swap(fd_, other.fd_);
+#endif
+    }
+
+    void close() noexcept
+    {
+#ifdef _WIN32
+        if (data_ != nullptr)
+        {
+            UnmapViewOfFile(data_);
+        }
+        if (mapping_ != nullptr)
+        {
+            CloseHandle(mapping_);
+        }
+        if (file_ != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(file_);
+        }
+        file_ = INVALID_HANDLE_VALUE;
+        mapping_ = nullptr;
+#else
+        if (data_ != nullptr)
+        {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+        }
+        fd_ = -1;
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
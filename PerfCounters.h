@@ -0,0 +1,131 @@
+// PerfCounters.h : Hardware instruction and cycle counters through Linux perf_event_open.
+//
+
+#pragma once
+
+#include <cstdint>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+/// <summary>
+/// Counts user space instructions and cycles for the calling thread between start() and
+/// stop(). The counters are optional: when the kernel refuses them (not Linux, no PMU in a
+/// VM, or perf_event_paranoid too strict) available() is false and every count reads zero,
+/// so callers can always fall back to plain timings.
+/// </summary>
+class PerfCounters
+{
+public:
+    PerfCounters() noexcept
+    {
+#ifdef __linux__
+        leader_ = open_counter(PERF_COUNT_HW_INSTRUCTIONS, -1);
+        if (leader_ >= 0)
+        {
+            cycles_fd_ = open_counter(PERF_COUNT_HW_CPU_CYCLES, leader_);
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters()
+    {
+#ifdef __linux__
+        if (cycles_fd_ >= 0)
+        {
+            ::close(cycles_fd_);
+        }
+        if (leader_ >= 0)
+        {
+            ::close(leader_);
+        }
+#endif
+    }
+
+    /// <summary>
+    /// Whether the instruction counter could be opened
+    /// </summary>
+    bool available() const noexcept
+    {
+        return leader_ >= 0;
+    }
+
+    /// <summary>
+    /// Whether the cycle counter could be opened alongside the instruction counter
+    /// </summary>
+    bool cycles_available() const noexcept
+    {
+        return cycles_fd_ >= 0;
+    }
+
+    void start() noexcept
+    {
+#ifdef __linux__
+        if (available())
+        {
+            ::ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ::ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    void stop() noexcept
+    {
+#ifdef __linux__
+        if (available())
+        {
+            ::ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+            // PERF_FORMAT_GROUP layout: number of counters, then one value per counter in open order
+            std::uint64_t values[3] = {};
+            if (::read(leader_, values, sizeof(values)) > 0)
+            {
+                instructions_ = values[0] > 0 ? values[1] : 0;
+                cycles_ = values[0] > 1 ? values[2] : 0;
+            }
+        }
+#endif
+    }
+
+    std::uint64_t instructions() const noexcept
+    {
+        return instructions_;
+    }
+
+    std::uint64_t cycles() const noexcept
+    {
+        return cycles_;
+    }
+
+private:
+#ifdef __linux__
+    static int open_counter(std::uint64_t config, int group_fd) noexcept
+    {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.config = config;
+        attributes.disabled = group_fd < 0 ? 1 : 0;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_GROUP;
+
+        return static_cast<int>(::syscall(SYS_perf_event_open, &attributes, 0, -1, group_fd, 0));
+    }
+#endif
+
+    int leader_ = -1;
+    int cycles_fd_ = -1;
+    std::uint64_t instructions_ = 0;
+    std::uint64_t cycles_ = 0;
+};
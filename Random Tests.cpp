@@ -0,0 +1,106 @@
+// Random Tests.cpp : Known answer tests for splitmix64, xoshiro256** and its jump, and the stream helpers.
+//
+// The expected values come from an independent implementation of the reference algorithms, which
+// reproduces Vigna's published outputs for splitmix64 from 0 and xoshiro256** from the state 1, 2, 3, 4.
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "Random.h"
+
+namespace
+{
+    std::vector<std::uint64_t> take(Xoshiro256& random, std::size_t count)
+    {
+        std::vector<std::uint64_t> values(count);
+        for (auto& value : values)
+        {
+            value = random();
+        }
+        return values;
+    }
+}
+
+TEST(RandomTest, SplitMix64KnownAnswers)
+{
+    std::uint64_t state = 0;
+    EXPECT_EQ(splitmix64(state), 0xe220a8397b1dcdafull);
+    EXPECT_EQ(splitmix64(state), 0x6e789e6aa1b965f4ull);
+    EXPECT_EQ(splitmix64(state), 0x06c45d188009454full);
+    EXPECT_EQ(splitmix64(state), 0xf88bb8a8724c81ecull);
+}
+
+TEST(RandomTest, Xoshiro256KnownAnswers)
+{
+    Xoshiro256 zero(0);
+    EXPECT_EQ(take(zero, 4), (std::vector<std::uint64_t>{ 0x99ec5f36cb75f2b4ull, 0xbf6e1f784956452aull, 0x1a5f849d4933e6e0ull, 0x6aa594f1262d2d2cull }));
+
+    Xoshiro256 random(0x0123456789abcdefull);
+    EXPECT_EQ(take(random, 3), (std::vector<std::uint64_t>{ 0xa2c2a42038d4ec3dull, 0x05fc25d0738e7b0full, 0x625e7bff938e701eull }));
+
+    random.reseed(0);
+    EXPECT_EQ(random(), 0x99ec5f36cb75f2b4ull);
+}
+
+TEST(RandomTest, JumpKnownAnswers)
+{
+    Xoshiro256 random(0);
+    random.jump();
+    EXPECT_EQ(take(random, 3), (std::vector<std::uint64_t>{ 0x376215edc846d62cull, 0x57c0611de8350ca7ull, 0xbc46a3515afee385ull }));
+
+    // a second jump from the same seed lands 2^129 values ahead
+    random.reseed(0);
+    random.jump();
+    random.jump();
+    EXPECT_EQ(take(random, 2), (std::vector<std::uint64_t>{ 0xa72791f60c825a41ull, 0x92367e7e4edaa982ull }));
+}
+
+TEST(RandomTest, IndexedStreamsAreTheSeedJumped)
+{
+    Xoshiro256 expected(random_seed());
+    for (std::uint64_t index = 0; index < 4; ++index)
+    {
+        Xoshiro256 stream = indexed_random_stream(index);
+        Xoshiro256 copy = expected;
+        EXPECT_EQ(take(stream, 8), take(copy, 8)) << "stream " << index;
+        expected.jump();
+    }
+}
+
+TEST(RandomTest, IndexedStreamsDoNotDependOnTheThread)
+{
+    // each thread takes the stream of its own index, so scheduling cannot change what it draws
+    constexpr std::size_t threads = 4;
+    std::vector<std::vector<std::uint64_t>> drawn(threads);
+    std::vector<std::thread> workers;
+    for (std::size_t index = threads; index-- > 0;)
+    {
+        workers.emplace_back([&drawn, index] {
+            Xoshiro256 stream = indexed_random_stream(index);
+            drawn[index] = take(stream, 16);
+        });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    for (std::size_t index = 0; index < threads; ++index)
+    {
+        Xoshiro256 stream = indexed_random_stream(index);
+        EXPECT_EQ(drawn[index], take(stream, 16)) << "stream " << index;
+    }
+}
+
+TEST(RandomTest, NamedStreamsDependOnlyOnSeedAndName)
+{
+    Xoshiro256 first = random_stream("RandomTest.Name");
+    Xoshiro256 second = random_stream("RandomTest.Name");
+    Xoshiro256 other = random_stream("RandomTest.Other");
+    const auto values = take(first, 8);
+    EXPECT_EQ(values, take(second, 8));
+    EXPECT_NE(values, take(other, 8));
+}
@@ -0,0 +1,274 @@
+// Random.h : Seedable xoshiro256** generator with per-thread streams and bulk fills.
+//
+// Replaces rand(): no hidden global lock, the same seed always gives the same values, and the seed
+// is printed so a failing run can be replayed with RANDOM_SEED=<seed>.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <limits>
+#include <random>
+#include <vector>
+
+/// <summary>
+/// splitmix64, used to spread one 64-bit seed over the generator state and to derive stream seeds
+/// </summary>
+inline std::uint64_t splitmix64(std::uint64_t& state) noexcept
+{
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+/// <summary>
+/// xoshiro256** by Blackman and Vigna. Meets UniformRandomBitGenerator, so it also works with
+/// the <random> distributions, but next_below and the fill functions are faster for integer ranges.
+/// </summary>
+class Xoshiro256
+{
+public:
+    using result_type = std::uint64_t;
+
+    explicit Xoshiro256(std::uint64_t seed) noexcept
+    {
+        reseed(seed);
+    }
+
+    void reseed(std::uint64_t seed) noexcept
+    {
+        for (auto& word : state_)
+        {
+            word = splitmix64(seed);
+        }
+    }
+
+    static constexpr result_type min() noexcept
+    {
+        return 0;
+    }
+
+    static constexpr result_type max() noexcept
+    {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() noexcept
+    {
+        const std::uint64_t result = rotl(state_[1] * 5, 7) * 9;
+        const std::uint64_t t = state_[1] << 17;
+
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 45);
+
+        return result;
+    }
+
+    /// <summary>
+    /// Uniform value in [0, bound) without modulo bias. Multiplies instead of dividing and only
+    /// falls back to a division in the rare case a value has to be rejected.
+    /// </summary>
+    std::uint32_t next_below(std::uint32_t bound) noexcept
+    {
+        return below(static_cast<std::uint32_t>((*this)() >> 32), bound);
+    }
+
+    /// <summary>
+    /// Fill count values in [0, bound). Each 64-bit output supplies two values.
+    /// </summary>
+    template <typename T>
+    void fill_below(T* values, std::size_t count, std::uint32_t bound) noexcept
+    {
+        std::size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            const std::uint64_t bits = (*this)();
+            values[i] = static_cast<T>(below(static_cast<std::uint32_t>(bits >> 32), bound));
+            values[i + 1] = static_cast<T>(below(static_cast<std::uint32_t>(bits), bound));
+        }
+        if (i < count)
+        {
+            values[i] = static_cast<T>(next_below(bound));
+        }
+    }
+
+    template <typename T, typename Allocator>
+    void fill_below(std::vector<T, Allocator>& values, std::uint32_t bound) noexcept
+    {
+        fill_below(values.data(), values.size(), bound);
+    }
+
+    /// <summary>
+    /// Advance by 2^128 values. Streams started from the same seed and jumped a different number
+    /// of times never overlap in practice.
+    /// </summary>
+    void jump() noexcept
+    {
+        static const std::uint64_t polynomial[] = { 0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull, 0xa9582618e03fc9aaull, 0x39abdc4529b1661cull };
+
+        std::uint64_t jumped[4] = {};
+        for (const std::uint64_t word : polynomial)
+        {
+            for (int bit = 0; bit < 64; ++bit)
+            {
+                if (word & (std::uint64_t(1) << bit))
+                {
+                    for (int j = 0; j < 4; ++j)
+                    {
+                        jumped[j] ^= state_[j];
+                    }
+                }
+                (*this)();
+            }
+        }
+        for (int j = 0; j < 4; ++j)
+        {
+            state_[j] = jumped[j];
+        }
+    }
+
+private:
+    static std::uint64_t rotl(std::uint64_t x, int k) noexcept
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    // Lemire's multiply-shift range reduction, rejecting only the few values that would bias it
+    std::uint32_t below(std::uint32_t bits, std::uint32_t bound) noexcept
+    {
+        std::uint64_t product = std::uint64_t(bits) * bound;
+        auto low = static_cast<std::uint32_t>(product);
+        if (low < bound)
+        {
+            const std::uint32_t threshold = static_cast<std::uint32_t>(-bound) % bound;
+            while (low < threshold)
+            {
+                product = ((*this)() >> 32) * bound;
+                low = static_cast<std::uint32_t>(product);
+            }
+        }
+        return static_cast<std::uint32_t>(product >> 32);
+    }
+
+    std::uint64_t state_[4];
+};
+
+namespace random_detail
+{
+    // never throws, so the noexcept functions below can run it on first use
+    inline std::uint64_t initial_seed() noexcept
+    {
+        if (const char* text = std::getenv("RANDOM_SEED"))
+        {
+            char* end = nullptr;
+            const unsigned long long seed = std::strtoull(text, &end, 0);
+            if (end != text && *end == '\0')
+            {
+                return seed;
+            }
+            std::fprintf(stderr, "RANDOM_SEED=%s is not a number, using a random seed\n", text);
+        }
+
+        try
+        {
+            std::random_device device;
+            return (std::uint64_t(device()) << 32) | device();
+        }
+        catch (const std::exception&)
+        {
+            // no entropy source: the clock still makes runs differ, and the seed is printed as usual
+            std::uint64_t clock = static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+            return splitmix64(clock);
+        }
+    }
+
+    inline std::atomic<std::uint64_t>& seed()
+    {
+        static std::atomic<std::uint64_t> value{ initial_seed() };
+        return value;
+    }
+
+    inline std::atomic<std::uint64_t>& next_stream()
+    {
+        static std::atomic<std::uint64_t> value{ 0 };
+        return value;
+    }
+}
+
+/// <summary>
+/// The process wide seed: RANDOM_SEED from the environment if set, otherwise from std::random_device
+/// </summary>
+inline std::uint64_t random_seed() noexcept
+{
+    return random_detail::seed().load(std::memory_order_relaxed);
+}
+
+/// <summary>
+/// Replace the process wide seed. Only threads that have not drawn from thread_random() yet
+/// pick it up, so call this at start up.
+/// </summary>
+inline void set_random_seed(std::uint64_t seed) noexcept
+{
+    random_detail::seed().store(seed, std::memory_order_relaxed);
+}
+
+/// <summary>
+/// Print the seed in the form that replays the run
+/// </summary>
+inline void print_random_seed(std::FILE* out = stderr)
+{
+    std::fprintf(out, "RANDOM_SEED=%llu\n", static_cast<unsigned long long>(random_seed()));
+}
+
+/// <summary>
+/// A generator for one named piece of work, such as a test case: the same seed and name always
+/// give the same sequence, whatever else ran before it or on which thread.
+/// </summary>
+inline Xoshiro256 random_stream(const char* name) noexcept
+{
+    // FNV-1a of the name, mixed with the process seed
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (const char* c = name; *c != '\0'; ++c)
+    {
+        hash = (hash ^ static_cast<unsigned char>(*c)) * 0x100000001b3ull;
+    }
+    std::uint64_t mixed = random_seed() ^ hash;
+    return Xoshiro256(splitmix64(mixed));
+}
+
+/// <summary>
+/// Stream number index of the process seed: the seed's generator jumped index times, so streams
+/// never overlap. Threads that take index from their own work, such as a benchmark's thread
+/// index, draw the same values on every run with the same seed.
+/// </summary>
+inline Xoshiro256 indexed_random_stream(std::uint64_t index) noexcept
+{
+    Xoshiro256 stream(random_seed());
+    for (std::uint64_t i = 0; i < index; ++i)
+    {
+        stream.jump();
+    }
+    return stream;
+}
+
+/// <summary>
+/// The calling thread's generator, with no shared state to lock. Threads are numbered in the
+/// order they first call this and get that indexed_random_stream, so with several threads the
+/// values a thread draws depend on scheduling and such a run cannot be replayed from its seed.
+/// Single threaded runs replay; threads that need to replay use indexed_random_stream instead.
+/// </summary>
+inline Xoshiro256& thread_random() noexcept
+{
+    thread_local Xoshiro256 generator = indexed_random_stream(random_detail::next_stream().fetch_add(1, std::memory_order_relaxed));
+    return generator;
+}
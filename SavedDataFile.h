@@ -0,0 +1,140 @@
+// SavedDataFile.h : The checksum line of the files the encryption example saves, and checking a saved file against it.
+//
+// A saved file is the student name, the date, a header line written by checksum_header_line, then the
+// data and a newline:
+//   <key>\t<cipher name>\tcrc32c=<checksum of the data>\tsource-crc32c=<checksum of what the data was made from>
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "Cipher.h"
+
+/// <summary>
+/// Line 3 of a saved file, without the newline
+/// </summary>
+/// <param name="key">string key the data was made with</param>
+/// <param name="cipher">cipher the data was made with</param>
+/// <param name="checksums">source: what went into the cipher, output: the saved data</param>
+inline std::string checksum_header_line(const std::string& key, const Cipher& cipher, const StreamChecksums& checksums)
+{
+    std::ostringstream line;
+    line << key << '\t' << cipher.name() << std::hex << std::setfill('0') << "\tcrc32c=" << std::setw(8) << checksums.output << "\tsource-crc32c=" << std::setw(8)
+         << checksums.source;
+    return line.str();
+}
+
+namespace saved_data_file_detail
+{
+    // name=<8 hex digits>
+    inline bool parse_checksum(const std::string& field, const char* name, std::uint32_t& checksum)
+    {
+        const std::size_t prefix = std::char_traits<char>::length(name);
+        if (field.size() != prefix + 8 || field.compare(0, prefix, name) != 0)
+        {
+            return false;
+        }
+        checksum = 0;
+        for (std::size_t i = prefix; i < field.size(); ++i)
+        {
+            const char c = field[i];
+            const int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+            if (digit < 0)
+            {
+                return false;
+            }
+            checksum = (checksum << 4) | static_cast<std::uint32_t>(digit);
+        }
+        return true;
+    }
+}
+
+/// <summary>
+/// Check a file written by save_data_file in 5-2 against the checksums in its header. The data is read a
+/// buffer at a time and put back through the cipher with the key from the header, so one pass checks
+/// both that the data is intact and that it turns back into what it was made from.
+/// </summary>
+/// <returns>0 when both checksums match, 1 when either does not, 2 when the file cannot be read</returns>
+inline int verify_data_file(const std::string& filename)
+{
+    std::ifstream infile(filename, std::ios::binary);
+    std::string student_name, date, header;
+    if (!std::getline(infile, student_name) || !std::getline(infile, date) || !std::getline(infile, header))
+    {
+        std::cerr << filename << ": missing header lines" << std::endl;
+        return 2;
+    }
+
+    // key \t cipher \t crc32c=... \t source-crc32c=..., the key may itself contain tabs
+    std::string fields[3];
+    for (int field = 2; field >= 0; --field)
+    {
+        const std::size_t tab = header.rfind('\t');
+        if (tab == std::string::npos)
+        {
+            std::cerr << filename << ": line 3 has no checksums" << std::endl;
+            return 2;
+        }
+        fields[field] = header.substr(tab + 1);
+        header.erase(tab);
+    }
+    const std::string& key = header;
+    const std::string& cipher_name = fields[0];
+    std::uint32_t recorded_data = 0;
+    std::uint32_t recorded_source = 0;
+    if (!saved_data_file_detail::parse_checksum(fields[1], "crc32c=", recorded_data)
+        || !saved_data_file_detail::parse_checksum(fields[2], "source-crc32c=", recorded_source))
+    {
+        std::cerr << filename << ": line 3 has no checksums" << std::endl;
+        return 2;
+    }
+
+    std::unique_ptr<Cipher> cipher;
+    try
+    {
+        cipher = make_cipher(cipher_name, key);
+    }
+    catch (const std::invalid_argument& error)
+    {
+        std::cerr << filename << ": " << error.what() << std::endl;
+        return 2;
+    }
+
+    // the data runs to the end of the file less the newline save_data_file ends it with
+    const std::streamoff data_offset = static_cast<std::streamoff>(infile.tellg());
+    infile.seekg(0, std::ios::end);
+    const std::streamoff data_length = static_cast<std::streamoff>(infile.tellg()) - data_offset - 1;
+    infile.seekg(data_offset);
+    if (data_length < 0)
+    {
+        std::cerr << filename << ": truncated" << std::endl;
+        return 2;
+    }
+
+    StreamChecksums checksums;
+    std::string buffer(1 << 20, '\0');
+    for (std::uint64_t position = 0; position < static_cast<std::uint64_t>(data_length);)
+    {
+        const std::size_t length = static_cast<std::size_t>(std::min<std::uint64_t>(buffer.size(), static_cast<std::uint64_t>(data_length) - position));
+        if (!infile.read(&buffer[0], static_cast<std::streamsize>(length)))
+        {
+            std::cerr << filename << ": read failed" << std::endl;
+            return 2;
+        }
+        cipher->apply_checksummed(buffer.data(), &buffer[0], length, position, checksums);
+        position += length;
+    }
+
+    const bool data_ok = checksums.source == recorded_data;
+    const bool source_ok = checksums.output == recorded_source;
+    std::cout << filename << ": data " << (data_ok ? "OK" : "CORRUPT") << ", " << cipher_name << " round trip " << (source_ok ? "OK" : "MISMATCH") << std::endl;
+    return data_ok && source_ok ? 0 : 1;
+}
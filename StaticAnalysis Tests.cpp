@@ -0,0 +1,775 @@
+// StaticAnalysis Tests.cpp : Tests for the cppcheck report parser, index and snapshots, and the
+// token-level static checks.
+//
+// The report tests read 5-3 Static Testing.xml itself, whose path CMake passes in as
+// STATIC_TESTING_XML. Each static check has a fixture with code it must report and code it must
+// leave alone, and the test lists exactly the findings expected.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "CppcheckReport.h"
+#include "CppcheckSnapshot.h"
+#include "StaticChecks.h"
+
+namespace
+{
+    const std::string static_testing_xml = STATIC_TESTING_XML;
+
+    // every call the parser makes, as "<name a=v ...>" and "</name>"
+    struct EventRecorder
+    {
+        std::vector<std::string> events;
+
+        void start_element(std::string_view name, const std::vector<XmlAttribute>& attributes)
+        {
+            std::string event = "<" + std::string(name);
+            for (const auto& attribute : attributes)
+            {
+                event += " " + std::string(attribute.name) + "=" + std::string(attribute.value);
+            }
+            events.push_back(event + ">");
+        }
+
+        void end_element(std::string_view name)
+        {
+            events.push_back("</" + std::string(name) + ">");
+        }
+    };
+
+    std::vector<std::string> parse_events(std::string_view xml)
+    {
+        EventRecorder recorder;
+        XmlSaxParser<EventRecorder> parser(recorder);
+        parser.parse(xml.data(), xml.size());
+        return recorder.events;
+    }
+
+    std::string read_file(const std::string& filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        std::ostringstream text;
+        text << file.rdbuf();
+        return text.str();
+    }
+
+    // each finding of source as "id line:column msg", followed by its trace as "  line:column info"
+    std::vector<std::string> check(std::string_view source)
+    {
+        std::vector<std::string> found;
+        for (const auto& finding : check_cpp_source(source))
+        {
+            const auto& first = finding.locations.front();
+            found.push_back(std::string(finding.check->id) + " " + std::to_string(first.line) + ":" + std::to_string(first.column) + " " + finding.msg);
+            for (std::size_t i = 1; i < finding.locations.size(); ++i)
+            {
+                const auto& step = finding.locations[i];
+                found.push_back("  " + std::to_string(step.line) + ":" + std::to_string(step.column) + " " + step.info);
+            }
+        }
+        return found;
+    }
+}
+
+TEST(StringPoolTest, InternsEachStringOnce)
+{
+    StringPool pool;
+    EXPECT_EQ(pool.size(), 1u);
+    EXPECT_EQ(pool.find(""), 0u);
+
+    const auto alpha = pool.intern("alpha");
+    const auto beta = pool.intern("beta");
+    EXPECT_NE(alpha, beta);
+    EXPECT_EQ(pool.intern("alpha"), alpha);
+    EXPECT_EQ(pool.intern(std::string_view()), 0u);
+    EXPECT_EQ(pool.find("beta"), beta);
+    EXPECT_EQ(pool.find("gamma"), StringPool::npos);
+    EXPECT_EQ(pool[alpha], "alpha");
+    EXPECT_EQ(pool.bytes(), 9u);
+}
+
+// enough strings to grow the table several times, and some too long to share a block
+TEST(StringPoolTest, ViewsSurviveGrowth)
+{
+    StringPool pool;
+    std::vector<std::string> texts;
+    std::vector<std::uint32_t> ids;
+    for (int i = 0; i < 5000; ++i)
+    {
+        texts.push_back(i % 500 == 0 ? std::string(20000, static_cast<char>('a' + i % 26)) + std::to_string(i) : "string " + std::to_string(i));
+        ids.push_back(pool.intern(texts.back()));
+    }
+
+    EXPECT_EQ(pool.size(), texts.size() + 1);
+    for (std::size_t i = 0; i < texts.size(); ++i)
+    {
+        ASSERT_EQ(pool[ids[i]], texts[i]);
+        ASSERT_EQ(pool.find(texts[i]), ids[i]);
+    }
+}
+
+TEST(StringPoolTest, MovedFromPoolStartsOver)
+{
+    StringPool pool;
+    const auto id = pool.intern("kept");
+
+    StringPool moved(std::move(pool));
+    EXPECT_EQ(moved[id], "kept");
+    EXPECT_EQ(pool.size(), 0u);
+    EXPECT_EQ(pool.bytes(), 0u);
+    EXPECT_EQ(pool.find("kept"), StringPool::npos);
+
+    EXPECT_EQ(pool.intern("fresh"), 1u);
+    EXPECT_EQ(pool.find(""), 0u);
+    EXPECT_EQ(pool[1], "fresh");
+
+    StringPool assigned;
+    assigned = std::move(moved);
+    EXPECT_EQ(assigned.find("kept"), id);
+    EXPECT_EQ(moved.find("kept"), StringPool::npos);
+    EXPECT_EQ(moved.intern("kept"), 1u);
+}
+
+TEST(XmlTextTest, DecodesEntityAndCharacterReferences)
+{
+    std::string scratch;
+    EXPECT_EQ(decode_xml_text("a &amp;lt; b &lt;&gt;&quot;&apos; &#65;&#x42;", scratch), "a &lt; b <>\"' AB");
+    EXPECT_EQ(decode_xml_text("&#x20AC; &#233; &#x1F600;", scratch), "\xe2\x82\xac \xc3\xa9 \xf0\x9f\x98\x80");
+
+    // references it does not understand, and a lone ampersand, are kept as written
+    EXPECT_EQ(decode_xml_text("&unknown; &#xZZ; &#; & tail", scratch), "&unknown; &#xZZ; &#; & tail");
+
+    const std::string_view plain = "no references";
+    EXPECT_EQ(decode_xml_text(plain, scratch).data(), plain.data());
+}
+
+TEST(XmlTextTest, EscapingRoundTrips)
+{
+    const std::string text = "if (a < b && c > 'd') \"e\"\n\tf\r";
+    std::string escaped;
+    append_xml_escaped(escaped, text);
+    EXPECT_EQ(escaped.find_first_of("<>\"'\n\t\r"), std::string::npos);
+
+    std::string scratch;
+    EXPECT_EQ(decode_xml_text(escaped, scratch), text);
+}
+
+TEST(XmlSaxParserTest, SelfClosingElementsGetStartAndEnd)
+{
+    EXPECT_EQ(parse_events("<a><b x=\"1\"/><c y='2' z = \"3\" ></c><d/></a>"),
+              (std::vector<std::string>{"<a>", "<b x=1>", "</b>", "<c y=2 z=3>", "</c>", "<d>", "</d>", "</a>"}));
+}
+
+TEST(XmlSaxParserTest, AttributeValuesAreUndecoded)
+{
+    EXPECT_EQ(parse_events("<e msg=\"a &amp;#039;b&amp;#039; &lt;c&gt;\" q='\"'/>"),
+              (std::vector<std::string>{"<e msg=a &amp;#039;b&amp;#039; &lt;c&gt; q=\">", "</e>"}));
+}
+
+TEST(XmlSaxParserTest, SkipsPrologCommentsCdataAndText)
+{
+    EXPECT_EQ(parse_events("<?xml version=\"1.0\"?>\n<!DOCTYPE results>\n<!-- <hidden/> -->\n<r>text<![CDATA[<x/>]]>more<?pi <y/>?></r>\n"),
+              (std::vector<std::string>{"<r>", "</r>"}));
+}
+
+TEST(XmlSaxParserTest, RejectsMalformedMarkup)
+{
+    for (const std::string_view xml : {"<a><", "<a b>", "<a b=c/>", "</ >", "<a/ >", "<a b='1'", "<>"})
+    {
+        EXPECT_THROW(parse_events(xml), std::runtime_error) << xml;
+    }
+}
+
+// feeding a document in two pieces split at every byte gives the same calls as one piece
+TEST(XmlSaxParserTest, IncompleteMarkupWaitsForTheNextFeed)
+{
+    const std::string xml = "<?xml version=\"1.0\"?><r a=\"1\"><!-- c --><e x='&amp;'/><![CDATA[z]]></r>";
+    const auto expected = parse_events(xml);
+
+    for (std::size_t split = 0; split <= xml.size(); ++split)
+    {
+        EventRecorder recorder;
+        XmlSaxParser<EventRecorder> parser(recorder);
+        const std::size_t consumed = parser.feed(xml.data(), split, false);
+        ASSERT_LE(consumed, split);
+        EXPECT_EQ(parser.offset(), consumed);
+
+        parser.feed(xml.data() + consumed, xml.size() - consumed, true);
+        EXPECT_EQ(recorder.events, expected) << "split at " << split;
+        EXPECT_EQ(parser.offset(), xml.size());
+    }
+}
+
+// a buffer smaller than most tags makes parse_file grow it and carry tags over between reads
+TEST(XmlSaxParserTest, ParseFileMatchesParseInMemory)
+{
+    const auto expected = parse_events(read_file(static_testing_xml));
+    ASSERT_FALSE(expected.empty());
+
+    for (const std::size_t buffer_size : {std::size_t(1), std::size_t(7), std::size_t(64), XmlSaxParser<EventRecorder>::default_buffer_size})
+    {
+        EventRecorder recorder;
+        XmlSaxParser<EventRecorder> parser(recorder);
+        parser.parse_file(static_testing_xml, buffer_size);
+        EXPECT_EQ(recorder.events, expected) << "buffer " << buffer_size;
+    }
+}
+
+TEST(XmlSaxParserTest, ParseFileReportsMissingFiles)
+{
+    EventRecorder recorder;
+    XmlSaxParser<EventRecorder> parser(recorder);
+    EXPECT_THROW(parser.parse_file(static_testing_xml + ".missing"), std::runtime_error);
+}
+
+TEST(CppcheckIndexTest, IndexesStaticTestingReport)
+{
+    const CppcheckIndex index = CppcheckIndex::load(static_testing_xml);
+
+    EXPECT_EQ(index.size(), 18u);
+    EXPECT_EQ(index.format_version(), "2");
+    EXPECT_EQ(index.cppcheck_version(), "2.7");
+
+    EXPECT_EQ(index.with_severity("error").size(), 3u);
+    EXPECT_EQ(index.with_severity("warning").size(), 7u);
+    EXPECT_EQ(index.with_severity("style").size(), 7u);
+    EXPECT_EQ(index.with_severity("performance").size(), 1u);
+    EXPECT_TRUE(index.with_severity("information").empty());
+
+    EXPECT_EQ(index.with_id("shadowVariable").size(), 3u);
+    EXPECT_EQ(index.with_id("unreadVariable").size(), 2u);
+    EXPECT_EQ(index.with_cwe(398).size(), 11u);
+    EXPECT_EQ(index.with_cwe(563).size(), 2u);
+
+    std::size_t locations = 0;
+    for (std::size_t finding = 0; finding < index.size(); ++finding)
+    {
+        locations += index.locations(index[finding]).size();
+    }
+    EXPECT_EQ(locations, 28u);
+
+    const auto at_59 = index.at("StaticCodeAnaylys5-3.cpp", 59);
+    ASSERT_EQ(at_59.size(), 1u);
+    EXPECT_EQ(index.text(index[at_59[0]].id), "autoVariables");
+}
+
+// the report escapes the ampersands of &#039; once more, so one decode leaves the reference itself
+TEST(CppcheckIndexTest, DecodesEntitiesInAttributes)
+{
+    const CppcheckIndex index = CppcheckIndex::load(static_testing_xml);
+
+    const auto& found = index.with_id("invalidContainer");
+    ASSERT_EQ(found.size(), 1u);
+    const CppcheckFinding& finding = index[found[0]];
+
+    EXPECT_EQ(index.text(finding.severity), "error");
+    EXPECT_EQ(finding.cwe, 664u);
+    EXPECT_FALSE(finding.inconclusive);
+    EXPECT_EQ(index.text(finding.msg), "Using iterator to local container &#039;items&#039; that may be invalid.");
+    EXPECT_EQ(finding.msg, finding.verbose);
+
+    std::vector<std::uint32_t> lines;
+    std::vector<std::string_view> infos;
+    for (const auto& location : index.locations(finding))
+    {
+        EXPECT_EQ(index.text(location.file), "StaticCodeAnaylys5-3.cpp");
+        lines.push_back(location.line);
+        infos.push_back(index.text(location.info));
+    }
+    EXPECT_EQ(lines, (std::vector<std::uint32_t>{89, 88, 87, 87, 87, 82}));
+    EXPECT_EQ(infos.front(), "After calling &#039;erase&#039;, iterators or references to the container&#039;s data may be invalid .");
+    EXPECT_EQ(infos[2], "");
+    EXPECT_EQ(infos.back(), "Variable created here.");
+
+    EXPECT_TRUE(index[index.with_id("functionStatic")[0]].inconclusive);
+}
+
+// self-closing <location/> elements and missing attributes, in a report held in memory
+TEST(CppcheckIndexTest, ParsesSelfClosingLocationsAndMissingAttributes)
+{
+    const CppcheckIndex index = CppcheckIndex::parse(
+        "<results version=\"2\"><cppcheck version=\"x\"/><errors>"
+        "<error id=\"a\" severity=\"style\" msg=\"m &lt;1&gt;\"><location file=\"f.cpp\" line=\"3\" column=\"7\"/><location file=\"g.cpp\" line=\"9\"/></error>"
+        "<error id=\"b\" severity=\"style\" msg=\"m\"/>"
+        "<location file=\"outside.cpp\" line=\"1\"/>"
+        "</errors></results>");
+
+    ASSERT_EQ(index.size(), 2u);
+    EXPECT_EQ(index.text(index[0].msg), "m <1>");
+    EXPECT_EQ(index[0].verbose, 0u);
+    EXPECT_EQ(index[0].cwe, 0u);
+    ASSERT_EQ(index.locations(index[0]).size(), 2u);
+    EXPECT_EQ(index.locations(index[0]).begin()->column, 7u);
+    EXPECT_TRUE(index.locations(index[1]).empty());
+
+    EXPECT_EQ(index.in_file("f.cpp"), (std::vector<std::uint32_t>{0}));
+    EXPECT_EQ(index.at("g.cpp", 9), (std::vector<std::uint32_t>{0}));
+    EXPECT_TRUE(index.in_file("outside.cpp").empty());
+}
+
+class CppcheckSnapshotTest : public ::testing::Test
+{
+protected:
+    std::filesystem::path path;
+
+    void SetUp() override
+    {
+        const auto* test = ::testing::UnitTest::GetInstance()->current_test_info();
+        path = std::filesystem::temp_directory_path() / (std::string("cppcheck_snapshot_") + test->name() + ".snapshot");
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(path);
+    }
+
+    // a report with one <error> per finding, each given as id, message and line
+    static CppcheckIndex report(const std::vector<std::tuple<std::string, std::string, int>>& findings)
+    {
+        std::string xml = "<results version=\"2\"><errors>";
+        for (const auto& [id, msg, line] : findings)
+        {
+            xml += "<error id=\"" + id + "\" severity=\"style\" msg=\"" + msg + "\" cwe=\"398\" file0=\"f.cpp\">";
+            xml += "<location file=\"f.cpp\" line=\"" + std::to_string(line) + "\" info=\"here\"/></error>";
+        }
+        return CppcheckIndex::parse(xml + "</errors></results>");
+    }
+
+    // the snapshot file with its header changed by edit, for the corruption tests
+    void rewrite_header(const std::function<void(SnapshotHeader&)>& edit) const
+    {
+        std::string bytes = read_file(path.string());
+        SnapshotHeader header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        edit(header);
+        std::memcpy(&bytes[0], &header, sizeof(header));
+        std::ofstream(path, std::ios::binary) << bytes;
+    }
+};
+
+TEST_F(CppcheckSnapshotTest, RoundTripsTheStaticTestingReport)
+{
+    const CppcheckIndex index = CppcheckIndex::load(static_testing_xml);
+    write_cppcheck_snapshot(path.string(), index);
+    const CppcheckSnapshot snapshot = CppcheckSnapshot::open(path.string());
+
+    ASSERT_EQ(snapshot.size(), index.size());
+    EXPECT_TRUE(std::is_sorted(snapshot.begin(), snapshot.end(), [](const SnapshotRecord& left, const SnapshotRecord& right) {
+        return left.fingerprint < right.fingerprint;
+    }));
+
+    using Row = std::tuple<std::string, std::string, std::string, std::uint32_t, std::string, std::uint32_t>;
+    std::vector<Row> stored;
+    for (const SnapshotRecord& record : snapshot)
+    {
+        stored.emplace_back(snapshot.text(record.id), snapshot.text(record.severity), snapshot.text(record.file), record.line, snapshot.text(record.msg), record.cwe);
+    }
+    std::vector<Row> expected;
+    for (std::size_t number = 0; number < index.size(); ++number)
+    {
+        const CppcheckFinding& finding = index[number];
+        const auto first = index.locations(finding).begin();
+        expected.emplace_back(index.text(finding.id), index.text(finding.severity), index.text(first->file), first->line, index.text(finding.msg), finding.cwe);
+    }
+    std::sort(stored.begin(), stored.end());
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(stored, expected);
+
+    const CppcheckDiff diff = diff_cppcheck_snapshot(snapshot, fingerprint_report(index));
+    EXPECT_TRUE(diff.added.empty());
+    EXPECT_TRUE(diff.fixed.empty());
+    EXPECT_EQ(diff.unchanged.size(), index.size());
+    EXPECT_EQ(snapshot.text(0xffffffffu), "");
+}
+
+// moved lines keep their fingerprint, a changed message does not
+TEST_F(CppcheckSnapshotTest, DiffFindsAddedAndFixedFindings)
+{
+    write_cppcheck_snapshot(path.string(), report({{"a", "first", 10}, {"b", "second", 20}, {"c", "third", 30}}));
+    const CppcheckSnapshot snapshot = CppcheckSnapshot::open(path.string());
+
+    const CppcheckIndex current = report({{"c", "third", 41}, {"a", "first", 12}, {"b", "second  changed", 20}});
+    const CppcheckDiff diff = diff_cppcheck_snapshot(snapshot, fingerprint_report(current));
+
+    ASSERT_EQ(diff.added, (std::vector<std::uint32_t>{2}));
+    ASSERT_EQ(diff.fixed.size(), 1u);
+    EXPECT_EQ(snapshot.text(snapshot[diff.fixed[0]].msg), "second");
+
+    ASSERT_EQ(diff.unchanged.size(), 2u);
+    for (const auto& [record, finding] : diff.unchanged)
+    {
+        EXPECT_EQ(snapshot.text(snapshot[record].id), current.text(current[finding].id));
+    }
+}
+
+// repeats of one finding pair up in line order, and the extra one is fixed
+TEST_F(CppcheckSnapshotTest, DiffPairsRepeatedFindingsInLineOrder)
+{
+    write_cppcheck_snapshot(path.string(), report({{"a", "same", 9}, {"a", "same", 5}}));
+    const CppcheckSnapshot snapshot = CppcheckSnapshot::open(path.string());
+
+    const CppcheckIndex current = report({{"a", "same", 12}});
+    const CppcheckDiff diff = diff_cppcheck_snapshot(snapshot, fingerprint_report(current));
+
+    EXPECT_TRUE(diff.added.empty());
+    ASSERT_EQ(diff.unchanged.size(), 1u);
+    EXPECT_EQ(snapshot[diff.unchanged[0].first].line, 5u);
+    ASSERT_EQ(diff.fixed.size(), 1u);
+    EXPECT_EQ(snapshot[diff.fixed[0]].line, 9u);
+}
+
+// whitespace in a message is normalized, so re-wrapping it keeps the fingerprint
+TEST_F(CppcheckSnapshotTest, FingerprintsIgnoreLinesAndWhitespace)
+{
+    const auto before = fingerprint_report(report({{"a", "one two", 1}}));
+    const auto after = fingerprint_report(report({{"a", "one &#10;  two", 99}}));
+    const auto other = fingerprint_report(report({{"b", "one two", 1}}));
+
+    EXPECT_EQ(before[0].fingerprint, after[0].fingerprint);
+    EXPECT_NE(before[0].fingerprint, other[0].fingerprint);
+}
+
+TEST_F(CppcheckSnapshotTest, RejectsTruncatedFiles)
+{
+    write_cppcheck_snapshot(path.string(), CppcheckIndex::load(static_testing_xml));
+    const std::string bytes = read_file(path.string());
+
+    for (const std::size_t size : {std::size_t(0), std::size_t(8), sizeof(SnapshotHeader) - 1, sizeof(SnapshotHeader), sizeof(SnapshotHeader) + sizeof(SnapshotRecord) * 3,
+                                   bytes.size() / 2, bytes.size() - 1})
+    {
+        std::ofstream(path, std::ios::binary) << bytes.substr(0, size);
+        EXPECT_THROW(CppcheckSnapshot::open(path.string()), std::runtime_error) << "size " << size;
+    }
+
+    std::ofstream(path, std::ios::binary) << bytes;
+    EXPECT_EQ(CppcheckSnapshot::open(path.string()).size(), 18u);
+}
+
+TEST_F(CppcheckSnapshotTest, RejectsCorruptHeaders)
+{
+    write_cppcheck_snapshot(path.string(), CppcheckIndex::load(static_testing_xml));
+    const std::string bytes = read_file(path.string());
+
+    const std::vector<std::function<void(SnapshotHeader&)>> corruptions = {
+        [](SnapshotHeader& header) { header.magic[0] = 'X'; },
+        [](SnapshotHeader& header) { header.byte_order = 0x04030201; },
+        [](SnapshotHeader& header) { header.version = snapshot_version + 1; },
+        [](SnapshotHeader& header) { header.record_size = 24; },
+        [](SnapshotHeader& header) { header.record_count = 0xffffffffffffull; },
+        [](SnapshotHeader& header) { header.records_offset += 4; },
+        [](SnapshotHeader& header) { header.string_count += 1; },
+        [](SnapshotHeader& header) { header.string_count = 0xffffffffffffffffull; },
+        [](SnapshotHeader& header) { header.string_offsets_offset = 0x100000000ull; },
+        [](SnapshotHeader& header) { header.string_data_size += 1; },
+        [](SnapshotHeader& header) { header.string_data_offset = 0xfffffffffff0ull; },
+    };
+
+    for (std::size_t corruption = 0; corruption < corruptions.size(); ++corruption)
+    {
+        std::ofstream(path, std::ios::binary) << bytes;
+        rewrite_header(corruptions[corruption]);
+        EXPECT_THROW(CppcheckSnapshot::open(path.string()), std::runtime_error) << "corruption " << corruption;
+    }
+}
+
+TEST_F(CppcheckSnapshotTest, UpdateReplacesTheWholeFile)
+{
+    write_cppcheck_snapshot(path.string(), report({{"a", "first", 10}, {"b", "second", 20}, {"c", "third", 30}}));
+    {
+        const CppcheckSnapshot old_snapshot = CppcheckSnapshot::open(path.string());
+        write_cppcheck_snapshot(path.string(), report({{"d", "fourth", 40}}));
+#ifndef _WIN32
+        // the new file is renamed over the old one instead of rewriting it, so a reader that has
+        // the old snapshot open keeps seeing all of it
+        std::vector<std::string> messages;
+        for (const SnapshotRecord& record : old_snapshot)
+        {
+            messages.emplace_back(old_snapshot.text(record.msg));
+        }
+        std::sort(messages.begin(), messages.end());
+        EXPECT_EQ(messages, (std::vector<std::string>{ "first", "second", "third" }));
+#endif
+    }
+
+    const CppcheckSnapshot snapshot = CppcheckSnapshot::open(path.string());
+    ASSERT_EQ(snapshot.size(), 1u);
+    EXPECT_EQ(snapshot.text(snapshot[0].msg), "fourth");
+
+    // and no temporary file is left next to it
+    for (const auto& entry : std::filesystem::directory_iterator(path.parent_path()))
+    {
+        EXPECT_NE(entry.path().filename().string().rfind(path.filename().string() + ".", 0), 0u) << entry.path();
+    }
+}
+
+TEST_F(CppcheckSnapshotTest, FailedWriteLeavesTheTargetAlone)
+{
+    // a non-empty directory in the way makes the rename fail after the new snapshot was written
+    const std::filesystem::path blocked = path.string() + ".blocked";
+    std::filesystem::create_directories(blocked / "entry");
+    EXPECT_THROW(write_cppcheck_snapshot(blocked.string(), report({{"a", "first", 10}})), std::runtime_error);
+    EXPECT_TRUE(std::filesystem::is_directory(blocked / "entry"));
+
+    bool leftovers = false;
+    for (const auto& entry : std::filesystem::directory_iterator(path.parent_path()))
+    {
+        leftovers = leftovers || entry.path().filename().string().rfind(blocked.filename().string() + ".", 0) == 0;
+    }
+    std::filesystem::remove_all(blocked);
+    EXPECT_FALSE(leftovers);
+
+    EXPECT_THROW(write_cppcheck_snapshot((path.parent_path() / "missing directory" / "file").string(), report({})), std::runtime_error);
+}
+
+TEST_F(CppcheckSnapshotTest, RejectsOtherFiles)
+{
+    EXPECT_THROW(CppcheckSnapshot::open(path.string()), std::runtime_error);
+    EXPECT_THROW(CppcheckSnapshot::open(static_testing_xml), std::runtime_error);
+}
+
+TEST(StaticChecksTest, ThrowInNoexceptFunction)
+{
+    const char* const source = R"(void direct() noexcept
+{
+    throw 1;
+}
+void caught() noexcept
+{
+    try { throw 2; } catch (...) {}
+}
+void throws() { throw 3; }
+void indirect() noexcept
+{
+    throws();
+}
+void through_lambda() noexcept
+{
+    auto later = [] { throw 4; };
+}
+)";
+
+    EXPECT_EQ(check(source), (std::vector<std::string>{
+                                 "throwInNoexceptFunction 3:5 Exception thrown in function declared not to throw exceptions.",
+                                 "throwInNoexceptFunction 12:5 Exception thrown in function declared not to throw exceptions.",
+                             }));
+}
+
+// only bare noexcept and noexcept(true) promise not to throw; a conditional specification may not
+TEST(StaticChecksTest, ThrowInConditionallyNoexceptFunction)
+{
+    const char* const source = R"(#include <type_traits>
+template <typename T>
+void conditional(T& target, T&& source) noexcept(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_assignable<T>::value)
+{
+    if constexpr (!std::is_nothrow_move_constructible<T>::value)
+    {
+        try { target = static_cast<T&&>(source); } catch (...) { throw; }
+    }
+}
+void declared_true() noexcept(true)
+{
+    throw 1;
+}
+void declared_false() noexcept(false)
+{
+    throw 2;
+}
+)";
+
+    EXPECT_EQ(check(source), (std::vector<std::string>{
+                                 "throwInNoexceptFunction 12:5 Exception thrown in function declared not to throw exceptions.",
+                             }));
+}
+
+TEST(StaticChecksTest, AutoVariables)
+{
+    const char* const source = R"(void address(int* out)
+{
+    int local = 0;
+    *out = &local;
+}
+void array(int** out)
+{
+    int buffer[4];
+    out[0] = buffer;
+    static int kept = 0;
+    *out = &kept;
+}
+void by_value(int out)
+{
+    int local = 0;
+    out = local;
+}
+)";
+
+    EXPECT_EQ(check(source), (std::vector<std::string>{
+                                 "autoVariables 4:5 Address of local auto-variable assigned to a function parameter.",
+                                 "autoVariables 9:5 Address of local auto-variable assigned to a function parameter.",
+                             }));
+}
+
+TEST(StaticChecksTest, InvalidContainer)
+{
+    const char* const source = R"(#include <vector>
+void f(std::vector<int>& shared)
+{
+    std::vector<int> items;
+    for (auto it = items.begin(); it != items.end(); ++it)
+    {
+        items.erase(it);
+    }
+    for (auto it = items.begin(); it != items.end();)
+    {
+        it = items.erase(it);
+    }
+    for (int item : shared)
+    {
+        shared.push_back(item);
+    }
+    for (int item : items)
+    {
+        items.push_back(item);
+        break;
+    }
+}
+)";
+
+    EXPECT_EQ(check(source), (std::vector<std::string>{
+                                 "invalidContainer 7:9 Using iterator to local container 'items' that may be invalid.",
+                                 "  5:5 Iterator to container is created here.",
+                                 "  4:22 Variable created here.",
+                                 "invalidContainer 15:9 Using iterator to container 'shared' that may be invalid.",
+                                 "  13:5 Iterator to container is created here.",
+                             }));
+
+    const auto findings = check_cpp_source(source);
+    ASSERT_EQ(findings.size(), 2u);
+    EXPECT_EQ(findings[0].locations[0].info, "After calling 'erase', iterators or references to the container's data may be invalid .");
+    EXPECT_EQ(findings[1].locations[0].info, "After calling 'push_back', iterators or references to the container's data may be invalid .");
+}
+
+TEST(StaticChecksTest, ShadowVariable)
+{
+    const char* const source = R"(void f()
+{
+    int count = 1;
+    {
+        int count = 2;
+        (void)count;
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        int i2 = i;
+        (void)i2;
+    }
+    auto g = [] { int count = 3; return count; };
+    (void)count;
+}
+)";
+
+    EXPECT_EQ(check(source), (std::vector<std::string>{
+                                 "shadowVariable 5:13 Local variable 'count' shadows outer variable",
+                                 "  3:9 Shadowed declaration",
+                                 "shadowVariable 13:23 Local variable 'count' shadows outer variable",
+                                 "  3:9 Shadowed declaration",
+                             }));
+}
+
+TEST(StaticChecksTest, UnreadVariable)
+{
+    const char* const source = R"(int f()
+{
+    int unused = 1;
+    unused = 2;
+    int used = 3;
+    int copy = used;
+    [[maybe_unused]] int quiet = 4;
+    static int calls = 0;
+    calls = 1;
+    int through_pointer = 5;
+    int* p = &through_pointer;
+    return copy + *p;
+}
+)";
+
+    EXPECT_EQ(check(source), (std::vector<std::string>{
+                                 "unreadVariable 3:9 Variable 'unused' is assigned a value that is never used.",
+                                 "unreadVariable 4:5 Variable 'unused' is assigned a value that is never used.",
+                             }));
+}
+
+TEST(StaticChecksTest, AssertWithSideEffectAndAssignmentInAssert)
+{
+    const char* const source = R"(#include <cassert>
+int counter = 0;
+int bump() { return ++counter; }
+int pure(int x) { int y = x; y = y + 1; return y; }
+void f(int x)
+{
+    assert(bump() > 0);
+    assert(pure(x) > 0);
+    assert(x = 1);
+    assert(x == 1);
+    assert(++x);
+    assert([&] { x = 2; return true; }());
+}
+)";
+
+    EXPECT_EQ(check(source), (std::vector<std::string>{
+                                 "assertWithSideEffect 7:5 Assert statement calls a function which may have desired side effects: 'bump'.",
+                                 "assignmentInAssert 9:5 Assert statement modifies 'x'.",
+                                 "assignmentInAssert 11:5 Assert statement modifies 'x'.",
+                             }));
+}
+
+// tokens inside comments, strings and directives are never code, so none of this is reported
+TEST(StaticChecksTest, IgnoresCommentsStringsAndDirectives)
+{
+    const char* const source = R"(#define FAIL() throw 1
+void f() noexcept
+{
+    // throw 1;
+    /* throw 2; */
+    const char* text = "throw 3;";
+    const char* raw = R"x(assert(x = 1);)x";
+    (void)text;
+    (void)raw;
+}
+)";
+
+    EXPECT_EQ(check(source), std::vector<std::string>{});
+}
+
+// the XML the scanner writes reads back through CppcheckIndex with the same findings
+TEST(StaticChecksTest, WritesReportsTheIndexReads)
+{
+    StaticScanFile file;
+    file.name = "a&b.cpp";
+    file.findings = check_cpp_source("void f(int* out)\n{\n    int local = 0;\n    *out = &local;\n}\nvoid g() noexcept { throw 1; }\n");
+    ASSERT_EQ(file.findings.size(), 2u);
+
+    std::ostringstream xml;
+    write_cppcheck_xml(xml, {file});
+    const CppcheckIndex index = CppcheckIndex::parse(xml.str());
+
+    ASSERT_EQ(index.size(), 2u);
+    EXPECT_EQ(index.cppcheck_version(), static_checks_version);
+    EXPECT_EQ(index.text(index[0].id), "autoVariables");
+    EXPECT_EQ(index[0].cwe, 562u);
+    EXPECT_EQ(index.text(index[0].file0), "a&b.cpp");
+    EXPECT_EQ(index.text(index[1].severity), "error");
+    EXPECT_EQ(index.text(index[1].verbose), file.findings[1].verbose);
+    EXPECT_EQ(index.at("a&b.cpp", 6), (std::vector<std::uint32_t>{1}));
+}
@@ -0,0 +1,115 @@
+// StaticChecks Benchmark.cpp : Tokenizer, checker and parallel file scan throughput.
+//
+// The source is synthetic: functions in the style of this repository, one in eight containing a
+// pattern one of the checks reports, repeated up to --source_kb per file (64 by default). The
+// file scan writes --files copies (200 by default) to a temporary directory and scans them with
+// 1 to 8 threads.
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "BenchmarkMain.h"
+#include "StaticChecks.h"
+
+namespace
+{
+    std::string source;
+    std::vector<std::string> files;
+
+    // one function, clean or with a finding depending on n
+    std::string synthetic_function(std::size_t n)
+    {
+        const std::string id = std::to_string(n);
+        switch (n % 8)
+        {
+        case 0:
+            return "int checked_" + id + "(int value) noexcept\n{\n    if (value < 0)\n        throw std::invalid_argument(\"negative\");\n    return value;\n}\n\n";
+        case 1:
+            return "void publish_" + id + "(int** out)\n{\n    int local = 3;\n    *out = &local;\n}\n\n";
+        case 2:
+            return "void prune_" + id + "(std::vector<int>& keep)\n{\n    std::vector<int> items(keep);\n    for (auto it = items.begin(); it != items.end(); ++it)\n"
+                   "    {\n        if (*it == 2)\n            items.erase(it);\n    }\n}\n\n";
+        case 3:
+            return "int shadowed_" + id + "(int count)\n{\n    int total = 0;\n    for (int i = 0; i < count; ++i)\n    {\n        int total = i * 2;\n"
+                   "        std::cout << total;\n    }\n    return total;\n}\n\n";
+        default:
+            return "/// <summary>\n/// Sum the first count entries\n/// </summary>\nlong long sum_" + id
+                + "(const std::vector<int>& values, std::size_t count)\n{\n    long long sum = 0;\n    for (std::size_t i = 0; i < count && i < values.size(); ++i)\n"
+                  "    {\n        sum += values[i];\n    }\n    const std::string label = \"sum \" + std::to_string(sum);\n    std::cout << label << std::endl;\n"
+                  "    return sum;\n}\n\n";
+        }
+    }
+
+    std::string synthetic_source(std::size_t bytes)
+    {
+        std::string text = "#include <iostream>\n#include <stdexcept>\n#include <string>\n#include <vector>\n\n";
+        for (std::size_t n = 0; text.size() < bytes; ++n)
+        {
+            text += synthetic_function(n);
+        }
+        return text;
+    }
+
+    void BM_Tokenize(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            const auto tokens = tokenize_cpp(source);
+            benchmark::DoNotOptimize(tokens.data());
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * source.size()));
+    }
+
+    void BM_CheckSource(benchmark::State& state)
+    {
+        std::size_t findings = 0;
+        for (auto _ : state)
+        {
+            findings = check_cpp_source(source).size();
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * source.size()));
+        state.counters["findings"] = static_cast<double>(findings);
+    }
+
+    void BM_ScanFiles(benchmark::State& state)
+    {
+        const auto threads = static_cast<unsigned>(state.range(0));
+        std::size_t bytes = 0;
+        for (auto _ : state)
+        {
+            bytes = 0;
+            for (const auto& result : scan_cpp_files(files, threads))
+            {
+                bytes += result.bytes;
+            }
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * bytes));
+        state.counters["files"] = static_cast<double>(files.size());
+    }
+}
+
+BENCHMARK(BM_Tokenize);
+BENCHMARK(BM_CheckSource);
+BENCHMARK(BM_ScanFiles)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+
+int main(int argc, char** argv)
+{
+    const std::size_t source_kb = take_benchmark_option(argc, argv, "source_kb", std::size_t(64));
+    const std::size_t file_count = take_benchmark_option(argc, argv, "files", std::size_t(200));
+    source = synthetic_source(source_kb << 10);
+
+    const auto directory = std::filesystem::temp_directory_path() / "static_checks_benchmark";
+    std::filesystem::create_directories(directory);
+    for (std::size_t file = 0; file < file_count; ++file)
+    {
+        files.push_back((directory / ("file_" + std::to_string(file) + ".cpp")).string());
+        std::ofstream(files.back(), std::ios::binary) << source;
+    }
+
+    const int result = run_benchmarks(argc, argv);
+    std::filesystem::remove_all(directory);
+    return result;
+}
@@ -0,0 +1,1617 @@
+// StaticChecks.h : Token-level versions of a few cppcheck checks, fast enough to run before every commit.
+//
+// The checks are the ones 5-3 Static Testing.xml reports that a token stream is enough for:
+// throwInNoexceptFunction, autoVariables, invalidContainer, shadowVariable, unreadVariable,
+// assertWithSideEffect and assignmentInAssert. There is no preprocessor, type system or data flow, so
+// each check looks for the shape of code cppcheck reports and stays quiet whenever the code does
+// something it cannot follow. Findings are written in cppcheck's XML format, so CppcheckIndex and the
+// snapshot diff read them like a real report.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "CppcheckReport.h"
+#include "MappedFile.h"
+
+enum class CppTokenKind : std::uint8_t
+{
+    identifier,
+    number,
+    string,
+    character,
+    punctuator,
+    end
+};
+
+/// <summary>
+/// One token of C++ source. The text points into the source, and every bracket knows the
+/// index of its partner so a check can step over a whole parenthesised expression or block.
+/// </summary>
+struct CppToken
+{
+    std::string_view text;
+    std::uint32_t line = 0;
+    std::uint32_t column = 0;
+    // matching bracket for ( [ { and ) ] }, the end token for an unclosed one, otherwise the token itself
+    std::uint32_t link = 0;
+    CppTokenKind kind = CppTokenKind::end;
+};
+
+namespace static_checks_detail
+{
+    inline bool is_identifier_start(char c) noexcept
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || static_cast<unsigned char>(c) >= 0x80;
+    }
+
+    inline bool is_digit(char c) noexcept
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    inline bool is_identifier_char(char c) noexcept
+    {
+        return is_identifier_start(c) || is_digit(c);
+    }
+
+    // identifiers that turn the quote after them into part of a string or character literal
+    inline bool is_literal_prefix(std::string_view word) noexcept
+    {
+        return word == "L" || word == "u" || word == "U" || word == "u8" || word == "R" || word == "LR" || word == "uR" || word == "UR" || word == "u8R";
+    }
+
+    // length of the punctuator at p, matching the longest one: ->* before -> before -
+    inline std::size_t punctuator_length(const char* p, const char* end) noexcept
+    {
+        const char next = p + 1 < end ? p[1] : '\0';
+        const char third = p + 2 < end ? p[2] : '\0';
+        switch (*p)
+        {
+        case ':':
+            return next == ':' ? 2 : 1;
+        case '-':
+            if (next == '>')
+                return third == '*' ? 3 : 2;
+            return next == '-' || next == '=' ? 2 : 1;
+        case '+':
+        case '&':
+        case '|':
+            return next == *p || next == '=' ? 2 : 1;
+        case '<':
+        case '>':
+            if (next == *p)
+                return third == '=' ? 3 : 2;
+            if (*p == '<' && next == '=' && third == '>')
+                return 3;
+            return next == '=' ? 2 : 1;
+        case '.':
+            if (next == '.' && third == '.')
+                return 3;
+            return next == '*' ? 2 : 1;
+        case '#':
+            return next == '#' ? 2 : 1;
+        case '=':
+        case '!':
+        case '*':
+        case '/':
+        case '%':
+        case '^':
+            return next == '=' ? 2 : 1;
+        default:
+            return 1;
+        }
+    }
+
+    // p is at the opening quote; returns the position just after the closing one
+    inline const char* skip_quoted(const char* p, const char* end, bool raw, std::uint32_t& line, const char*& line_start) noexcept
+    {
+        const char quote = *p++;
+        if (raw && quote == '"')
+        { // R"delimiter( ... )delimiter"
+            const char* const delimiter = p;
+            while (p < end && *p != '(' && *p != '"' && *p != '\n')
+            {
+                ++p;
+            }
+            const std::string_view closing(delimiter, static_cast<std::size_t>(p - delimiter));
+            for (; p < end; ++p)
+            {
+                if (*p == '\n')
+                {
+                    ++line;
+                    line_start = p + 1;
+                }
+                else if (*p == ')' && end - p > static_cast<std::ptrdiff_t>(closing.size() + 1) && std::string_view(p + 1, closing.size()) == closing
+                         && p[closing.size() + 1] == '"')
+                {
+                    return p + closing.size() + 2;
+                }
+            }
+            return end;
+        }
+
+        // an unterminated literal ends at the end of the line
+        while (p < end && *p != quote && *p != '\n')
+        {
+            if (*p == '\\' && p + 1 < end)
+            {
+                if (p[1] == '\n')
+                {
+                    ++line;
+                    line_start = p + 2;
+                }
+                p += 2;
+            }
+            else
+            {
+                ++p;
+            }
+        }
+        return p < end && *p == quote ? p + 1 : p;
+    }
+}
+
+/// <summary>
+/// Split C++ source into tokens. Comments and preprocessor directives are dropped, literals are
+/// kept whole, and ( [ { are linked to their closing brackets. The last token is always an end
+/// token with empty text, so looking one token ahead never needs a bounds check.
+/// </summary>
+inline std::vector<CppToken> tokenize_cpp(std::string_view source)
+{
+    using namespace static_checks_detail;
+
+    std::vector<CppToken> tokens;
+    tokens.reserve(source.size() / 5 + 1);
+    std::vector<std::uint32_t> open;
+
+    const char* const end = source.data() + source.size();
+    const char* p = source.data();
+    const char* line_start = p;
+    std::uint32_t line = 1;
+    bool first_on_line = true;
+
+    while (p < end)
+    {
+        const char c = *p;
+        if (c == '\n')
+        {
+            ++line;
+            line_start = ++p;
+            first_on_line = true;
+            continue;
+        }
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v')
+        {
+            ++p;
+            continue;
+        }
+        if (c == '/' && p + 1 < end && p[1] == '/')
+        {
+            const void* const newline = std::memchr(p, '\n', static_cast<std::size_t>(end - p));
+            p = newline != nullptr ? static_cast<const char*>(newline) : end;
+            continue;
+        }
+        if (c == '/' && p + 1 < end && p[1] == '*')
+        {
+            p += 2;
+            while (p < end && !(*p == '*' && p + 1 < end && p[1] == '/'))
+            {
+                if (*p == '\n')
+                {
+                    ++line;
+                    line_start = p + 1;
+                }
+                ++p;
+            }
+            p = end - p > 2 ? p + 2 : end;
+            continue;
+        }
+        if (c == '#' && first_on_line)
+        { // a directive runs to the end of the line, or further with backslash continuations
+            while (p < end && *p != '\n')
+            {
+                if (*p == '\\' && p + 1 < end && (p[1] == '\n' || (p[1] == '\r' && p + 2 < end && p[2] == '\n')))
+                {
+                    p += p[1] == '\r' ? 2 : 1;
+                    ++line;
+                    line_start = p + 1;
+                }
+                ++p;
+            }
+            continue;
+        }
+
+        first_on_line = false;
+        CppToken token;
+        token.line = line;
+        token.column = static_cast<std::uint32_t>(p - line_start + 1);
+        const char* const start = p;
+
+        if (is_identifier_start(c))
+        {
+            while (p < end && is_identifier_char(*p))
+            {
+                ++p;
+            }
+            const std::string_view word(start, static_cast<std::size_t>(p - start));
+            if (p < end && (*p == '"' || *p == '\'') && is_literal_prefix(word))
+            {
+                token.kind = *p == '"' ? CppTokenKind::string : CppTokenKind::character;
+                p = skip_quoted(p, end, word.back() == 'R', line, line_start);
+            }
+            else
+            {
+                token.kind = CppTokenKind::identifier;
+            }
+        }
+        else if (is_digit(c) || (c == '.' && p + 1 < end && is_digit(p[1])))
+        {
+            for (++p; p < end; ++p)
+            {
+                const bool separator = *p == '\'' && p + 1 < end && is_identifier_char(p[1]);
+                const bool exponent_sign = (*p == '+' || *p == '-') && (p[-1] == 'e' || p[-1] == 'E' || p[-1] == 'p' || p[-1] == 'P');
+                if (!is_identifier_char(*p) && *p != '.' && !separator && !exponent_sign)
+                {
+                    break;
+                }
+            }
+            token.kind = CppTokenKind::number;
+        }
+        else if (c == '"' || c == '\'')
+        {
+            token.kind = c == '"' ? CppTokenKind::string : CppTokenKind::character;
+            p = skip_quoted(p, end, false, line, line_start);
+        }
+        else
+        {
+            p += punctuator_length(p, end);
+            token.kind = CppTokenKind::punctuator;
+        }
+
+        token.text = std::string_view(start, static_cast<std::size_t>(p - start));
+        const auto index = static_cast<std::uint32_t>(tokens.size());
+        token.link = index;
+        if (token.kind == CppTokenKind::punctuator && token.text.size() == 1)
+        {
+            if (c == '(' || c == '[' || c == '{')
+            {
+                open.push_back(index);
+            }
+            else if ((c == ')' || c == ']' || c == '}') && !open.empty())
+            { // a close that does not match is left unlinked, usually the result of #if branches
+                const char opening = tokens[open.back()].text[0];
+                if ((c == ')' && opening == '(') || (c == ']' && opening == '[') || (c == '}' && opening == '{'))
+                {
+                    token.link = open.back();
+                    tokens[open.back()].link = index;
+                    open.pop_back();
+                }
+            }
+        }
+        tokens.push_back(token);
+    }
+
+    CppToken last;
+    last.line = line;
+    last.link = static_cast<std::uint32_t>(tokens.size());
+    for (const auto unclosed : open)
+    {
+        tokens[unclosed].link = last.link;
+    }
+    tokens.push_back(last);
+    return tokens;
+}
+
+/// <summary>
+/// A check the scanner runs, with the id, severity and CWE cppcheck reports it under
+/// </summary>
+struct StaticCheck
+{
+    std::string_view id;
+    std::string_view severity;
+    std::uint32_t cwe;
+};
+
+inline constexpr StaticCheck throw_in_noexcept_check{ "throwInNoexceptFunction", "error", 398 };
+inline constexpr StaticCheck auto_variables_check{ "autoVariables", "error", 562 };
+inline constexpr StaticCheck invalid_container_check{ "invalidContainer", "error", 664 };
+inline constexpr StaticCheck shadow_variable_check{ "shadowVariable", "style", 398 };
+inline constexpr StaticCheck unread_variable_check{ "unreadVariable", "style", 563 };
+inline constexpr StaticCheck assert_with_side_effect_check{ "assertWithSideEffect", "warning", 398 };
+inline constexpr StaticCheck assignment_in_assert_check{ "assignmentInAssert", "warning", 398 };
+
+struct StaticLocation
+{
+    std::uint32_t line = 0;
+    std::uint32_t column = 0;
+    std::string info;
+};
+
+struct StaticFinding
+{
+    const StaticCheck* check = nullptr;
+    std::string msg;
+    std::string verbose;
+    // the location the finding is reported at first, then the trace that leads to it
+    std::vector<StaticLocation> locations;
+};
+
+namespace static_checks_detail
+{
+    // words that can start a statement but never a declaration
+    inline bool is_keyword(std::string_view word) noexcept
+    {
+        static constexpr std::string_view keywords[] = { "return", "throw", "delete", "new", "goto", "case", "default", "else", "do", "if", "for",
+                                                         "while", "switch", "try", "catch", "break", "continue", "using", "typedef", "namespace",
+                                                         "template", "operator", "sizeof", "alignof", "alignas", "decltype", "static_assert", "noexcept",
+                                                         "co_return", "co_await", "co_yield", "public", "private", "protected", "friend", "this", "true",
+                                                         "false", "nullptr", "requires", "asm", "constexpr", "struct", "class", "union", "enum" };
+        return std::find(std::begin(keywords), std::end(keywords), word) != std::end(keywords);
+    }
+
+    inline bool is_builtin_type(std::string_view word) noexcept
+    {
+        static constexpr std::string_view types[] = { "void", "bool", "char", "char8_t", "char16_t", "char32_t", "wchar_t", "short", "int",
+                                                      "long", "signed", "unsigned", "float", "double", "size_t", "ptrdiff_t" };
+        if (std::find(std::begin(types), std::end(types), word) != std::end(types))
+        {
+            return true;
+        }
+        // int32_t, uint_fast8_t, intptr_t and the rest of <cstdint>
+        return word.size() > 2 && word.substr(word.size() - 2) == "_t" && (word.substr(0, 3) == "int" || word.substr(0, 4) == "uint");
+    }
+
+    inline bool is_assignment(std::string_view text) noexcept
+    {
+        return text == "=" || text == "+=" || text == "-=" || text == "*=" || text == "/=" || text == "%=" || text == "&=" || text == "|=" || text == "^="
+            || text == "<<=" || text == ">>=";
+    }
+
+    // container member functions that can invalidate iterators, pointers and references into it
+    inline bool invalidates_iterators(std::string_view member) noexcept
+    {
+        static constexpr std::string_view members[] = { "push_back", "emplace_back", "push_front", "emplace_front", "insert", "emplace",
+                                                         "erase", "clear", "resize", "reserve", "assign", "shrink_to_fit" };
+        return std::find(std::begin(members), std::end(members), member) != std::end(members);
+    }
+
+    inline std::string quoted(std::string_view text)
+    {
+        std::string result;
+        result.reserve(text.size() + 2);
+        result += '\'';
+        result += text;
+        result += '\'';
+        return result;
+    }
+
+    constexpr std::string_view assert_release_note
+        = " Assert statements are removed from release builds so the code inside assert statement is not executed. If the code is needed also in release builds, this is a bug.";
+}
+
+/// <summary>
+/// Runs every check over one source file. Functions are found first, then each body is walked
+/// once with a stack of scopes that tracks the variables declared so far.
+/// </summary>
+class CppSourceChecker
+{
+public:
+    explicit CppSourceChecker(std::string_view source)
+        : tokens_(tokenize_cpp(source)), end_(static_cast<std::uint32_t>(tokens_.size() - 1))
+    {
+    }
+
+    std::vector<StaticFinding> run()
+    {
+        find_functions();
+        for (auto& function : functions_)
+        {
+            walk(function);
+        }
+        check_noexcept_functions();
+        check_asserts();
+
+        std::stable_sort(findings_.begin(), findings_.end(), [](const StaticFinding& left, const StaticFinding& right) {
+            const auto& a = left.locations.front();
+            const auto& b = right.locations.front();
+            return a.line != b.line ? a.line < b.line : a.column < b.column;
+        });
+        return std::move(findings_);
+    }
+
+    const std::vector<CppToken>& tokens() const noexcept
+    {
+        return tokens_;
+    }
+
+private:
+    struct Parameter
+    {
+        std::string_view name;
+        bool is_pointer = false;
+        bool by_value = false;
+    };
+
+    enum class Answer : std::uint8_t
+    {
+        unknown,
+        checking,
+        no,
+        yes
+    };
+
+    struct Function
+    {
+        std::string_view name;
+        std::uint32_t params_open = 0;
+        std::uint32_t body_open = 0;
+        bool is_noexcept = false;
+        bool is_const = false;
+        std::vector<Parameter> parameters;
+        // variables declared in the body, except static ones
+        std::vector<std::string_view> locals;
+        Answer throws = Answer::unknown;
+        std::uint32_t throw_token = 0;
+        Answer side_effects = Answer::unknown;
+    };
+
+    struct Variable
+    {
+        std::string_view name;
+        std::uint32_t token = 0;
+        // last token of the scope the variable is declared in
+        std::uint32_t scope_end = 0;
+        bool is_static = false;
+        bool is_pointer = false;
+        bool is_reference = false;
+        bool is_array = false;
+        bool is_trivial = false;
+        bool maybe_unused = false;
+        bool initialized = false;
+    };
+
+    struct Declaration
+    {
+        std::vector<Variable> variables;
+        // where walking resumes, just after the first declared name
+        std::uint32_t resume = 0;
+    };
+
+    struct Scope
+    {
+        std::uint32_t end;
+        std::size_t first_visible;
+    };
+
+    const CppToken& at(std::uint32_t i) const noexcept
+    {
+        return tokens_[std::min(i, end_)];
+    }
+
+    bool is(std::uint32_t i, std::string_view text) const noexcept
+    {
+        return at(i).text == text;
+    }
+
+    bool identifier(std::uint32_t i) const noexcept
+    {
+        return at(i).kind == CppTokenKind::identifier;
+    }
+
+    std::uint32_t link(std::uint32_t i) const noexcept
+    {
+        return at(i).link;
+    }
+
+    // i follows . or -> so it names a member, not a variable or free function
+    bool member(std::uint32_t i) const noexcept
+    {
+        return i > 0 && (is(i - 1, ".") || is(i - 1, "->"));
+    }
+
+    bool plain_call(std::uint32_t i) const noexcept
+    {
+        return identifier(i) && is(i + 1, "(") && !member(i) && !static_checks_detail::is_keyword(at(i).text);
+    }
+
+    void report(const StaticCheck& check, std::string msg, std::string verbose, std::vector<StaticLocation> locations)
+    {
+        findings_.push_back({ &check, std::move(msg), std::move(verbose), std::move(locations) });
+    }
+
+    StaticLocation location(std::uint32_t i, std::string info = std::string()) const
+    {
+        return { at(i).line, at(i).column, std::move(info) };
+    }
+
+    // i is at <; returns the index after the matching >, or i when it is a comparison instead
+    std::uint32_t skip_template(std::uint32_t i) const noexcept
+    {
+        int depth = 0;
+        for (std::uint32_t j = i; j < end_; ++j)
+        {
+            const std::string_view text = tokens_[j].text;
+            if (text == "<")
+            {
+                ++depth;
+            }
+            else if (text == ">" || text == ">>")
+            {
+                depth -= static_cast<int>(text.size());
+                if (depth <= 0)
+                {
+                    return depth == 0 ? j + 1 : i;
+                }
+            }
+            else if (text == "(" || text == "[")
+            {
+                j = tokens_[j].link;
+            }
+            else if (text == ";" || text == "{" || text == "}" || text == ")" || text == "]" || text == "&&" || text == "||")
+            {
+                return i;
+            }
+        }
+        return i;
+    }
+
+    // i is at [; returns the { of the lambda body when it starts a lambda, otherwise 0
+    std::uint32_t lambda_body(std::uint32_t i) const noexcept
+    {
+        if (is(i + 1, "[") || (i > 0 && (identifier(i - 1) || is(i - 1, ")") || is(i - 1, "]") || at(i - 1).kind == CppTokenKind::string)))
+        { // an attribute or a subscript
+            return 0;
+        }
+        std::uint32_t j = link(i) + 1;
+        if (is(j, "("))
+        {
+            j = link(j) + 1;
+        }
+        else if (!is(j, "{"))
+        {
+            return 0;
+        }
+        while (j < end_ && !is(j, "{") && !is(j, ";") && !is(j, ")") && !is(j, "}"))
+        {
+            j = is(j, "(") ? link(j) + 1 : j + 1;
+        }
+        return is(j, "{") ? j : 0;
+    }
+
+    // the last token of the statement that starts at i
+    std::uint32_t statement_end(std::uint32_t i, std::uint32_t limit) const noexcept
+    {
+        for (std::uint32_t j = i; j < limit; ++j)
+        {
+            if (is(j, "{"))
+            {
+                return link(j);
+            }
+            if (is(j, "(") || is(j, "["))
+            {
+                j = link(j);
+            }
+            else if (is(j, ";"))
+            {
+                return j;
+            }
+        }
+        return limit;
+    }
+
+    // the index of the , ; or closing bracket that ends the expression starting at i
+    std::uint32_t expression_end(std::uint32_t i, std::uint32_t limit) const noexcept
+    {
+        std::uint32_t j = i;
+        for (; j < limit; ++j)
+        {
+            const std::string_view text = at(j).text;
+            if (text == "(" || text == "[" || text == "{")
+            {
+                j = link(j);
+            }
+            else if (text == "," || text == ";" || text == ")" || text == "]" || text == "}")
+            {
+                break;
+            }
+        }
+        return j;
+    }
+
+    void find_functions()
+    {
+        for (std::uint32_t i = 0; i + 1 < end_; ++i)
+        {
+            std::uint32_t params = i + 1;
+            if (is(i, "operator"))
+            { // operator() and the symbol operators
+                params = is(i + 1, "(") && is(i + 2, ")") ? i + 3 : i + 1;
+                while (params < i + 4 && !is(params, "("))
+                {
+                    ++params;
+                }
+            }
+            else if (!identifier(i) || member(i) || static_checks_detail::is_keyword(at(i).text) || at(i).text == "assert")
+            {
+                continue;
+            }
+            if (!is(params, "("))
+            {
+                continue;
+            }
+
+            std::uint32_t after = link(params) + 1;
+            if (is(after, "("))
+            { // a macro such as BENCHMARK_DEFINE_F(fixture, name) followed by the real parameter list
+                params = after;
+                after = link(after) + 1;
+            }
+
+            Function function;
+            function.name = at(i).text;
+            function.params_open = params;
+            for (;;)
+            {
+                const std::string_view text = at(after).text;
+                if (text == "const")
+                {
+                    function.is_const = true;
+                    ++after;
+                }
+                else if (text == "volatile" || text == "&" || text == "&&" || text == "override" || text == "final")
+                {
+                    ++after;
+                }
+                else if (text == "noexcept")
+                {
+                    function.is_noexcept = true;
+                    ++after;
+                    if (is(after, "("))
+                    { // only noexcept(true) is certain; noexcept(false) and conditional ones such as
+                      // noexcept(std::is_nothrow_move_constructible<T>::value) may throw
+                        function.is_noexcept = is(after + 1, "true") && is(after + 2, ")");
+                        after = link(after) + 1;
+                    }
+                }
+                else if (text == "throw" && is(after + 1, "("))
+                { // the old dynamic exception specification, throw() means noexcept
+                    function.is_noexcept = is(after + 2, ")");
+                    after = link(after + 1) + 1;
+                }
+                else if (text == "->")
+                { // trailing return type
+                    ++after;
+                    while (after < end_ && !is(after, "{") && !is(after, ";") && !is(after, "="))
+                    {
+                        after = is(after, "(") || is(after, "[") ? link(after) + 1 : after + 1;
+                    }
+                }
+                else
+                {
+                    break;
+                }
+            }
+
+            if (is(after, ":"))
+            { // constructor initializer list
+                ++after;
+                for (;;)
+                {
+                    while (identifier(after) || is(after, "::"))
+                    {
+                        ++after;
+                        if (is(after, "<"))
+                        {
+                            after = skip_template(after);
+                        }
+                    }
+                    if (!is(after, "(") && !is(after, "{"))
+                    {
+                        break;
+                    }
+                    after = link(after) + 1;
+                    if (is(after, "..."))
+                    {
+                        ++after;
+                    }
+                    if (!is(after, ","))
+                    {
+                        break;
+                    }
+                    ++after;
+                }
+            }
+            if (is(after, "try"))
+            {
+                ++after;
+            }
+            if (!is(after, "{"))
+            {
+                continue;
+            }
+
+            function.body_open = after;
+            parse_parameters(function);
+            functions_.push_back(std::move(function));
+            // nested bodies, such as lambdas and local classes, are walked as part of this one
+            i = link(after);
+        }
+
+        by_name_.resize(functions_.size());
+        std::iota(by_name_.begin(), by_name_.end(), 0u);
+        std::sort(by_name_.begin(), by_name_.end(), [this](std::uint32_t left, std::uint32_t right) { return functions_[left].name < functions_[right].name; });
+    }
+
+    void parse_parameters(Function& function) const
+    {
+        const std::uint32_t close = link(function.params_open);
+        std::uint32_t start = function.params_open + 1;
+        int angle = 0;
+        for (std::uint32_t j = start; j <= close; ++j)
+        {
+            if (j < close)
+            {
+                const std::string_view text = at(j).text;
+                if (text == "(" || text == "[" || text == "{")
+                {
+                    j = link(j);
+                }
+                else if (text == "<")
+                {
+                    ++angle;
+                }
+                else if (text == ">" || text == ">>")
+                {
+                    angle -= static_cast<int>(text.size());
+                }
+                if (text != "," || angle > 0)
+                {
+                    continue;
+                }
+            }
+            add_parameter(function, start, j);
+            start = j + 1;
+        }
+    }
+
+    void add_parameter(Function& function, std::uint32_t begin, std::uint32_t end) const
+    {
+        for (std::uint32_t j = begin; j < end; ++j)
+        {
+            if (is(j, "="))
+            { // default argument
+                end = j;
+                break;
+            }
+        }
+        if (end <= begin)
+        {
+            return;
+        }
+
+        std::uint32_t name = end - 1;
+        bool is_array = false;
+        if (is(name, "]"))
+        {
+            is_array = true;
+            name = link(name) - 1;
+        }
+        if (name <= begin || !identifier(name) || is(name - 1, "::") || static_checks_detail::is_builtin_type(at(name).text)
+            || static_checks_detail::is_keyword(at(name).text))
+        {
+            return;
+        }
+
+        bool has_type = false;
+        bool is_pointer = is_array;
+        bool is_reference = false;
+        for (std::uint32_t j = begin; j < name; ++j)
+        {
+            const std::string_view text = at(j).text;
+            has_type |= (identifier(j) && text != "const" && text != "volatile") || text == ">";
+            is_pointer |= text == "*";
+            is_reference |= text == "&" || text == "&&";
+        }
+        if (has_type)
+        {
+            function.parameters.push_back({ at(name).text, is_pointer, !is_pointer && !is_reference });
+        }
+    }
+
+    // parses the declaration that starts at i, returning false if the tokens there are not one
+    bool parse_declaration(std::uint32_t i, std::uint32_t limit, bool in_catch, Declaration& declaration) const
+    {
+        using namespace static_checks_detail;
+
+        std::uint32_t j = i;
+        bool is_static = false;
+        bool maybe_unused = false;
+        for (;;)
+        {
+            const std::string_view text = at(j).text;
+            if (text == "[" && is(j + 1, "["))
+            { // an attribute
+                for (std::uint32_t k = j; k < link(j); ++k)
+                {
+                    maybe_unused |= is(k, "maybe_unused");
+                }
+                j = link(j) + 1;
+            }
+            else if (text == "static" || text == "thread_local")
+            {
+                is_static = true;
+                ++j;
+            }
+            else if (text == "const" || text == "volatile" || text == "register" || text == "mutable" || text == "typename" || text == "inline")
+            {
+                ++j;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        // the type, one or more names that may be qualified or have template arguments
+        std::uint32_t units = 0;
+        std::uint32_t non_builtin_units = 0;
+        std::uint32_t last_unit = 0;
+        bool last_unit_plain = false;
+        if (is(j, "::"))
+        {
+            ++j;
+        }
+        while (identifier(j) && !is_keyword(at(j).text))
+        {
+            const std::uint32_t unit = j;
+            std::string_view name = at(j).text;
+            ++j;
+            while (is(j, "::") && identifier(j + 1))
+            {
+                name = at(j + 1).text;
+                j += 2;
+            }
+            bool plain = j == unit + 1;
+            if (is(j, "<"))
+            {
+                const std::uint32_t after = skip_template(j);
+                if (after == j)
+                {
+                    return false;
+                }
+                j = after;
+                plain = false;
+            }
+            ++units;
+            non_builtin_units += is_builtin_type(name) ? 0 : 1;
+            last_unit = unit;
+            last_unit_plain = plain;
+            while (is(j, "const") || is(j, "volatile"))
+            {
+                ++j;
+            }
+        }
+
+        Variable first;
+        first.is_static = is_static;
+        first.maybe_unused = maybe_unused;
+        std::uint32_t name = j;
+        while (is(name, "*") || is(name, "&") || is(name, "&&") || is(name, "const") || is(name, "volatile"))
+        {
+            first.is_pointer |= is(name, "*");
+            first.is_reference |= is(name, "&") || is(name, "&&");
+            ++name;
+        }
+        if (name != j)
+        {
+            if (units == 0 || !identifier(name) || is_keyword(at(name).text))
+            {
+                return false;
+            }
+        }
+        else
+        { // no * or &, so the last name read as part of the type is the variable
+            if (units < 2 || !last_unit_plain)
+            {
+                return false;
+            }
+            name = last_unit;
+            --units;
+            non_builtin_units -= is_builtin_type(at(name).text) ? 0 : 1;
+        }
+        if (is_builtin_type(at(name).text))
+        {
+            return false;
+        }
+
+        const std::string_view next = at(name + 1).text;
+        if (next != "=" && next != ";" && next != "," && next != "[" && next != "{" && next != "(" && next != ":" && !(in_catch && next == ")"))
+        {
+            return false;
+        }
+
+        first.is_trivial = units > 0 && (non_builtin_units == 0 || first.is_pointer) && !first.is_reference;
+        first.name = at(name).text;
+        first.token = name;
+        declaration.variables.clear();
+        declaration.variables.push_back(first);
+        declaration.resume = name + 1;
+
+        // array bounds, initializers and any further names declared in the same statement
+        j = name + 1;
+        for (;;)
+        {
+            Variable& variable = declaration.variables.back();
+            while (is(j, "["))
+            {
+                variable.is_array = true;
+                j = link(j) + 1;
+            }
+            if (is(j, "="))
+            {
+                variable.initialized = true;
+                j = expression_end(j + 1, limit);
+            }
+            else if (is(j, "(") || is(j, "{"))
+            {
+                variable.initialized = true;
+                j = link(j) + 1;
+            }
+            if (!is(j, ",") || in_catch)
+            {
+                break;
+            }
+
+            Variable another = first;
+            another.is_pointer = false;
+            another.is_reference = false;
+            ++j;
+            while (is(j, "*") || is(j, "&") || is(j, "&&") || is(j, "const"))
+            {
+                another.is_pointer |= is(j, "*");
+                another.is_reference |= is(j, "&") || is(j, "&&");
+                ++j;
+            }
+            if (!identifier(j) || is_keyword(at(j).text) || is_builtin_type(at(j).text))
+            {
+                break;
+            }
+            another.is_trivial = units > 0 && (non_builtin_units == 0 || another.is_pointer) && !another.is_reference;
+            another.name = at(j).text;
+            another.token = j;
+            declaration.variables.push_back(another);
+            ++j;
+        }
+        return true;
+    }
+
+    static const Variable* find_visible(const std::vector<Variable>& variables, const std::vector<std::uint32_t>& visible, std::size_t count, std::string_view name)
+    {
+        for (std::size_t k = count; k-- > 0;)
+        {
+            if (variables[visible[k]].name == name)
+            {
+                return &variables[visible[k]];
+            }
+        }
+        return nullptr;
+    }
+
+    static const Parameter* find_parameter(const Function& function, std::string_view name)
+    {
+        for (const auto& parameter : function.parameters)
+        {
+            if (parameter.name == name)
+            {
+                return &parameter;
+            }
+        }
+        return nullptr;
+    }
+
+    // walks a function body once for shadowVariable, autoVariables, invalidContainer and unreadVariable
+    void walk(Function& function)
+    {
+        const std::uint32_t body_close = link(function.body_open);
+        std::vector<Variable> variables;
+        std::vector<std::uint32_t> visible;
+        std::vector<Scope> scopes{ { body_close, 0 } };
+        // closing parentheses of control statement headers still to come
+        std::vector<std::uint32_t> headers;
+        std::uint32_t statement = function.body_open + 1;
+        bool statement_start = true;
+        Declaration declaration;
+
+        const auto declare = [&](Declaration& declared) {
+            for (auto& variable : declared.variables)
+            {
+                const Variable* outer = find_visible(variables, visible, scopes.back().first_visible, variable.name);
+                if (outer != nullptr)
+                {
+                    const std::string name = static_checks_detail::quoted(variable.name);
+                    report(shadow_variable_check, "Local variable " + name + " shadows outer variable", "Local variable " + name + " shadows outer variable",
+                           { location(variable.token, "Shadow variable"), location(outer->token, "Shadowed declaration") });
+                }
+                variable.scope_end = scopes.back().end;
+                visible.push_back(static_cast<std::uint32_t>(variables.size()));
+                variables.push_back(variable);
+            }
+        };
+
+        for (std::uint32_t i = function.body_open + 1; i < body_close;)
+        {
+            while (scopes.size() > 1 && i > scopes.back().end)
+            {
+                visible.resize(scopes.back().first_visible);
+                scopes.pop_back();
+            }
+            if (!headers.empty() && headers.back() == i)
+            {
+                headers.pop_back();
+                statement = i + 1;
+                statement_start = true;
+                ++i;
+                continue;
+            }
+
+            const std::string_view text = at(i).text;
+            if (statement_start)
+            {
+                statement_start = false;
+                statement = i;
+                if (text == "*" || (identifier(i) && is(i + 1, "[")))
+                {
+                    check_auto_variable(function, variables, visible, i);
+                }
+                if ((identifier(i) || text == "::" || text == "[") && parse_declaration(i, body_close, false, declaration))
+                {
+                    declare(declaration);
+                    i = declaration.resume;
+                    continue;
+                }
+            }
+
+            if (text == ";" || text == "}" || text == "else" || text == "do" || text == "try")
+            {
+                statement_start = true;
+            }
+            else if (text == ":" && (is(statement, "case") || is(statement, "default")))
+            {
+                statement_start = true;
+            }
+            else if (text == "{")
+            {
+                const std::string_view before = at(i - 1).text;
+                if (before == "{" || before == "}" || before == ";" || before == ")" || before == "else" || before == "do" || before == "try" || before == ":"
+                    || before == "mutable")
+                {
+                    scopes.push_back({ link(i), visible.size() });
+                    statement_start = true;
+                }
+                else
+                { // an initializer list
+                    i = link(i);
+                }
+            }
+            else if (text == "[")
+            {
+                const std::uint32_t body = lambda_body(i);
+                if (body != 0)
+                {
+                    scopes.push_back({ link(body), visible.size() });
+                    statement_start = true;
+                    i = body;
+                }
+            }
+            else if (text == "for" || text == "while" || text == "if" || text == "switch" || text == "catch")
+            {
+                const std::uint32_t open = text == "if" && is(i + 1, "constexpr") ? i + 2 : i + 1;
+                if (is(open, "("))
+                {
+                    const std::uint32_t close = link(open);
+                    scopes.push_back({ statement_end(close + 1, body_close), visible.size() });
+                    if (text == "for")
+                    {
+                        check_container_loop(variables, visible, i, close);
+                    }
+                    if (text == "catch" && parse_declaration(open + 1, close, true, declaration))
+                    {
+                        declare(declaration);
+                        statement = close + 1;
+                        statement_start = true;
+                        i = close + 1;
+                        continue;
+                    }
+                    headers.push_back(close);
+                    statement_start = true;
+                    i = open;
+                }
+            }
+            ++i;
+        }
+
+        for (const auto& variable : variables)
+        {
+            check_unread(variable);
+            if (!variable.is_static)
+            {
+                function.locals.push_back(variable.name);
+            }
+        }
+    }
+
+    // *parameter = &local; or parameter[n] = &local; leaves the caller pointing into a dead stack frame
+    void check_auto_variable(const Function& function, const std::vector<Variable>& variables, const std::vector<std::uint32_t>& visible, std::uint32_t i)
+    {
+        std::uint32_t j = i;
+        const bool dereference = is(j, "*");
+        if (dereference)
+        {
+            ++j;
+        }
+        const Parameter* parameter = identifier(j) ? find_parameter(function, at(j).text) : nullptr;
+        if (parameter == nullptr || !parameter->is_pointer)
+        {
+            return;
+        }
+        ++j;
+        if (!dereference)
+        {
+            j = link(j) + 1;
+        }
+        if (!is(j, "="))
+        {
+            return;
+        }
+        ++j;
+        const bool address = is(j, "&");
+        if (address)
+        {
+            ++j;
+        }
+        if (!identifier(j) || !is(j + 1, ";"))
+        {
+            return;
+        }
+        const Variable* local = find_visible(variables, visible, visible.size(), at(j).text);
+        if (local == nullptr || local->is_static || local->is_reference || (!address && !local->is_array))
+        {
+            return;
+        }
+        report(auto_variables_check, "Address of local auto-variable assigned to a function parameter.",
+               "Dangerous assignment - the function parameter is assigned the address of a local auto-variable. Local auto-variables are reserved from the "
+               "stack which is freed when the function ends. So the pointer to a local variable is invalid after the function ends.",
+               { location(i) });
+    }
+
+    // a container changed inside a loop that iterates over it
+    void check_container_loop(const std::vector<Variable>& variables, const std::vector<std::uint32_t>& visible, std::uint32_t for_token, std::uint32_t close)
+    {
+        const std::uint32_t open = for_token + 1;
+        std::uint32_t container = 0;
+        std::string_view iterator;
+        for (std::uint32_t j = open + 1; j < close; ++j)
+        {
+            if (is(j, "(") || is(j, "[") || is(j, "{"))
+            {
+                j = link(j);
+            }
+            else if (is(j, ":"))
+            { // for (auto& item : container) or : *container
+                const std::uint32_t range = is(j + 1, "*") ? j + 2 : j + 1;
+                if (identifier(range) && range + 1 == close)
+                {
+                    container = range;
+                }
+                break;
+            }
+            else if (identifier(j) && (is(j + 1, ".") || is(j + 1, "->")) && identifier(j + 2) && is(j + 3, "(")
+                     && (is(j + 2, "begin") || is(j + 2, "cbegin") || is(j + 2, "rbegin") || is(j + 2, "crbegin")))
+            { // for (auto it = container.begin(); ...)
+                container = j;
+                if (j > open + 2 && is(j - 1, "=") && identifier(j - 2))
+                {
+                    iterator = at(j - 2).text;
+                }
+                break;
+            }
+        }
+        if (container == 0)
+        {
+            return;
+        }
+
+        const std::string_view name = at(container).text;
+        const std::uint32_t body_end = statement_end(close + 1, end_);
+        for (std::uint32_t j = close + 1; j < body_end; ++j)
+        {
+            if (at(j).text != name || member(j) || is(j - 1, "::") || !(is(j + 1, ".") || is(j + 1, "->")) || !identifier(j + 2) || !is(j + 3, "(")
+                || !static_checks_detail::invalidates_iterators(at(j + 2).text))
+            {
+                continue;
+            }
+            if (is(j - 1, "return") || (!iterator.empty() && is(j - 1, "=") && at(j - 2).text == iterator))
+            { // it = container.erase(it) keeps the iterator valid
+                continue;
+            }
+            const std::uint32_t after = link(j + 3) + 1;
+            if (is(after, ";") && (is(after + 1, "break") || is(after + 1, "return") || is(after + 1, "throw") || is(after + 1, "goto")))
+            {
+                continue;
+            }
+
+            const Variable* local = find_visible(variables, visible, visible.size(), name);
+            const std::string quoted_name = static_checks_detail::quoted(name);
+            const std::string msg = std::string("Using iterator to ") + (local != nullptr ? "local container " : "container ") + quoted_name + " that may be invalid.";
+            std::vector<StaticLocation> trace{ location(j, "After calling " + static_checks_detail::quoted(at(j + 2).text)
+                                                               + ", iterators or references to the container's data may be invalid ."),
+                                               location(for_token, "Iterator to container is created here.") };
+            if (local != nullptr)
+            {
+                trace.push_back(location(local->token, "Variable created here."));
+            }
+            report(invalid_container_check, msg, msg, std::move(trace));
+            return;
+        }
+    }
+
+    // a variable of a simple type that is assigned but never read
+    void check_unread(const Variable& variable)
+    {
+        if (variable.is_static || variable.is_reference || variable.is_array || !variable.is_trivial || variable.maybe_unused)
+        {
+            return;
+        }
+
+        std::vector<std::uint32_t> writes;
+        if (variable.initialized)
+        {
+            writes.push_back(variable.token);
+        }
+        for (std::uint32_t j = variable.token + 1; j < variable.scope_end; ++j)
+        {
+            if (tokens_[j].text != variable.name || !identifier(j) || member(j) || is(j - 1, "::"))
+            {
+                continue;
+            }
+            if (!is(j + 1, "=") || is(j - 1, "*") || is(j - 1, "&"))
+            {
+                return;
+            }
+            writes.push_back(j);
+        }
+
+        const std::string msg = "Variable " + static_checks_detail::quoted(variable.name) + " is assigned a value that is never used.";
+        for (const auto write : writes)
+        {
+            report(unread_variable_check, msg, msg, { location(write) });
+        }
+    }
+
+    // the throw or call in the body of function that can let an exception escape it, or 0
+    std::uint32_t throw_site(Function& function)
+    {
+        if (function.throws == Answer::yes)
+        {
+            return function.throw_token;
+        }
+        if (function.throws != Answer::unknown)
+        { // answered no, or recursion that has not found a throw yet
+            return 0;
+        }
+
+        function.throws = Answer::checking;
+        std::uint32_t site = 0;
+        const std::uint32_t body_close = link(function.body_open);
+        for (std::uint32_t j = function.body_open + 1; j < body_close && site == 0; ++j)
+        {
+            if (is(j, "try") && is(j + 1, "{"))
+            { // exceptions in a try block are assumed caught, the handlers after it are still checked
+                j = link(j + 1);
+            }
+            else if (is(j, "["))
+            {
+                const std::uint32_t body = lambda_body(j);
+                j = body != 0 ? link(body) : j;
+            }
+            else if (is(j, "throw"))
+            {
+                site = j;
+            }
+            else if (plain_call(j) && !(is(j - 1, "::") && is(j - 2, "std")))
+            {
+                for_each_function(at(j).text, [&](Function& callee) {
+                    if (site == 0 && &callee != &function && !callee.is_noexcept && throw_site(callee) != 0)
+                    {
+                        site = j;
+                    }
+                });
+            }
+        }
+        function.throws = site != 0 ? Answer::yes : Answer::no;
+        function.throw_token = site;
+        return site;
+    }
+
+    void check_noexcept_functions()
+    {
+        for (auto& function : functions_)
+        {
+            if (!function.is_noexcept)
+            {
+                continue;
+            }
+            const std::uint32_t site = throw_site(function);
+            if (site != 0)
+            {
+                report(throw_in_noexcept_check, "Exception thrown in function declared not to throw exceptions.",
+                       "Exception thrown in function declared not to throw exceptions.", { location(site) });
+            }
+        }
+    }
+
+    // i names something assigned to; true if it is a variable local to function
+    bool local_target(const Function& function, std::uint32_t i) const
+    {
+        if (is(i, "]"))
+        {
+            i = link(i) - 1;
+            if (!identifier(i) || member(i))
+            {
+                return false;
+            }
+            return std::find(function.locals.begin(), function.locals.end(), at(i).text) != function.locals.end();
+        }
+        if (!identifier(i) || member(i) || is(i - 1, "*") || is(i - 1, "::"))
+        {
+            return false;
+        }
+        const std::string_view name = at(i).text;
+        if (std::find(function.locals.begin(), function.locals.end(), name) != function.locals.end())
+        {
+            return true;
+        }
+        const Parameter* parameter = find_parameter(function, name);
+        return parameter != nullptr && parameter->by_value;
+    }
+
+    // true if calling function may change anything outside its own locals
+    bool has_side_effects(Function& function)
+    {
+        if (function.side_effects == Answer::unknown)
+        {
+            bool found = false;
+            if (!function.is_const)
+            {
+                const std::uint32_t body_close = link(function.body_open);
+                for (std::uint32_t j = function.body_open + 1; j < body_close && !found; ++j)
+                {
+                    const std::string_view text = at(j).text;
+                    if (static_checks_detail::is_assignment(text) && !is(j - 1, "["))
+                    {
+                        found = !local_target(function, j - 1);
+                    }
+                    else if (text == "++" || text == "--")
+                    {
+                        found = !local_target(function, identifier(j + 1) ? j + 1 : j - 1);
+                    }
+                }
+            }
+            function.side_effects = found ? Answer::yes : Answer::no;
+        }
+        return function.side_effects == Answer::yes;
+    }
+
+    void check_asserts()
+    {
+        for (std::uint32_t i = 0; i + 1 < end_; ++i)
+        {
+            if (!is(i, "assert") || !is(i + 1, "(") || member(i))
+            {
+                continue;
+            }
+
+            const std::uint32_t close = link(i + 1);
+            bool modifies = false;
+            bool calls = false;
+            for (std::uint32_t j = i + 2; j < close; ++j)
+            {
+                const std::string_view text = at(j).text;
+                if (text == "[")
+                {
+                    const std::uint32_t body = lambda_body(j);
+                    j = body != 0 ? link(body) : j;
+                    continue;
+                }
+
+                std::uint32_t target = 0;
+                if (static_checks_detail::is_assignment(text))
+                {
+                    target = j - 1;
+                }
+                else if (text == "++" || text == "--")
+                {
+                    target = identifier(j + 1) ? j + 1 : j - 1;
+                }
+                if (!modifies && target != 0 && identifier(target) && !member(target))
+                {
+                    modifies = true;
+                    const std::string name = static_checks_detail::quoted(at(target).text);
+                    report(assignment_in_assert_check, "Assert statement modifies " + name + ".",
+                           "Variable " + name + " is modified inside assert statement." + std::string(static_checks_detail::assert_release_note), { location(i) });
+                }
+
+                if (!calls && plain_call(j))
+                {
+                    for_each_function(text, [&](Function& callee) { calls |= has_side_effects(callee); });
+                    if (calls)
+                    {
+                        const std::string name = static_checks_detail::quoted(text);
+                        report(assert_with_side_effect_check, "Assert statement calls a function which may have desired side effects: " + name + ".",
+                               "Non-pure function: " + name + " is called inside assert statement." + std::string(static_checks_detail::assert_release_note),
+                               { location(i) });
+                    }
+                }
+            }
+        }
+    }
+
+    template <typename Visit>
+    void for_each_function(std::string_view name, Visit visit)
+    {
+        auto first = std::lower_bound(by_name_.begin(), by_name_.end(), name, [this](std::uint32_t function, std::string_view key) { return functions_[function].name < key; });
+        for (; first != by_name_.end() && functions_[*first].name == name; ++first)
+        {
+            visit(functions_[*first]);
+        }
+    }
+
+    std::vector<CppToken> tokens_;
+    // index of the end token
+    std::uint32_t end_;
+    std::vector<Function> functions_;
+    // functions_ indexes sorted by name
+    std::vector<std::uint32_t> by_name_;
+    std::vector<StaticFinding> findings_;
+};
+
+/// <summary>
+/// Run every check over one source file
+/// </summary>
+inline std::vector<StaticFinding> check_cpp_source(std::string_view source)
+{
+    return CppSourceChecker(source).run();
+}
+
+/// <summary>
+/// The findings for one file, or why it could not be read
+/// </summary>
+struct StaticScanFile
+{
+    std::string name;
+    std::size_t bytes = 0;
+    std::vector<StaticFinding> findings;
+    std::string error;
+};
+
+/// <summary>
+/// Check files on several threads. Each file is memory mapped and checked on its own, so threads
+/// only share the counter that hands out the next file; the biggest files go first so one large
+/// file is not left running alone at the end.
+/// </summary>
+/// <returns>one result per file, in the order given</returns>
+inline std::vector<StaticScanFile> scan_cpp_files(const std::vector<std::string>& files, unsigned threads)
+{
+    std::vector<StaticScanFile> results(files.size());
+    std::vector<std::uintmax_t> sizes(files.size());
+    for (std::size_t file = 0; file < files.size(); ++file)
+    {
+        results[file].name = files[file];
+        std::error_code error;
+        sizes[file] = std::filesystem::file_size(files[file], error);
+    }
+    std::vector<std::size_t> order(files.size());
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t left, std::size_t right) { return sizes[left] > sizes[right]; });
+
+    std::atomic<std::size_t> next{ 0 };
+    const auto worker = [&] {
+        for (;;)
+        {
+            const std::size_t taken = next.fetch_add(1, std::memory_order_relaxed);
+            if (taken >= order.size())
+            {
+                return;
+            }
+            StaticScanFile& result = results[order[taken]];
+            try
+            {
+                const MappedFile source(result.name);
+                source.advise_sequential();
+                result.bytes = source.size();
+                result.findings = check_cpp_source(source.view());
+            }
+            catch (const std::exception& exception)
+            {
+                result.error = exception.what();
+            }
+        }
+    };
+
+    threads = static_cast<unsigned>(std::min<std::size_t>(std::max(threads, 1u), std::max<std::size_t>(files.size(), 1)));
+    std::vector<std::thread> pool;
+    for (unsigned thread = 1; thread < threads; ++thread)
+    {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool)
+    {
+        thread.join();
+    }
+    return results;
+}
+
+// written as the cppcheck version of reports from these checks
+inline constexpr std::string_view static_checks_version = "static_testing_scan 1.0";
+
+/// <summary>
+/// Write the findings as a version 2 cppcheck XML report
+/// </summary>
+inline void write_cppcheck_xml(std::ostream& out, const std::vector<StaticScanFile>& files)
+{
+    std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<results version=\"2\">\n    <cppcheck version=\"";
+    append_xml_escaped(xml, static_checks_version);
+    xml += "\"/>\n    <errors>\n";
+    for (const auto& file : files)
+    {
+        for (const auto& finding : file.findings)
+        {
+            xml += "        <error id=\"";
+            append_xml_escaped(xml, finding.check->id);
+            xml += "\" severity=\"";
+            append_xml_escaped(xml, finding.check->severity);
+            xml += "\" msg=\"";
+            append_xml_escaped(xml, finding.msg);
+            xml += "\" verbose=\"";
+            append_xml_escaped(xml, finding.verbose);
+            if (finding.check->cwe != 0)
+            {
+                xml += "\" cwe=\"" + std::to_string(finding.check->cwe);
+            }
+            xml += "\" file0=\"";
+            append_xml_escaped(xml, file.name);
+            xml += "\">\n";
+            for (const auto& location : finding.locations)
+            {
+                xml += "            <location file=\"";
+                append_xml_escaped(xml, file.name);
+                xml += "\" line=\"" + std::to_string(location.line) + "\" column=\"" + std::to_string(location.column) + "\"";
+                if (!location.info.empty())
+                {
+                    xml += " info=\"";
+                    append_xml_escaped(xml, location.info);
+                    xml += "\"";
+                }
+                xml += "/>\n";
+            }
+            xml += "        </error>\n";
+        }
+    }
+    xml += "    </errors>\n</results>\n";
+    out.write(xml.data(), static_cast<std::streamsize>(xml.size()));
+}
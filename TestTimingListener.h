@@ -0,0 +1,96 @@
+// TestTimingListener.h : gtest listener that records the wall time of every test.
+//
+// With TEST_TIMING_FILE set, one line per test is written there when the program ends:
+//   <microseconds>\t<suite.name>\t<passed|failed>
+// The sharded test runner merges these files from every shard. With TEST_SLOWEST=<n> set, the n
+// slowest tests of this process are printed at the end of the run.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/// <summary>
+/// One finished test
+/// </summary>
+struct TestTiming
+{
+    std::string name;
+    std::chrono::microseconds elapsed{ 0 };
+    bool passed = true;
+};
+
+/// <summary>
+/// Print the slowest tests first, at most limit of them
+/// </summary>
+inline void print_slowest_tests(std::vector<TestTiming> timings, std::size_t limit, std::FILE* out = stdout)
+{
+    std::sort(timings.begin(), timings.end(), [](const TestTiming& left, const TestTiming& right) {
+        return left.elapsed > right.elapsed;
+    });
+    if (timings.size() > limit)
+    {
+        timings.resize(limit);
+    }
+
+    std::fprintf(out, "Slowest %zu test(s):\n", timings.size());
+    for (const auto& timing : timings)
+    {
+        std::fprintf(out, "%12.3f ms  %s%s\n", timing.elapsed.count() / 1000.0, timing.name.c_str(), timing.passed ? "" : "  (FAILED)");
+    }
+}
+
+class TestTimingListener : public ::testing::EmptyTestEventListener
+{
+public:
+    void OnTestStart(const ::testing::TestInfo&) override
+    {
+        started_ = std::chrono::steady_clock::now();
+    }
+
+    void OnTestEnd(const ::testing::TestInfo& test_info) override
+    {
+        TestTiming timing;
+        timing.name = std::string(test_info.test_suite_name()) + "." + test_info.name();
+        timing.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started_);
+        timing.passed = !test_info.result()->Failed();
+        timings_.push_back(std::move(timing));
+    }
+
+    void OnTestProgramEnd(const ::testing::UnitTest&) override
+    {
+        if (const char* path = std::getenv("TEST_TIMING_FILE"))
+        {
+            write_timings(path);
+        }
+        if (const char* slowest = std::getenv("TEST_SLOWEST"))
+        {
+            print_slowest_tests(timings_, static_cast<std::size_t>(std::strtoul(slowest, nullptr, 10)));
+        }
+    }
+
+private:
+    void write_timings(const char* path) const
+    {
+        std::FILE* file = std::fopen(path, "w");
+        if (file == nullptr)
+        {
+            std::fprintf(stderr, "TestTimingListener: cannot write %s\n", path);
+            return;
+        }
+        for (const auto& timing : timings_)
+        {
+            std::fprintf(file, "%lld\t%s\t%s\n", static_cast<long long>(timing.elapsed.count()), timing.name.c_str(), timing.passed ? "passed" : "failed");
+        }
+        std::fclose(file);
+    }
+
+    std::chrono::steady_clock::time_point started_;
+    std::vector<TestTiming> timings_;
+};
@@ -0,0 +1,286 @@
+// UserDatabase Benchmark.cpp : Cost of run_query, including its injection check, against an in-memory USERS table,
+// and what the USERS schema options do to NAME lookups at scale.
+//
+// The run_query table holds the four example users plus --users generated ones (10000 by default).
+// run_query and initialize_database report to std::cout, so it is sent to a null buffer while they run.
+//
+// The schema benchmarks build one in-memory table per schema with --schema_users generated users
+// (1000000 by default) and time prepared statements, stepping every row, for a point lookup on NAME,
+// a NAME range, an ID lookup and the "OR 1=1" query a successful injection turns the point lookup
+// into. Each table is built the first time a benchmark uses it, so a --benchmark_filter run only
+// pays for the schemas it selects. Each query's EXPLAIN QUERY PLAN goes into its label.
+// BM_SeedUsers fills a file database with --seed_users users (100000 by default) under each PRAGMA
+// preset.
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "BenchmarkMain.h"
+#include "UserDatabase.h"
+
+namespace
+{
+    sqlite3* db = nullptr;
+    std::size_t user_count = 0;
+    std::size_t schema_user_count = 0;
+    std::size_t seed_user_count = 0;
+
+    class NullBuffer : public std::streambuf
+    {
+    protected:
+        int overflow(int c) override
+        {
+            return c;
+        }
+    };
+
+    // silences std::cout for its lifetime, but not the benchmark reporter that prints between runs
+    class QuietConsole
+    {
+    public:
+        QuietConsole() : console_(std::cout.rdbuf(&buffer_))
+        {
+        }
+
+        ~QuietConsole()
+        {
+            std::cout.rdbuf(console_);
+        }
+
+        QuietConsole(const QuietConsole&) = delete;
+        QuietConsole& operator=(const QuietConsole&) = delete;
+
+    private:
+        NullBuffer buffer_;
+        std::streambuf* console_;
+    };
+
+    void run_query_benchmark(benchmark::State& state, const std::string& sql)
+    {
+        std::vector<user_record> records;
+        std::size_t rows = 0;
+        QuietConsole quiet;
+        for (auto _ : state)
+        {
+            run_query(db, sql, records);
+            rows = records.size();
+        }
+        state.counters["rows"] = static_cast<double>(rows);
+    }
+
+    void BM_SelectAll(benchmark::State& state)
+    {
+        run_query_benchmark(state, "SELECT ID, NAME, PASSWORD FROM USERS");
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * (user_count + 4)));
+    }
+
+    void BM_SelectByName(benchmark::State& state)
+    {
+        run_query_benchmark(state, "SELECT ID, NAME, PASSWORD FROM USERS WHERE NAME='Fred';");
+    }
+
+    // refused by the injection check before it reaches SQLite
+    void BM_RejectInjection(benchmark::State& state)
+    {
+        run_query_benchmark(state, "SELECT ID, NAME, PASSWORD FROM USERS WHERE NAME='Fred' or 'hack'='hack';");
+    }
+
+    void BM_ReplaceSubstring(benchmark::State& state)
+    {
+        std::string text;
+        for (int i = 0; i < state.range(0); ++i)
+        {
+            text += "SELECT * FROM USERS WHERE NAME='Fred'; ";
+        }
+        for (auto _ : state)
+        {
+            const std::string replaced = replace_substring(text, "Fred", "Barney");
+            benchmark::DoNotOptimize(replaced.data());
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * text.size()));
+    }
+}
+
+namespace
+{
+    struct Schema
+    {
+        const char* name;
+        SchemaOptions options;
+        sqlite3* db;
+    };
+
+    Schema schemas[] = {
+        {"plain", {NameIndex::none, false, PragmaPreset::defaults}, nullptr},
+        {"name_index", {NameIndex::secondary, false, PragmaPreset::defaults}, nullptr},
+        {"covering_index", {NameIndex::covering, false, PragmaPreset::defaults}, nullptr},
+        {"without_rowid_covering", {NameIndex::covering, true, PragmaPreset::defaults}, nullptr},
+    };
+
+    struct Query
+    {
+        const char* name;
+        const char* sql;
+    };
+
+    const Query queries[] = {
+        {"point", "SELECT ID, NAME, PASSWORD FROM USERS WHERE NAME='Fred';"},
+        {"range", "SELECT ID, NAME, PASSWORD FROM USERS WHERE NAME >= 'User5000' AND NAME < 'User5001';"},
+        {"id", "SELECT ID, NAME, PASSWORD FROM USERS WHERE ID=4242;"},
+        {"injected", "SELECT ID, NAME, PASSWORD FROM USERS WHERE NAME='Fred' or 1=1;"},
+    };
+
+    // fills and analyzes the table for schema, returning nullptr if any step fails
+    sqlite3* build_schema(Schema& schema)
+    {
+        QuietConsole quiet;
+        if (sqlite3_open(":memory:", &schema.db) != SQLITE_OK || !initialize_database(schema.db, schema.options) || !seed_users(schema.db, schema_user_count, 405))
+        {
+            return nullptr;
+        }
+        sqlite3_exec(schema.db, "ANALYZE;", nullptr, nullptr, nullptr);
+        return schema.db;
+    }
+
+    // one function-local static per schema, so each table is built at most once and only when used
+    template <std::size_t Index>
+    sqlite3* schema_database()
+    {
+        static sqlite3* const database = build_schema(schemas[Index]);
+        return database;
+    }
+
+    sqlite3* (*const schema_databases[])() = {schema_database<0>, schema_database<1>, schema_database<2>, schema_database<3>};
+
+    static_assert(sizeof(schema_databases) / sizeof(schema_databases[0]) == sizeof(schemas) / sizeof(schemas[0]), "every schema needs a database");
+
+    std::string query_plan(sqlite3* database, const char* sql)
+    {
+        std::vector<std::string> plan;
+        std::string text;
+        QuietConsole quiet;
+        if (explain_query_plan(database, sql, plan))
+        {
+            for (const auto& step : plan)
+            {
+                text += (text.empty() ? "" : " | ") + step;
+            }
+        }
+        return text;
+    }
+
+    // args: schema, query
+    void BM_Query(benchmark::State& state)
+    {
+        const Schema& schema = schemas[state.range(0)];
+        const Query& query = queries[state.range(1)];
+        sqlite3* const database = schema_databases[state.range(0)]();
+        if (database == nullptr)
+        {
+            state.SkipWithError("building the schema failed");
+            return;
+        }
+
+        sqlite3_stmt* statement = nullptr;
+        if (sqlite3_prepare_v2(database, query.sql, -1, &statement, nullptr) != SQLITE_OK)
+        {
+            state.SkipWithError(sqlite3_errmsg(database));
+            return;
+        }
+
+        std::size_t rows = 0;
+        std::size_t bytes = 0;
+        for (auto _ : state)
+        {
+            rows = 0;
+            while (sqlite3_step(statement) == SQLITE_ROW)
+            {
+                benchmark::DoNotOptimize(sqlite3_column_int64(statement, 0));
+                bytes += static_cast<std::size_t>(sqlite3_column_bytes(statement, 1) + sqlite3_column_bytes(statement, 2));
+                ++rows;
+            }
+            sqlite3_reset(statement);
+        }
+        sqlite3_finalize(statement);
+
+        state.counters["rows"] = static_cast<double>(rows);
+        state.counters["users"] = static_cast<double>(schema_user_count + 4);
+        state.SetLabel(std::string(schema.name) + " " + query.name + ": " + query_plan(database, query.sql));
+        benchmark::DoNotOptimize(bytes);
+    }
+
+    // args: PRAGMA preset; fills a fresh file database each iteration
+    void BM_SeedUsers(benchmark::State& state)
+    {
+        SchemaOptions options;
+        options.name_index = NameIndex::secondary;
+        options.pragmas = static_cast<PragmaPreset>(state.range(0));
+        const auto directory = std::filesystem::temp_directory_path() / "user_database_benchmark";
+        std::filesystem::create_directories(directory);
+        const std::string path = (directory / "users.db").string();
+
+        QuietConsole quiet;
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            std::filesystem::remove_all(directory);
+            std::filesystem::create_directories(directory);
+            state.ResumeTiming();
+
+            sqlite3* file_db = nullptr;
+            const bool seeded = sqlite3_open(path.c_str(), &file_db) == SQLITE_OK && initialize_database(file_db, options) && seed_users(file_db, seed_user_count, 405);
+            sqlite3_close(file_db);
+            if (!seeded)
+            {
+                state.SkipWithError("seeding the file database failed");
+                break;
+            }
+        }
+        std::filesystem::remove_all(directory);
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * seed_user_count));
+        state.SetLabel(to_string(options.pragmas));
+    }
+}
+
+BENCHMARK(BM_Query)->ArgsProduct({{0, 1, 2, 3}, {0, 1, 2, 3}});
+BENCHMARK(BM_SeedUsers)->DenseRange(0, 2)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SelectAll);
+BENCHMARK(BM_SelectByName);
+BENCHMARK(BM_RejectInjection);
+BENCHMARK(BM_ReplaceSubstring)->RangeMultiplier(8)->Range(1, 4096);
+
+int main(int argc, char** argv)
+{
+    user_count = take_benchmark_option(argc, argv, "users", std::size_t(10000));
+    schema_user_count = take_benchmark_option(argc, argv, "schema_users", std::size_t(1000000));
+    seed_user_count = take_benchmark_option(argc, argv, "seed_users", std::size_t(100000));
+
+    bool ready = false;
+    {
+        QuietConsole quiet;
+        ready = sqlite3_open(":memory:", &db) == SQLITE_OK && initialize_database(db) && seed_users(db, user_count, 405);
+    }
+
+    int result = 1;
+    if (!ready)
+    {
+        std::cerr << "Unable to create the USERS table: " << sqlite3_errmsg(db) << std::endl;
+    }
+    else
+    {
+        result = run_benchmarks(argc, argv);
+    }
+
+    for (auto& schema : schemas)
+    {
+        sqlite3_close(schema.db);
+    }
+    sqlite3_close(db);
+    return result;
+}
@@ -0,0 +1,173 @@
+// UserDatabase Tests.cpp : Tests for the USERS schema options, seeding and query plans.
+//
+// Every test works on its own in-memory database, so the schema variants never see each other's rows.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "UserDatabase.h"
+
+namespace
+{
+    const std::string fred_query = "SELECT ID, NAME, PASSWORD FROM USERS WHERE NAME='Fred';";
+
+    class UserDatabaseTest : public ::testing::Test
+    {
+    protected:
+        sqlite3* db = nullptr;
+
+        void SetUp() override
+        {
+            ASSERT_EQ(sqlite3_open(":memory:", &db), SQLITE_OK);
+        }
+
+        void TearDown() override
+        {
+            sqlite3_close(db);
+        }
+
+        // a fresh in-memory database with the given schema, replacing the current one
+        void recreate(const SchemaOptions& options)
+        {
+            sqlite3_close(db);
+            db = nullptr;
+            ASSERT_EQ(sqlite3_open(":memory:", &db), SQLITE_OK);
+            ASSERT_TRUE(initialize_database(db, options));
+        }
+
+        // the plan as one string, with the steps joined by newlines
+        std::string plan_of(const std::string& sql) const
+        {
+            std::vector<std::string> plan;
+            EXPECT_TRUE(explain_query_plan(db, sql, plan)) << sql;
+            std::string joined;
+            for (const auto& step : plan)
+            {
+                joined += step + "\n";
+            }
+            return joined;
+        }
+
+        std::int64_t scalar(const std::string& sql) const
+        {
+            sqlite3_stmt* statement = nullptr;
+            EXPECT_EQ(sqlite3_prepare_v2(db, sql.c_str(), -1, &statement, nullptr), SQLITE_OK) << sql;
+            std::int64_t value = -1;
+            if (sqlite3_step(statement) == SQLITE_ROW)
+            {
+                value = sqlite3_column_int64(statement, 0);
+            }
+            sqlite3_finalize(statement);
+            return value;
+        }
+
+        std::vector<std::string> passwords() const
+        {
+            sqlite3_stmt* statement = nullptr;
+            EXPECT_EQ(sqlite3_prepare_v2(db, "SELECT PASSWORD FROM USERS ORDER BY ID;", -1, &statement, nullptr), SQLITE_OK);
+            std::vector<std::string> values;
+            while (sqlite3_step(statement) == SQLITE_ROW)
+            {
+                values.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(statement, 0)));
+            }
+            sqlite3_finalize(statement);
+            return values;
+        }
+    };
+}
+
+TEST_F(UserDatabaseTest, NameQueryScansWithoutAnIndex)
+{
+    for (const bool without_rowid : { false, true })
+    {
+        recreate({ NameIndex::none, without_rowid, PragmaPreset::defaults });
+        const std::string plan = plan_of(fred_query);
+        EXPECT_NE(plan.find("SCAN USERS"), std::string::npos) << plan;
+        EXPECT_EQ(plan.find("USERS_NAME"), std::string::npos) << plan;
+    }
+}
+
+TEST_F(UserDatabaseTest, NameQuerySearchesTheSecondaryIndex)
+{
+    for (const bool without_rowid : { false, true })
+    {
+        recreate({ NameIndex::secondary, without_rowid, PragmaPreset::defaults });
+        const std::string plan = plan_of(fred_query);
+        EXPECT_NE(plan.find("SEARCH USERS USING INDEX USERS_NAME (NAME=?)"), std::string::npos) << plan;
+        EXPECT_EQ(plan.find("SCAN"), std::string::npos) << plan;
+    }
+}
+
+TEST_F(UserDatabaseTest, NameQueryIsAnsweredByTheCoveringIndex)
+{
+    for (const bool without_rowid : { false, true })
+    {
+        recreate({ NameIndex::covering, without_rowid, PragmaPreset::defaults });
+        const std::string plan = plan_of(fred_query);
+        EXPECT_NE(plan.find("SEARCH USERS USING COVERING INDEX USERS_NAME (NAME=?)"), std::string::npos) << plan;
+        EXPECT_EQ(plan.find("SCAN"), std::string::npos) << plan;
+    }
+}
+
+TEST_F(UserDatabaseTest, EverySchemaFindsFred)
+{
+    for (const NameIndex name_index : { NameIndex::none, NameIndex::secondary, NameIndex::covering })
+    {
+        for (const bool without_rowid : { false, true })
+        {
+            recreate({ name_index, without_rowid, PragmaPreset::defaults });
+            ASSERT_TRUE(seed_users(db, 100, 405));
+
+            std::vector<user_record> records;
+            ASSERT_TRUE(run_query(db, fred_query, records)) << to_string(name_index);
+            ASSERT_EQ(records.size(), 1u) << to_string(name_index);
+            EXPECT_EQ(std::get<0>(records[0]), "1");
+            EXPECT_EQ(std::get<2>(records[0]), "Flinstone");
+        }
+    }
+}
+
+TEST_F(UserDatabaseTest, SeedingAddsCountUsers)
+{
+    for (const std::size_t count : { std::size_t(0), std::size_t(1), std::size_t(1000) })
+    {
+        recreate({});
+        ASSERT_TRUE(seed_users(db, count, 405));
+        EXPECT_EQ(scalar("SELECT COUNT(*) FROM USERS;"), static_cast<std::int64_t>(count + 4));
+        if (count > 0)
+        {
+            // IDs continue after the four example users and names count from User0
+            EXPECT_EQ(scalar("SELECT MAX(ID) FROM USERS;"), static_cast<std::int64_t>(count + 4));
+            EXPECT_EQ(scalar("SELECT ID FROM USERS WHERE NAME='User" + std::to_string(count - 1) + "';"), static_cast<std::int64_t>(count + 4));
+        }
+    }
+}
+
+TEST_F(UserDatabaseTest, SeedingIsDeterministic)
+{
+    recreate({});
+    ASSERT_TRUE(seed_users(db, 50, 405));
+    const auto first = passwords();
+
+    recreate({ NameIndex::covering, true, PragmaPreset::defaults });
+    ASSERT_TRUE(seed_users(db, 50, 405));
+    EXPECT_EQ(passwords(), first);
+
+    recreate({});
+    ASSERT_TRUE(seed_users(db, 50, 406));
+    EXPECT_NE(passwords(), first);
+}
+
+TEST_F(UserDatabaseTest, FailedSeedingRollsBack)
+{
+    recreate({});
+    ASSERT_TRUE(seed_users(db, 10, 405));
+
+    // the second batch reuses IDs 5 and up, so its first insert fails and none of it may remain
+    EXPECT_FALSE(seed_users(db, 10, 406));
+    EXPECT_EQ(scalar("SELECT COUNT(*) FROM USERS;"), 14);
+}
@@ -0,0 +1,298 @@
+// UserDatabase.cpp : The USERS table and the query layer of the SQL injection example.
+//
+
+#include "UserDatabase.h"
+
+#include <iostream>
+#include <map>
+#include <regex>
+
+#include "Random.h"
+
+// DO NOT CHANGE
+static int callback(void* possible_vector, int argc, char** argv, char** azColName)
+{
+    if (possible_vector == NULL)
+    { // no vector passed in, so just display the results
+        for (int i = 0; i < argc; i++)
+        {
+            std::cout << azColName[i] << " = " << (argv[i] ? argv[i] : "NULL") << std::endl;
+        }
+        std::cout << std::endl;
+    }
+    else
+    {
+        std::vector< user_record >* rows =
+            static_cast<std::vector< user_record > *>(possible_vector);
+
+        rows->push_back(std::make_tuple(argv[0], argv[1], argv[2]));
+    }
+    return 0;
+}
+
+// DO NOT CHANGE
+bool initialize_database(sqlite3* db)
+{
+    char* error_message = NULL;
+    std::string sql = "CREATE TABLE USERS(" \
+        "ID INT PRIMARY KEY     NOT NULL," \
+        "NAME           TEXT    NOT NULL," \
+        "PASSWORD       TEXT    NOT NULL);";
+
+    int result = sqlite3_exec(db, sql.c_str(), callback, NULL, &error_message);
+    if (result != SQLITE_OK)
+    {
+        std::cout << "Failed to create USERS table. ERROR = " << error_message << std::endl;
+        sqlite3_free(error_message);
+        return false;
+    }
+    std::cout << "USERS table created." << std::endl;
+
+    // insert some dummy data
+    sql = "INSERT INTO USERS (ID, NAME, PASSWORD)" \
+        "VALUES (1, 'Fred', 'Flinstone');" \
+        "INSERT INTO USERS (ID, NAME, PASSWORD)" \
+        "VALUES (2, 'Barney', 'Rubble');" \
+        "INSERT INTO USERS (ID, NAME, PASSWORD)" \
+        "VALUES (3, 'Wilma', 'Flinstone');" \
+        "INSERT INTO USERS (ID, NAME, PASSWORD)" \
+        "VALUES (4, 'Betty', 'Rubble');";
+
+    result = sqlite3_exec(db, sql.c_str(), callback, NULL, &error_message);
+    if (result != SQLITE_OK)
+    {
+        std::cout << "Data failed to insert to USERS table. ERROR = " << error_message << std::endl;
+        sqlite3_free(error_message);
+        return false;
+    }
+
+    return true;
+}
+
+std::string replace_substring(std::string s, const std::string s_to_replace, const std::string s_replace) {
+    for (size_t position = 0; ; position += s_replace.length()) {
+
+        position = s.find(s_to_replace, position);
+
+        if (position == std::string::npos || s.empty()) break;
+
+        s.erase(position, s_to_replace.length());
+        s.insert(position, s_replace);
+    }
+    return s;
+}
+
+bool run_query(sqlite3* db, const std::string& sql, std::vector< user_record >& records)
+{
+    // TODO: Fix this method to fail and display an error if there is a suspected SQL Injection
+    //  NOTE: You cannot just flag 1=1 as an error, since 2=2 will work just as well. You need
+    //  something more generic
+    // clear any prior results
+    records.clear();
+
+    //Regex pattern to look for additional conditionals that look like they - force a `true` condition
+        std::regex pattern("(?:or|and) (.+)=(.+);");
+    std::cmatch match;
+    // If there is a conditional - possible vulnerability?
+    if (std::regex_search(sql.c_str(), match, pattern) && match.size() >= 2) {
+        // Loop through all the matches, then compare the left to the right to see if they're the same
+        // which would force a true condition.
+        for (int i = 0; i < match.size(); i++) {
+            // If there is a suspected SQL Injection, error and message of the error
+            if ((i != match.size() + 1) && match.str(i) == match.str(i + 1)) {
+                std::cout << "Data failed to execute due to suspected SQL Injection" << std::endl;
+                return false;
+            }
+        }
+    }
+    
+
+    char* error_message;
+    if (sqlite3_exec(db, sql.c_str(), callback, &records, &error_message) != SQLITE_OK)
+    {
+        std::cout << "Data failed to be queried from USERS table. ERROR = " << error_message << std::endl;
+        sqlite3_free(error_message);
+        return false;
+    }
+
+
+    return true;
+}
+
+namespace
+{
+    bool exec_statement(sqlite3* db, const std::string& sql, const char* failure)
+    {
+        char* error_message = NULL;
+        if (sqlite3_exec(db, sql.c_str(), NULL, NULL, &error_message) != SQLITE_OK)
+        {
+            std::cout << failure << " ERROR = " << error_message << std::endl;
+            sqlite3_free(error_message);
+            return false;
+        }
+        return true;
+    }
+
+    const char* pragma_statements(PragmaPreset pragmas)
+    {
+        switch (pragmas)
+        {
+        case PragmaPreset::bulk_load:
+            return "PRAGMA journal_mode=OFF; PRAGMA synchronous=OFF; PRAGMA locking_mode=EXCLUSIVE; PRAGMA temp_store=MEMORY; PRAGMA cache_size=-262144;";
+        case PragmaPreset::wal:
+            return "PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL; PRAGMA temp_store=MEMORY; PRAGMA cache_size=-65536; PRAGMA mmap_size=268435456;";
+        case PragmaPreset::defaults:
+        default:
+            return "";
+        }
+    }
+}
+
+const char* to_string(NameIndex name_index)
+{
+    switch (name_index)
+    {
+    case NameIndex::secondary:
+        return "name_index";
+    case NameIndex::covering:
+        return "covering_index";
+    case NameIndex::none:
+    default:
+        return "no_index";
+    }
+}
+
+const char* to_string(PragmaPreset pragmas)
+{
+    switch (pragmas)
+    {
+    case PragmaPreset::bulk_load:
+        return "bulk_load";
+    case PragmaPreset::wal:
+        return "wal";
+    case PragmaPreset::defaults:
+    default:
+        return "defaults";
+    }
+}
+
+bool initialize_database(sqlite3* db, const SchemaOptions& options)
+{
+    if (!exec_statement(db, pragma_statements(options.pragmas), "Failed to apply PRAGMA settings."))
+    {
+        return false;
+    }
+
+    if (!options.without_rowid)
+    {
+        if (!initialize_database(db))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        // the same table and users as initialize_database, keyed on ID alone
+        const std::string sql = "CREATE TABLE USERS(" \
+            "ID INT PRIMARY KEY     NOT NULL," \
+            "NAME           TEXT    NOT NULL," \
+            "PASSWORD       TEXT    NOT NULL) WITHOUT ROWID;" \
+            "INSERT INTO USERS (ID, NAME, PASSWORD) VALUES (1, 'Fred', 'Flinstone');" \
+            "INSERT INTO USERS (ID, NAME, PASSWORD) VALUES (2, 'Barney', 'Rubble');" \
+            "INSERT INTO USERS (ID, NAME, PASSWORD) VALUES (3, 'Wilma', 'Flinstone');" \
+            "INSERT INTO USERS (ID, NAME, PASSWORD) VALUES (4, 'Betty', 'Rubble');";
+        if (!exec_statement(db, sql, "Failed to create USERS table."))
+        {
+            return false;
+        }
+        std::cout << "USERS table created WITHOUT ROWID." << std::endl;
+    }
+
+    switch (options.name_index)
+    {
+    case NameIndex::secondary:
+        return exec_statement(db, "CREATE INDEX USERS_NAME ON USERS(NAME);", "Failed to create NAME index.");
+    case NameIndex::covering:
+        // a WITHOUT ROWID table's indexes already carry the ID primary key
+        return exec_statement(db, options.without_rowid ? "CREATE INDEX USERS_NAME ON USERS(NAME, PASSWORD);" : "CREATE INDEX USERS_NAME ON USERS(NAME, ID, PASSWORD);",
+                              "Failed to create covering NAME index.");
+    case NameIndex::none:
+    default:
+        return true;
+    }
+}
+
+bool seed_users(sqlite3* db, std::size_t count, std::uint64_t seed)
+{
+    if (!exec_statement(db, "BEGIN;", "Failed to start seeding USERS."))
+    {
+        return false;
+    }
+
+    sqlite3_stmt* insert = NULL;
+    if (sqlite3_prepare_v2(db, "INSERT INTO USERS (ID, NAME, PASSWORD) VALUES (?, ?, ?);", -1, &insert, NULL) != SQLITE_OK)
+    {
+        std::cout << "Failed to prepare USERS insert. ERROR = " << sqlite3_errmsg(db) << std::endl;
+        exec_statement(db, "ROLLBACK;", "Failed to roll back.");
+        return false;
+    }
+
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    Xoshiro256 random(seed);
+    std::string name;
+    std::string password(12, ' ');
+    bool inserted = true;
+    for (std::size_t i = 0; i < count && inserted; ++i)
+    {
+        name = "User" + std::to_string(i);
+        for (auto& c : password)
+        {
+            c = alphabet[random.next_below(sizeof(alphabet) - 1)];
+        }
+        sqlite3_bind_int64(insert, 1, static_cast<sqlite3_int64>(i + 5));
+        sqlite3_bind_text(insert, 2, name.c_str(), static_cast<int>(name.size()), SQLITE_STATIC);
+        sqlite3_bind_text(insert, 3, password.c_str(), static_cast<int>(password.size()), SQLITE_STATIC);
+        inserted = sqlite3_step(insert) == SQLITE_DONE;
+        sqlite3_reset(insert);
+    }
+    if (!inserted)
+    {
+        std::cout << "Failed to seed USERS. ERROR = " << sqlite3_errmsg(db) << std::endl;
+    }
+    sqlite3_finalize(insert);
+
+    if (!inserted)
+    {
+        exec_statement(db, "ROLLBACK;", "Failed to roll back.");
+        return false;
+    }
+    return exec_statement(db, "COMMIT;", "Failed to commit USERS.");
+}
+
+bool explain_query_plan(sqlite3* db, const std::string& sql, std::vector<std::string>& plan)
+{
+    plan.clear();
+
+    sqlite3_stmt* statement = NULL;
+    if (sqlite3_prepare_v2(db, ("EXPLAIN QUERY PLAN " + sql).c_str(), -1, &statement, NULL) != SQLITE_OK)
+    {
+        std::cout << "Failed to explain query. ERROR = " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    // columns are id, parent, notused, detail; a step is one level deeper than its parent
+    std::map<int, std::size_t> depths;
+    while (sqlite3_step(statement) == SQLITE_ROW)
+    {
+        const int id = sqlite3_column_int(statement, 0);
+        const int parent = sqlite3_column_int(statement, 1);
+        const auto found = depths.find(parent);
+        const std::size_t depth = found == depths.end() ? 0 : found->second + 1;
+        depths[id] = depth;
+
+        const unsigned char* detail = sqlite3_column_text(statement, 3);
+        plan.push_back(std::string(2 * depth, ' ') + (detail ? reinterpret_cast<const char*>(detail) : ""));
+    }
+
+    return sqlite3_finalize(statement) == SQLITE_OK;
+}
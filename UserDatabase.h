@@ -0,0 +1,94 @@
+// UserDatabase.h : The USERS table and the query layer of the SQL injection example.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "sqlite3.h"
+
+// DO NOT CHANGE
+typedef std::tuple<std::string, std::string, std::string> user_record;
+
+/// <summary>
+/// Create the USERS table and fill it with the four example users
+/// </summary>
+/// <returns>false, after printing the SQLite error, if either statement fails</returns>
+bool initialize_database(sqlite3* db);
+
+/// <summary>
+/// Replace every occurrence of s_to_replace in s with s_replace
+/// </summary>
+std::string replace_substring(std::string s, const std::string s_to_replace, const std::string s_replace);
+
+/// <summary>
+/// Run sql and collect the rows it returns as (ID, NAME, PASSWORD) records. Statements that look
+/// like a SQL injection, a trailing or/and condition comparing a value with itself, are refused.
+/// </summary>
+/// <returns>false if the statement was refused or failed</returns>
+bool run_query(sqlite3* db, const std::string& sql, std::vector< user_record >& records);
+
+/// <summary>
+/// Index on USERS.NAME. Without one every WHERE NAME=... is a full table scan.
+/// </summary>
+enum class NameIndex
+{
+    none,
+    // NAME only, each match is looked up again in the table for the other columns
+    secondary,
+    // NAME plus every other column, so a NAME query never touches the table
+    covering
+};
+
+/// <summary>
+/// PRAGMA settings applied before the table is created. They only matter for file databases.
+/// </summary>
+enum class PragmaPreset
+{
+    defaults,
+    // no journal, no syncs, exclusive lock: fastest to fill, lost if the process dies part way
+    bulk_load,
+    // write-ahead log with NORMAL syncs, a 64 MiB page cache and memory mapped reads
+    wal
+};
+
+/// <summary>
+/// Optional tuning of the USERS schema
+/// </summary>
+struct SchemaOptions
+{
+    NameIndex name_index = NameIndex::none;
+    // store rows in the ID primary key's b-tree instead of a separate rowid table plus ID index
+    bool without_rowid = false;
+    PragmaPreset pragmas = PragmaPreset::defaults;
+};
+
+/// <summary>
+/// Name of a NameIndex or PragmaPreset, as used in benchmark names and reports
+/// </summary>
+const char* to_string(NameIndex name_index);
+const char* to_string(PragmaPreset pragmas);
+
+/// <summary>
+/// initialize_database with schema tuning: applies the PRAGMA preset, creates USERS (WITHOUT ROWID if
+/// asked) with the four example users, then the NAME index
+/// </summary>
+/// <returns>false, after printing the SQLite error, if any statement fails</returns>
+bool initialize_database(sqlite3* db, const SchemaOptions& options);
+
+/// <summary>
+/// Add count generated users, IDs from 5 up and names User0, User1, ..., in one transaction
+/// </summary>
+/// <param name="seed">seed for the generated passwords</param>
+/// <returns>false, after printing the SQLite error, if an insert fails</returns>
+bool seed_users(sqlite3* db, std::size_t count, std::uint64_t seed);
+
+/// <summary>
+/// Run EXPLAIN QUERY PLAN on sql and collect the plan, one line per step, indented by depth
+/// </summary>
+/// <returns>false, after printing the SQLite error, if sql does not compile</returns>
+bool explain_query_plan(sqlite3* db, const std::string& sql, std::vector<std::string>& plan);
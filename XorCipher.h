@@ -0,0 +1,42 @@
+// XorCipher.h : Repeating-key XOR used by the encryption example.
+//
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+
+/// <summary>
+/// encrypt or decrypt a source string using the provided key
+/// </summary>
+/// <param name="source">input string to process</param>
+/// <param name="key">key to use in encryption / decryption</param>
+/// <returns>transformed string</returns>
+inline std::string encrypt_decrypt(const std::string& source, const std::string& key)
+{
+    // get lengths now instead of calling the function every time.
+    // this would have most likely been inlined by the compiler, but design for perfomance.
+    const auto key_length = key.length();
+    const auto source_length = source.length();
+
+    // assert that our input data is good
+    assert(key_length > 0);
+    assert(source_length > 0);
+
+    std::string output = source;
+
+    // loop through the source string char by char
+    for (size_t i = 0; i < source_length; ++i)
+    { // TODO: student need to change the next line from output[i] = source[i]
+      // transform each character based on an xor of the key modded constrained to key length using a mod
+      //Encryption of source data alogorithm xor
+        output[i] = source[i] ^ key[i % key_length];
+    }
+
+    // our output length must equal our source length
+    assert(output.length() == source_length);
+
+    // return the transformed string
+    return output;
+}
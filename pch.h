@@ -0,0 +1,16 @@
+//
+// pch.h
+// Header for standard system include files.
+//
+
+#pragma once
+
+#include <cassert>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "gtest/gtest.h"
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""Compare two benchmark reports and fail if any benchmark got slower than the threshold.
+
+    compare_benchmarks.py baseline.json contender.json [--threshold 0.10]
+
+Either report can be a combined report from run_benchmarks.py or the --benchmark_out file of a
+single program. Benchmarks are matched by name; with repetitions the median aggregate is used,
+falling back to the mean and then to the plain run. Benchmarks registered with UseRealTime (their
+name contains "/real_time") are compared on wall time, everything else on CPU time.
+
+Exit status is 0 when nothing regressed, 1 when something did and 2 on bad input.
+"""
+
+import argparse
+import json
+import sys
+
+TIME_UNITS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+PREFERENCE = {"median": 0, "mean": 1, None: 2}
+
+
+def load_times(path):
+    """Map each benchmark name to its time in nanoseconds."""
+    with open(path, encoding="utf-8") as report_file:
+        benchmarks = json.load(report_file).get("benchmarks", [])
+
+    chosen = {}
+    for benchmark in benchmarks:
+        if benchmark.get("error_occurred"):
+            continue
+        aggregate = benchmark.get("aggregate_name") if benchmark.get("run_type") == "aggregate" else None
+        if aggregate not in PREFERENCE:
+            continue
+        name = benchmark.get("run_name", benchmark["name"])
+        rank = PREFERENCE[aggregate]
+        if name in chosen and chosen[name][0] <= rank:
+            continue
+        field = "real_time" if "/real_time" in name else "cpu_time"
+        scale = TIME_UNITS.get(benchmark.get("time_unit", "ns"), 1.0)
+        chosen[name] = (rank, benchmark[field] * scale)
+    return {name: time for name, (_, time) in chosen.items()}
+
+
+def format_time(nanoseconds):
+    for unit in ("s", "ms", "us"):
+        if nanoseconds >= TIME_UNITS[unit]:
+            return "%.3f %s" % (nanoseconds / TIME_UNITS[unit], unit)
+    return "%.1f ns" % nanoseconds
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("contender")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="relative slowdown that counts as a regression (default 0.10)")
+    arguments = parser.parse_args()
+
+    try:
+        baseline = load_times(arguments.baseline)
+        contender = load_times(arguments.contender)
+    except (OSError, ValueError, KeyError) as error:
+        print("compare_benchmarks: %s" % error, file=sys.stderr)
+        return 2
+
+    common = sorted(set(baseline) & set(contender))
+    if not common:
+        print("compare_benchmarks: the reports have no benchmarks in common", file=sys.stderr)
+        return 2
+
+    width = max(len(name) for name in common)
+    regressions = []
+    for name in common:
+        before = baseline[name]
+        after = contender[name]
+        change = (after - before) / before if before > 0 else 0.0
+        marker = ""
+        if change > arguments.threshold:
+            marker = "  REGRESSION"
+            regressions.append(name)
+        elif change < -arguments.threshold:
+            marker = "  improved"
+        print("%-*s %12s %12s %+8.1f%%%s" % (width, name, format_time(before), format_time(after), change * 100, marker))
+
+    for name in sorted(set(baseline) - set(contender)):
+        print("%-*s only in baseline" % (width, name))
+    for name in sorted(set(contender) - set(baseline)):
+        print("%-*s only in contender" % (width, name))
+
+    print("%d benchmark(s) compared, %d regression(s) over %.0f%%"
+          % (len(common), len(regressions), arguments.threshold * 100))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Run every benchmark program in a manifest and merge their results into one JSON report.
+
+The manifest is the benchmarks.json CMake writes next to the build:
+
+    {"benchmarks": [{"name": "...", "path": "...", "args": ["..."]}, ...]}
+
+Each program runs pinned to one CPU with taskset (when it is available) and RANDOM_SEED=1, so the
+generated inputs are the same from run to run. Arguments after "--" are passed to every program,
+for example "-- --benchmark_filter=Tokenize --benchmark_min_time=0.05".
+
+The combined report keeps the context of the first program and prefixes each benchmark name with
+the program name, "static_checks_benchmark/BM_Tokenize_median" and so on, which is what
+compare_benchmarks.py matches on.
+"""
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+
+def parse_arguments():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--manifest", required=True, help="benchmarks.json written by CMake")
+    parser.add_argument("--output", required=True, help="combined JSON report to write")
+    parser.add_argument("--cpu", type=int, default=0, help="CPU to pin the benchmarks to")
+    parser.add_argument("--repetitions", type=int, default=5, help="repetitions per benchmark")
+    parser.add_argument("--only", action="append", default=[], help="run only this program (repeatable)")
+    parser.add_argument("extra", nargs=argparse.REMAINDER, help="arguments after -- go to every program")
+    arguments = parser.parse_args()
+    if arguments.extra and arguments.extra[0] == "--":
+        arguments.extra = arguments.extra[1:]
+    return arguments
+
+
+def pinning_prefix(cpu):
+    if sys.platform.startswith("linux") and shutil.which("taskset"):
+        return ["taskset", "-c", str(cpu)]
+    print("taskset is not available, benchmarks are not pinned", file=sys.stderr)
+    return []
+
+
+def run_program(program, prefix, arguments, scratch):
+    result_path = os.path.join(scratch, program["name"] + ".json")
+    command = prefix + [program["path"]] + program.get("args", []) + [
+        "--benchmark_out=" + result_path,
+        "--benchmark_out_format=json",
+        "--benchmark_repetitions=%d" % arguments.repetitions,
+        "--benchmark_report_aggregates_only=%s" % ("true" if arguments.repetitions > 1 else "false"),
+    ] + arguments.extra
+
+    environment = dict(os.environ, RANDOM_SEED="1")
+    print("==> " + " ".join(command), flush=True)
+    if subprocess.call(command, env=environment) != 0 or not os.path.exists(result_path):
+        return None
+    with open(result_path, encoding="utf-8") as result_file:
+        return json.load(result_file)
+
+
+def main():
+    arguments = parse_arguments()
+    with open(arguments.manifest, encoding="utf-8") as manifest_file:
+        programs = json.load(manifest_file)["benchmarks"]
+    if arguments.only:
+        programs = [program for program in programs if program["name"] in arguments.only]
+
+    prefix = pinning_prefix(arguments.cpu)
+    report = {"context": None, "benchmarks": []}
+    failed = []
+    with tempfile.TemporaryDirectory(prefix="bench_") as scratch:
+        for program in programs:
+            result = run_program(program, prefix, arguments, scratch)
+            if result is None:
+                failed.append(program["name"])
+                continue
+            if report["context"] is None:
+                report["context"] = result.get("context", {})
+                report["context"]["pinned_cpu"] = arguments.cpu if prefix else None
+                report["context"]["repetitions"] = arguments.repetitions
+            for benchmark in result.get("benchmarks", []):
+                benchmark["program"] = program["name"]
+                benchmark["name"] = program["name"] + "/" + benchmark["name"]
+                if "run_name" in benchmark:
+                    benchmark["run_name"] = program["name"] + "/" + benchmark["run_name"]
+                report["benchmarks"].append(benchmark)
+
+    with open(arguments.output, "w", encoding="utf-8") as output_file:
+        json.dump(report, output_file, indent=2)
+    print("Wrote %d benchmark(s) from %d program(s) to %s"
+          % (len(report["benchmarks"]), len(programs) - len(failed), arguments.output))
+
+    if failed:
+        print("Failed: " + ", ".join(failed), file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())